@@ -1,81 +1,64 @@
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
-#include "ycsbr/trace.h"
+#include "ycsb_extractor.h"
 
 namespace fs = std::filesystem;
 
 namespace {
 
-using Op = ycsbr::Request::Operation;
-
-const std::unordered_map<std::string, Op> kStringToOp = {
-    {"INSERT", Op::kInsert},
-    {"READ", Op::kRead},
-    {"UPDATE", Op::kUpdate},
-    {"SCAN", Op::kScan}};
-
-void ExtractYCSBTrace(const std::string& output_file) {
-  std::ofstream output(output_file, std::ios::out | std::ios::binary);
-  if (!output) {
-    throw std::runtime_error(
-        "Failed to load workload from file. Error opening: " + output_file);
-  }
-  output.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-
-  std::string line;
-  while (std::getline(std::cin, line)) {
-    std::istringstream iss(line);
-    iss.exceptions(std::istringstream::failbit | std::istringstream::badbit);
-
-    std::string op_candidate;
-    iss >> op_candidate;
-
-    const auto& it = kStringToOp.find(op_candidate);
-    if (it == kStringToOp.end()) {
-      // Not a request output.
-      continue;
-    }
-    const Op operation = it->second;
-
-    std::string key_string, discard;
-    iss >> discard;
-    iss >> key_string;
-
-    const ycsbr::Request::Key key =
-        strtoull(key_string.c_str() + 4, nullptr, 10);
-    const ycsbr::Request::Encoded encoded(operation, key);
-    output.write(reinterpret_cast<const char*>(&encoded), sizeof(encoded));
-
-    // Encode the scan amount if the request is a SCAN operation
-    if (operation != Op::kScan) {
-      continue;
-    }
-
-    std::string scan_amount_string;
-    iss >> scan_amount_string;
-
-    const uint32_t scan_amount =
-        strtoul(scan_amount_string.c_str(), nullptr, 10);
-    output.write(reinterpret_cast<const char*>(&scan_amount),
-                 sizeof(scan_amount));
-  }
+using ycsbr::extractor::ExtractorOptions;
+using ycsbr::extractor::ExtractYCSBTrace;
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program << " [options] <output file>" << std::endl
+            << "Options:" << std::endl
+            << "  --v3              Write the trace in the compressed "
+               "block-based (v3) format."
+            << std::endl
+            << "  --key-prefix=STR  The prefix of the keys in the YCSB "
+               "output (default: user)."
+            << std::endl
+            << "  --threads=N       The number of parsing threads (default: "
+               "number of cores)."
+            << std::endl;
 }
 
 }  // namespace
 
 int main(int argc, char* argv[]) {
-  if (argc != 2) {
-    std::cerr << "Usage: " << argv[0] << " <output file>" << std::endl;
+  ExtractorOptions options;
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg == "--v3") {
+      options.format = ycsbr::TraceWriter::Format::kV3;
+    } else if (arg.rfind("--key-prefix=", 0) == 0) {
+      options.key_prefix = arg.substr(strlen("--key-prefix="));
+    } else if (arg.rfind("--threads=", 0) == 0) {
+      options.num_threads = strtoul(arg.c_str() + strlen("--threads="),
+                                    nullptr, 10);
+      if (options.num_threads == 0) {
+        PrintUsage(argv[0]);
+        return 1;
+      }
+    } else if (arg.rfind("--", 0) == 0) {
+      PrintUsage(argv[0]);
+      return 1;
+    } else {
+      positional.push_back(arg);
+    }
+  }
+  if (positional.size() != 1) {
+    PrintUsage(argv[0]);
     return 1;
   }
 
-  const std::string output_file(argv[1]);
+  const std::string& output_file = positional[0];
   if (fs::exists(output_file)) {
     std::cerr
         << "ERROR: Output file already exists. Aborting to avoid overwriting."
@@ -83,7 +66,17 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  ExtractYCSBTrace(output_file);
+  try {
+    const size_t num_deletes = ExtractYCSBTrace(stdin, output_file, options);
+    if (num_deletes > 0) {
+      std::cerr << "WARNING: Skipped " << num_deletes
+                << " DELETE operation(s) (not supported by YCSBR)."
+                << std::endl;
+    }
+  } catch (const std::exception& ex) {
+    std::cerr << "ERROR: " << ex.what() << std::endl;
+    return 1;
+  }
 
   return 0;
 }
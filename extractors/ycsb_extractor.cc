@@ -0,0 +1,227 @@
+#include "ycsb_extractor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "ycsbr/impl/thread_pool.h"
+#include "ycsbr/request.h"
+
+namespace ycsbr {
+namespace extractor {
+
+namespace {
+
+using Op = Request::Operation;
+
+// The result of parsing one piece of the benchmark driver's output.
+struct ParsedPiece {
+  std::vector<Request> requests;
+  // YCSBR does not support deletes, so they are counted and skipped.
+  size_t num_deletes = 0;
+};
+
+// The operation names printed by YCSB's `basic` "database".
+struct OpName {
+  std::string_view name;
+  Op op;
+  bool is_delete;
+};
+constexpr OpName kOpNames[] = {
+    {"INSERT", Op::kInsert, false},
+    {"READ", Op::kRead, false},
+    {"UPDATE", Op::kUpdate, false},
+    {"SCAN", Op::kScan, false},
+    {"READMODIFYWRITE", Op::kReadModifyWrite, false},
+    {"DELETE", Op::kInsert, /*is_delete=*/true}};
+
+bool IsSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Returns the next space-delimited field in `[*pos, end)` and advances `*pos`
+// past it.
+std::string_view NextField(const char** pos, const char* end) {
+  const char* start = *pos;
+  while (start < end && IsSpace(*start)) ++start;
+  const char* stop = start;
+  while (stop < end && !IsSpace(*stop)) ++stop;
+  *pos = stop;
+  return std::string_view(start, stop - start);
+}
+
+uint64_t ParseUnsigned(std::string_view field, std::string_view line) {
+  if (field.empty()) {
+    throw std::runtime_error("Expected a number in line: " + std::string(line));
+  }
+  uint64_t value = 0;
+  for (const char c : field) {
+    if (c < '0' || c > '9') {
+      throw std::runtime_error("Expected a number in line: " +
+                               std::string(line));
+    }
+    const uint64_t digit = c - '0';
+    if (value > (UINT64_MAX - digit) / 10) {
+      throw std::runtime_error("Number is out of range in line: " +
+                               std::string(line));
+    }
+    value = value * 10 + digit;
+  }
+  return value;
+}
+
+// Parses the requests in `[begin, end)`, which must only contain whole lines.
+ParsedPiece ParsePiece(const char* begin, const char* const end,
+                       const std::string& key_prefix) {
+  ParsedPiece result;
+  while (begin < end) {
+    const char* line_end =
+        static_cast<const char*>(memchr(begin, '\n', end - begin));
+    if (line_end == nullptr) line_end = end;
+    const std::string_view line(begin, line_end - begin);
+    const char* pos = begin;
+    begin = line_end + 1;
+
+    const std::string_view op_candidate = NextField(&pos, line_end);
+    const OpName* op_name = nullptr;
+    for (const auto& candidate : kOpNames) {
+      if (op_candidate == candidate.name) {
+        op_name = &candidate;
+        break;
+      }
+    }
+    if (op_name == nullptr) {
+      // Not a request output.
+      continue;
+    }
+    if (op_name->is_delete) {
+      ++result.num_deletes;
+      continue;
+    }
+
+    // Skip the table name.
+    NextField(&pos, line_end);
+    const std::string_view key_field = NextField(&pos, line_end);
+    if (key_field.substr(0, key_prefix.size()) != key_prefix) {
+      throw std::runtime_error("Key does not start with the prefix \"" +
+                               key_prefix + "\" in line: " + std::string(line));
+    }
+    const Request::Key key =
+        ParseUnsigned(key_field.substr(key_prefix.size()), line);
+
+    // Scans also include the scan amount.
+    uint32_t scan_amount = 0;
+    if (op_name->op == Op::kScan) {
+      const uint64_t amount = ParseUnsigned(NextField(&pos, line_end), line);
+      if (amount > UINT32_MAX) {
+        throw std::runtime_error("Scan amount is out of range in line: " +
+                                 std::string(line));
+      }
+      scan_amount = static_cast<uint32_t>(amount);
+    }
+
+    result.requests.emplace_back(op_name->op, key, scan_amount, nullptr, 0);
+  }
+  return result;
+}
+
+// Reads the next chunk of `input` into `buffer`. The chunk always ends
+// with a complete line (or at the end of the input); any partial line is moved
+// into `carry`, to be prepended to the next chunk. Returns false at the end of
+// the input.
+bool ReadChunk(FILE* input, const size_t chunk_size, std::vector<char>* buffer,
+               std::vector<char>* carry) {
+  buffer->swap(*carry);
+  carry->clear();
+  const size_t prefix = buffer->size();
+  buffer->resize(std::max(chunk_size, prefix * 2));
+  size_t filled = prefix;
+  while (filled < buffer->size()) {
+    const size_t read =
+        fread(buffer->data() + filled, 1, buffer->size() - filled, input);
+    if (read == 0) break;
+    filled += read;
+  }
+  if (ferror(input)) {
+    throw std::runtime_error("Failed to read the YCSB output.");
+  }
+  buffer->resize(filled);
+  if (filled == 0) return false;
+  if (!feof(input)) {
+    const auto last_newline =
+        std::find(buffer->rbegin(), buffer->rend(), '\n');
+    const size_t complete = buffer->rend() - last_newline;
+    carry->assign(buffer->begin() + complete, buffer->end());
+    buffer->resize(complete);
+  }
+  return true;
+}
+
+// Splits `buffer` into pieces that hold whole lines and parses them on the
+// thread pool.
+std::vector<std::future<ParsedPiece>> SubmitChunk(
+    const std::vector<char>& buffer, const ExtractorOptions& options,
+    impl::ThreadPool* pool) {
+  std::vector<std::future<ParsedPiece>> pieces;
+  const char* begin = buffer.data();
+  const char* const end = buffer.data() + buffer.size();
+  const size_t piece_size =
+      std::max<size_t>(1, buffer.size() / (options.num_threads * 4));
+  while (begin < end) {
+    const char* piece_end = begin + std::min<size_t>(piece_size, end - begin);
+    // Extend the piece to the end of its last line.
+    const char* newline = static_cast<const char*>(
+        memchr(piece_end - 1, '\n', end - piece_end + 1));
+    piece_end = newline == nullptr ? end : newline + 1;
+    pieces.push_back(pool->Submit(ParsePiece, begin, piece_end,
+                                  std::cref(options.key_prefix)));
+    begin = piece_end;
+  }
+  return pieces;
+}
+
+}  // namespace
+
+size_t ExtractYCSBTrace(FILE* input, const std::string& output_file,
+                        const ExtractorOptions& options) {
+  TraceWriter output(output_file, options.format);
+  impl::ThreadPool pool(options.num_threads, []() {}, []() {});
+  size_t num_deletes = 0;
+
+  // Reading and writing are overlapped with parsing: while one chunk is being
+  // parsed, the next chunk is read and the previous chunk's results are
+  // written.
+  std::vector<char> current, next, carry;
+  std::vector<std::future<ParsedPiece>> in_flight;
+  bool has_current = ReadChunk(input, options.chunk_size, &current, &carry);
+  if (has_current) {
+    in_flight = SubmitChunk(current, options, &pool);
+  }
+  while (has_current) {
+    const bool has_next = ReadChunk(input, options.chunk_size, &next, &carry);
+    std::vector<ParsedPiece> parsed;
+    parsed.reserve(in_flight.size());
+    for (auto& piece : in_flight) {
+      parsed.push_back(piece.get());
+    }
+    in_flight.clear();
+    current.swap(next);
+    if (has_next) {
+      in_flight = SubmitChunk(current, options, &pool);
+    }
+    for (const auto& piece : parsed) {
+      for (const auto& request : piece.requests) {
+        output.Write(request);
+      }
+      num_deletes += piece.num_deletes;
+    }
+    has_current = has_next;
+  }
+  output.Close();
+  return num_deletes;
+}
+
+}  // namespace extractor
+}  // namespace ycsbr
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "ycsbr/trace_writer.h"
+
+namespace ycsbr {
+namespace extractor {
+
+struct ExtractorOptions {
+  TraceWriter::Format format = TraceWriter::Format::kLegacy;
+  // The prefix that YCSB adds to each key.
+  std::string key_prefix = "user";
+  // The number of threads used to parse the benchmark driver's output.
+  size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+  // The benchmark driver's output is read in chunks of (at least) this many
+  // bytes. Each chunk is split into pieces (at line boundaries) that are
+  // parsed in parallel.
+  size_t chunk_size = 64ULL << 20;
+};
+
+// Extracts the requests in the YCSB benchmark driver's output (when using the
+// `basic` "database") from `input` and writes them to a trace file. Throws
+// `std::runtime_error` if the output is malformed (e.g., if a key does not
+// start with `options.key_prefix`).
+//
+// YCSBR does not support deletes, so `DELETE` requests are skipped. Returns
+// the number of skipped requests.
+size_t ExtractYCSBTrace(FILE* input, const std::string& output_file,
+                        const ExtractorOptions& options);
+
+}  // namespace extractor
+}  // namespace ycsbr
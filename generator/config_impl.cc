@@ -7,6 +7,7 @@
 #include "hotspot_keygen.h"
 #include "latest_chooser.h"
 #include "linspace_keygen.h"
+#include "rejection_inversion_zipfian_chooser.h"
 #include "uniform_chooser.h"
 #include "uniform_keygen.h"
 #include "yaml-cpp/yaml.h"
@@ -22,6 +23,7 @@ using namespace ycsbr;
 const std::string kLoadConfigKey = "load";
 const std::string kRunConfigKey = "run";
 const std::string kRecordSizeBytesKey = "record_size_bytes";
+const std::string kPRNGKey = "prng";
 
 // Operation keys.
 const std::string kReadOpKey = "read";
@@ -55,6 +57,7 @@ const std::string kZipfianClusteredDist =
 const std::string kRangeMinKey = "range_min";
 const std::string kRangeMaxKey = "range_max";
 const std::string kZipfianThetaKey = "theta";
+const std::string kZipfianAlgorithmKey = "algorithm";
 const std::string kHotspotProportionKey = "hot_proportion_pct";
 const std::string kHotRangeMinKey = "hot_" + kRangeMinKey;
 const std::string kHotRangeMaxKey = "hot_" + kRangeMaxKey;
@@ -64,6 +67,11 @@ const std::string kSaltKey = "salt";
 const std::string kCustomNameKey = "name";
 const std::string kCustomOffsetKey = "offset";
 
+// Algorithms used to sample Zipfian-distributed values (used by the zipfian,
+// zipfian_clustered, and latest distributions).
+const std::string kZipfianGrayAlgorithm = "gray";
+const std::string kZipfianRejectionInversionAlgorithm = "rejection_inversion";
+
 // Only does a quick high-level structural validation. The semantic validation
 // is done when phases are retrieved.
 bool ValidateConfig(const YAML::Node& raw_config) {
@@ -98,6 +106,35 @@ bool ValidateConfig(const YAML::Node& raw_config) {
   return true;
 }
 
+// Returns true iff a Zipfian distribution with the given configuration should
+// be sampled using rejection-inversion. The YCSB (Gray et al.) algorithm
+// remains the default because it produces the same sequences as earlier
+// versions of the generator. But it only supports `theta` in (0, 1) and it
+// takes O(item_count) time to construct and resize, so rejection-inversion is
+// used when `theta >= 1` or when it is requested explicitly.
+bool UseRejectionInversion(const YAML::Node& distribution_config,
+                           const double theta) {
+  if (theta <= 0.0) {
+    throw std::invalid_argument("Zipfian theta must be positive.");
+  }
+  if (!distribution_config[kZipfianAlgorithmKey]) {
+    return theta >= 1.0;
+  }
+  const std::string algorithm =
+      distribution_config[kZipfianAlgorithmKey].as<std::string>();
+  if (algorithm == kZipfianRejectionInversionAlgorithm) {
+    return true;
+  } else if (algorithm == kZipfianGrayAlgorithm) {
+    if (theta >= 1.0) {
+      throw std::invalid_argument(
+          "The gray Zipfian algorithm needs theta to be in the range (0, 1).");
+    }
+    return false;
+  } else {
+    throw std::invalid_argument("Unsupported Zipfian algorithm: " + algorithm);
+  }
+}
+
 // NOTE: This method will release the lock while the chooser is being
 // constructed. It will the reacquire the lock before returning. This is done to
 // avoid holding the lock while creating the generator, which may take a lot of
@@ -118,9 +155,8 @@ std::unique_ptr<gen::Chooser> CreateChooser(
 
   } else if (dist_type == kZipfianDist || dist_type == kZipfianClusteredDist) {
     const double theta = distribution_config[kZipfianThetaKey].as<double>();
-    if (theta <= 0.0 || theta >= 1.0) {
-      throw std::invalid_argument("Zipfian theta must be in the range (0, 1).");
-    }
+    const bool use_rejection_inversion =
+        UseRejectionInversion(distribution_config, theta);
     // Salts are optional and are used to create different "scatterings" (i.e.,
     // to have two zipfian distributions choose different hot keys).
     uint64_t salt = 0;
@@ -128,25 +164,41 @@ std::unique_ptr<gen::Chooser> CreateChooser(
       salt = distribution_config[kSaltKey].as<uint64_t>();
     }
     lock.unlock();
+    std::unique_ptr<gen::Chooser> chooser;
     if (dist_type == kZipfianDist) {
-      auto chooser = std::make_unique<gen::ScatteredZipfianChooser>(
-          item_count, theta, salt);
-      lock.lock();
-      return chooser;
+      if (use_rejection_inversion) {
+        chooser =
+            std::make_unique<gen::ScatteredRejectionInversionZipfianChooser>(
+                item_count, theta, salt);
+      } else {
+        chooser = std::make_unique<gen::ScatteredZipfianChooser>(item_count,
+                                                                 theta, salt);
+      }
     } else {
       assert(dist_type == kZipfianClusteredDist);
-      auto chooser = std::make_unique<gen::ZipfianChooser>(item_count, theta);
-      lock.lock();
-      return chooser;
+      if (use_rejection_inversion) {
+        chooser = std::make_unique<gen::RejectionInversionZipfianChooser>(
+            item_count, theta);
+      } else {
+        chooser = std::make_unique<gen::ZipfianChooser>(item_count, theta);
+      }
     }
+    lock.lock();
+    return chooser;
 
   } else if (dist_type == kLatestDist) {
     const double theta = distribution_config[kZipfianThetaKey].as<double>();
-    if (theta <= 0.0 || theta >= 1.0) {
-      throw std::invalid_argument("Theta must be in the range (0, 1).");
-    }
+    const bool use_rejection_inversion =
+        UseRejectionInversion(distribution_config, theta);
     lock.unlock();
-    auto chooser = std::make_unique<gen::LatestChooser>(item_count, theta);
+    std::unique_ptr<gen::Chooser> chooser;
+    if (use_rejection_inversion) {
+      chooser = std::make_unique<gen::LatestChooser>(
+          item_count, std::make_unique<gen::RejectionInversionZipfianChooser>(
+                          item_count, theta));
+    } else {
+      chooser = std::make_unique<gen::LatestChooser>(item_count, theta);
+    }
     lock.lock();
     return chooser;
 
@@ -290,6 +342,14 @@ size_t WorkloadConfigImpl::GetRecordSizeBytes() const {
   return record_size_bytes;
 }
 
+PRNG::Type WorkloadConfigImpl::GetPRNGType() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!raw_config_[kPRNGKey]) {
+    return PRNG::kDefaultType;
+  }
+  return PRNG::TypeFromString(raw_config_[kPRNGKey].as<std::string>());
+}
+
 std::unique_ptr<Generator> WorkloadConfigImpl::GetLoadGenerator() const {
   std::unique_lock<std::mutex> lock(mutex_);
   if (UsingCustomDatasetImpl()) {
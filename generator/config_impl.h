@@ -17,6 +17,7 @@ class WorkloadConfigImpl : public WorkloadConfig {
   bool UsingCustomDataset() const override;
   size_t GetNumLoadRecords() const override;
   size_t GetRecordSizeBytes() const override;
+  PRNG::Type GetPRNGType() const override;
   std::unique_ptr<Generator> GetLoadGenerator() const override;
 
   size_t GetNumPhases() const override;
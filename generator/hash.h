@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace ycsbr {
@@ -23,5 +24,31 @@ inline uint64_t FNVHash64(uint64_t val) {
   return hashval;
 }
 
+// Maps `choice` to a pseudorandom value in the range [0, item_count). Used to
+// scatter the popular values chosen by a skewed distribution throughout the
+// range. Choices with the same `salt` are mapped to the same values.
+inline uint64_t ScatterChoice(const uint64_t choice, const uint64_t salt,
+                              const uint64_t item_count) {
+  const uint64_t hashed_choice = FNVHash64(choice ^ salt);
+#ifdef __SIZEOF_INT128__
+  // Fast modulo for 64-bit integers. See
+  // https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
+  return static_cast<uint64_t>((static_cast<__uint128_t>(hashed_choice) *
+                                static_cast<__uint128_t>(item_count)) >>
+                               64);
+#else
+  return hashed_choice % item_count;
+#endif
+}
+
+// Applies `ScatterChoice()` to each of `values[0..n)` in place. The loop has no
+// dependencies between iterations, so the compiler can vectorize it.
+inline void ScatterChoices(size_t* values, const size_t n, const uint64_t salt,
+                           const uint64_t item_count) {
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = ScatterChoice(values[i], salt, item_count);
+  }
+}
+
 }  // namespace gen
 }  // namespace ycsbr
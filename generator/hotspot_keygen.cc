@@ -1,9 +1,11 @@
 #include "hotspot_keygen.h"
 
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
 
 #include "sampling.h"
+#include "uniform_keygen.h"
 
 namespace ycsbr {
 namespace gen {
@@ -105,5 +107,57 @@ void HotspotGenerator::Generate(PRNG& prng, std::vector<Request::Key>* dest,
   std::shuffle(dest->begin() + start_index, dest->begin() + curr_index, prng);
 }
 
+void HotspotGenerator::GenerateSorted(PRNG& prng,
+                                      std::vector<Request::Key>* dest,
+                                      const size_t start_index) const {
+  // The cold and hot ranges are disjoint, so sampling each range in ascending
+  // order produces sorted keys.
+  size_t curr_index = start_index;
+  if (num_cold_before_keys_ > 0) {
+    VitterSample<Request::Key, PRNG>(num_cold_before_keys_, *cold_before_,
+                                     dest, curr_index, prng);
+    curr_index += num_cold_before_keys_;
+  }
+  VitterSample<Request::Key, PRNG>(num_hot_keys_, hot_, dest, curr_index,
+                                   prng);
+  curr_index += num_hot_keys_;
+  if (num_cold_after_keys_ > 0) {
+    VitterSample<Request::Key, PRNG>(num_cold_after_keys_, *cold_after_, dest,
+                                     curr_index, prng);
+  }
+}
+
+std::vector<Generator::Part> HotspotGenerator::Split(
+    const size_t num_parts) const {
+  std::vector<Part> parts;
+  const size_t num_keys =
+      num_cold_before_keys_ + num_hot_keys_ + num_cold_after_keys_;
+  if (num_parts <= 1 || num_keys == 0) return parts;
+  // The ranges are disjoint and are split in ascending order.
+  const auto split_range = [&](const size_t range_keys,
+                               const std::optional<KeyRange>& range) {
+    if (range_keys == 0) return true;
+    const size_t range_parts =
+        std::max<size_t>(1, num_parts * range_keys / num_keys);
+    UniformGenerator generator(range_keys, *range);
+    std::vector<Part> range_split = generator.Split(range_parts);
+    if (range_split.empty()) {
+      if (range_parts > 1) return false;
+      range_split.push_back(Part{
+          range_keys, std::make_unique<UniformGenerator>(range_keys, *range)});
+    }
+    for (auto& part : range_split) {
+      parts.push_back(std::move(part));
+    }
+    return true;
+  };
+  if (!split_range(num_cold_before_keys_, cold_before_) ||
+      !split_range(num_hot_keys_, hot_) ||
+      !split_range(num_cold_after_keys_, cold_after_)) {
+    return {};
+  }
+  return parts;
+}
+
 }  // namespace gen
 }  // namespace ycsbr
@@ -17,6 +17,12 @@ class HotspotGenerator : public Generator {
 
   void Generate(PRNG& prng, std::vector<Request::Key>* dest,
                 size_t start_index) const override;
+  void GenerateSorted(PRNG& prng, std::vector<Request::Key>* dest,
+                      size_t start_index) const override;
+
+  // Splits the cold and hot ranges separately. Each range gets a share of the
+  // parts that is proportional to its number of keys.
+  std::vector<Part> Split(size_t num_parts) const override;
 
  private:
   size_t num_hot_keys_;
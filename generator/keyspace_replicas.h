@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ycsbr/gen/keyspace.h"
+
+namespace ycsbr {
+namespace gen {
+
+// Holds one copy of a `KeySpace`'s keys per NUMA node. This class is
+// thread-safe.
+class KeySpaceReplicas {
+ public:
+  explicit KeySpaceReplicas(KeySpace keys) : keys_(std::move(keys)) {}
+
+  // Returns the copy of the keys for NUMA node `node`. The first call for a
+  // node makes the copy on the calling thread, so the copy's memory is placed
+  // on the calling thread's NUMA node (the kernel places pages on the node of
+  // the thread that first touches them). Computed keys are not copied.
+  KeySpace ForNode(const size_t node) {
+    if (!keys_.IsMaterialized()) return keys_;
+    Replica* replica = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // References to the map's elements stay valid when it grows.
+      replica = &replicas_[node];
+    }
+    // The copy is made outside of the lock so that threads on different
+    // nodes make their copies in parallel.
+    std::call_once(replica->copied, [this, replica]() {
+      replica->keys = KeySpace::Materialized(
+          std::make_shared<std::vector<Request::Key>>(keys_.keys()));
+    });
+    return replica->keys;
+  }
+
+ private:
+  struct Replica {
+    std::once_flag copied;
+    KeySpace keys;
+  };
+
+  KeySpace keys_;
+  std::mutex mutex_;
+  std::unordered_map<size_t, Replica> replicas_;
+};
+
+}  // namespace gen
+}  // namespace ycsbr
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <random>
 
 #include "ycsbr/gen/chooser.h"
@@ -19,30 +20,44 @@ namespace gen {
 class LatestChooser : public Chooser {
  public:
   LatestChooser(size_t item_count, double theta)
-      : item_count_(item_count), zipf_(item_count, theta) {
+      : LatestChooser(item_count,
+                      std::make_unique<ZipfianChooser>(item_count, theta)) {}
+
+  // Uses `zipf` to choose how far from the latest value to go. The chooser must
+  // return 0 as the most popular value and must have `item_count` items.
+  LatestChooser(size_t item_count, std::unique_ptr<Chooser> zipf)
+      : item_count_(item_count), zipf_(std::move(zipf)) {
     assert(item_count > 0);
   }
 
   size_t Next(PRNG& prng) override {
-    // The `ZipfianChooser` selects 0 as the most popular item, followed by 1,
+    // The Zipfian chooser selects 0 as the most popular item, followed by 1,
     // then 2, etc.
-    const size_t choice = zipf_.Next(prng);
+    const size_t choice = zipf_->Next(prng);
     return item_count_ - 1 - choice;
   }
 
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override {
+    zipf_->NextBatch(prng, out, n);
+    const size_t latest = item_count_ - 1;
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = latest - out[i];
+    }
+  }
+
   void SetItemCount(const size_t item_count) override {
     item_count_ = item_count;
-    zipf_.SetItemCount(item_count);
+    zipf_->SetItemCount(item_count);
   }
 
   void IncreaseItemCountBy(size_t delta) override {
     item_count_ += delta;
-    zipf_.IncreaseItemCountBy(delta);
+    zipf_->IncreaseItemCountBy(delta);
   }
 
  private:
   size_t item_count_;
-  ZipfianChooser zipf_;
+  std::unique_ptr<Chooser> zipf_;
 };
 
 }  // namespace gen
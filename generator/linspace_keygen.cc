@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <memory>
 
 namespace ycsbr {
 namespace gen {
@@ -25,5 +26,30 @@ void LinspaceGenerator::Generate(PRNG& prng, std::vector<Request::Key>* dest,
                dest->begin() + start_index + num_keys_, prng);
 }
 
+void LinspaceGenerator::GenerateSorted(PRNG& /*prng*/,
+                                       std::vector<Request::Key>* dest,
+                                       const size_t start_index) const {
+  Request::Key key = start_key_;
+  for (size_t i = start_index; i < start_index + num_keys_; ++i) {
+    (*dest)[i] = key;
+    key += step_size_;
+  }
+}
+
+std::vector<Generator::Part> LinspaceGenerator::Split(
+    const size_t num_parts) const {
+  std::vector<Part> parts;
+  if (num_parts <= 1 || num_keys_ < num_parts) return parts;
+  parts.reserve(num_parts);
+  for (size_t i = 0; i < num_parts; ++i) {
+    const size_t first = num_keys_ * i / num_parts;
+    const size_t part_keys = num_keys_ * (i + 1) / num_parts - first;
+    parts.push_back(Part{
+        part_keys, std::make_unique<LinspaceGenerator>(
+                       part_keys, start_key_ + first * step_size_, step_size_)});
+  }
+  return parts;
+}
+
 }  // namespace gen
 }  // namespace ycsbr
@@ -16,6 +16,13 @@ class LinspaceGenerator : public Generator {
 
   void Generate(PRNG& prng, std::vector<Request::Key>* dest,
                 size_t start_index) const override;
+  void GenerateSorted(PRNG& prng, std::vector<Request::Key>* dest,
+                      size_t start_index) const override;
+
+  std::vector<Part> Split(size_t num_parts) const override;
+  std::optional<Progression> SortedProgression() const override {
+    return Progression{start_key_, step_size_};
+  }
 
  private:
   size_t num_keys_;
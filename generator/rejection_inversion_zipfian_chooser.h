@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "hash.h"
+#include "ycsbr/gen/chooser.h"
+#include "ycsbr/gen/types.h"
+
+namespace ycsbr {
+namespace gen {
+
+// Returns Zipfian-distributed values in the range [0, item_count). Index 0 is
+// the most popular, followed by index 1, and so on. This implementation uses
+// the rejection-inversion method presented in
+//   W. Hörmann and G. Derflinger. Rejection-inversion to generate variates
+//   from monotone discrete distributions. ACM TOMACS 6(3), 1996.
+//
+// Unlike `ZipfianChooser`, this method does not need `zeta(n)`. Construction
+// and `IncreaseItemCountBy()` take constant time regardless of the item count,
+// and any `theta > 0` is supported (including `theta >= 1`). Each sample needs
+// a few more floating point operations than `ZipfianChooser` (and occasionally
+// a retry), but the expected number of retries is small.
+class RejectionInversionZipfianChooser : public Chooser {
+ public:
+  // The value of `theta` must be positive.
+  RejectionInversionZipfianChooser(size_t item_count, double theta);
+
+  size_t Next(PRNG& prng) override;
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override;
+  void IncreaseItemCountBy(size_t delta) override;
+  void SetItemCount(size_t new_item_count) override;
+
+ protected:
+  size_t item_count() const { return item_count_; }
+
+ private:
+  // `H(x)`, an integral of `h(x) = x^(-theta)` (shifted so that it is
+  // well-defined when `theta == 1`).
+  double HIntegral(double x) const;
+  double H(double x) const;
+  double HIntegralInverse(double x) const;
+
+  // `log(1 + x) / x` and `(exp(x) - 1) / x`, computed accurately near 0.
+  static double Helper1(double x);
+  static double Helper2(double x);
+
+  size_t item_count_;
+  double theta_;
+  double h_integral_x1_;
+  double h_integral_num_items_;
+  double s_;
+};
+
+// Returns values from a `RejectionInversionZipfianChooser`, but ensures that
+// the popular values are scattered throughout the range (see
+// `ScatteredZipfianChooser`).
+class ScatteredRejectionInversionZipfianChooser
+    : public RejectionInversionZipfianChooser {
+ public:
+  ScatteredRejectionInversionZipfianChooser(size_t item_count, double theta,
+                                            uint64_t scatter_salt = 0);
+  size_t Next(PRNG& prng) override;
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override;
+
+ private:
+  uint64_t scatter_salt_;
+};
+
+// Implementation details follow.
+
+inline RejectionInversionZipfianChooser::RejectionInversionZipfianChooser(
+    const size_t item_count, const double theta)
+    : item_count_(item_count),
+      theta_(theta),
+      h_integral_x1_(0.0),
+      h_integral_num_items_(0.0),
+      s_(0.0) {
+  assert(item_count > 0);
+  assert(theta > 0.0);
+  h_integral_x1_ = HIntegral(1.5) - 1.0;
+  s_ = 2.0 - HIntegralInverse(HIntegral(2.5) - H(2.0));
+  SetItemCount(item_count);
+}
+
+inline size_t RejectionInversionZipfianChooser::Next(PRNG& prng) {
+  // The sampled values are in the range [1, item_count].
+  while (true) {
+    const double u =
+        h_integral_num_items_ +
+        prng.NextDouble() * (h_integral_x1_ - h_integral_num_items_);
+    const double x = HIntegralInverse(u);
+    double k = std::floor(x + 0.5);
+    if (k < 1.0) {
+      k = 1.0;
+    } else if (k > static_cast<double>(item_count_)) {
+      k = static_cast<double>(item_count_);
+    }
+    if (k - x <= s_ || u >= HIntegral(k + 0.5) - H(k)) {
+      return static_cast<size_t>(k) - 1;
+    }
+  }
+}
+
+inline void RejectionInversionZipfianChooser::NextBatch(PRNG& prng,
+                                                        size_t* out,
+                                                        const size_t n) {
+  // Each sample may need a different number of uniform values, so the samples
+  // are drawn one at a time (but without a virtual call per sample).
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = RejectionInversionZipfianChooser::Next(prng);
+  }
+}
+
+inline void RejectionInversionZipfianChooser::IncreaseItemCountBy(
+    const size_t delta) {
+  SetItemCount(item_count_ + delta);
+}
+
+inline void RejectionInversionZipfianChooser::SetItemCount(
+    const size_t new_item_count) {
+  assert(new_item_count > 0);
+  item_count_ = new_item_count;
+  h_integral_num_items_ = HIntegral(static_cast<double>(item_count_) + 0.5);
+}
+
+inline double RejectionInversionZipfianChooser::HIntegral(
+    const double x) const {
+  const double log_x = std::log(x);
+  return Helper2((1.0 - theta_) * log_x) * log_x;
+}
+
+inline double RejectionInversionZipfianChooser::H(const double x) const {
+  return std::exp(-theta_ * std::log(x));
+}
+
+inline double RejectionInversionZipfianChooser::HIntegralInverse(
+    const double x) const {
+  double t = x * (1.0 - theta_);
+  if (t < -1.0) {
+    // Limit the value to avoid NaNs caused by rounding errors.
+    t = -1.0;
+  }
+  return std::exp(Helper1(t) * x);
+}
+
+inline double RejectionInversionZipfianChooser::Helper1(const double x) {
+  if (std::abs(x) > 1e-8) {
+    return std::log1p(x) / x;
+  }
+  return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+inline double RejectionInversionZipfianChooser::Helper2(const double x) {
+  if (std::abs(x) > 1e-8) {
+    return std::expm1(x) / x;
+  }
+  return 1.0 + x * 0.5 * (1.0 + x * 1.0 / 3.0 * (1.0 + 0.25 * x));
+}
+
+inline ScatteredRejectionInversionZipfianChooser::
+    ScatteredRejectionInversionZipfianChooser(const size_t item_count,
+                                              const double theta,
+                                              const uint64_t scatter_salt)
+    : RejectionInversionZipfianChooser(item_count, theta),
+      scatter_salt_(scatter_salt) {}
+
+inline size_t ScatteredRejectionInversionZipfianChooser::Next(PRNG& prng) {
+  return ScatterChoice(RejectionInversionZipfianChooser::Next(prng),
+                       scatter_salt_, item_count());
+}
+
+inline void ScatteredRejectionInversionZipfianChooser::NextBatch(
+    PRNG& prng, size_t* out, const size_t n) {
+  RejectionInversionZipfianChooser::NextBatch(prng, out, n);
+  ScatterChoices(out, n, scatter_salt_, item_count());
+}
+
+}  // namespace gen
+}  // namespace ycsbr
@@ -1,12 +1,30 @@
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <limits>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "ycsbr/gen/prng.h"
+
 namespace ycsbr {
 namespace gen {
 
+namespace sampling {
+
+// Returns a uniform value in [0, 1). A `PRNG` uses one 64-bit output per value
+// (see `PRNG::NextDouble()`).
+template <class RNG>
+inline double UniformDouble(RNG& rng) {
+  return std::generate_canonical<double, std::numeric_limits<double>::digits>(
+      rng);
+}
+
+inline double UniformDouble(PRNG& prng) { return prng.NextDouble(); }
+
+}  // namespace sampling
+
 template <typename T, class RNG>
 inline void FloydSample(const size_t num_samples, const Range<T>& range,
                         std::vector<T>* dest, const size_t start_index,
@@ -41,12 +59,11 @@ void SelectionSample(const size_t num_samples, const Range<T>& range,
   assert(start_index < dest->size());
   assert(start_index + num_samples <= dest->size());
 
-  std::uniform_real_distribution<double> dist(0.0, 1.0);
   const T interval = range.max() - range.min() + 1;
   size_t samples_so_far = 0;
   T curr = 0;
   while (samples_so_far < num_samples) {
-    const double u = dist(rng);
+    const double u = sampling::UniformDouble(rng);
     if ((interval - curr) * u < num_samples - samples_so_far) {
       (*dest)[start_index + samples_so_far++] = range.min() + curr;
     }
@@ -86,6 +103,124 @@ void FisherYatesSample(const size_t num_samples, const Range<T>& range,
   }
 }
 
+namespace vitter {
+
+// Vitter's Method A, which is used to select the last few samples. Selects
+// `num_samples` of the `num_records` values starting at `current` and writes
+// them to `out` (in ascending order).
+template <typename T, class RNG>
+void MethodA(size_t num_samples, double num_records, T current, T* out,
+             RNG& rng) {
+  double top = num_records - num_samples;
+  while (num_samples >= 2) {
+    const double v = sampling::UniformDouble(rng);
+    T skip = 0;
+    double quot = top / num_records;
+    while (quot > v) {
+      ++skip;
+      top -= 1.0;
+      num_records -= 1.0;
+      quot = quot * top / num_records;
+    }
+    current += skip;
+    *out++ = current++;
+    num_records -= 1.0;
+    --num_samples;
+  }
+  if (num_samples == 1) {
+    const T skip = static_cast<T>(num_records * sampling::UniformDouble(rng));
+    *out = current + skip;
+  }
+}
+
+}  // namespace vitter
+
+template <typename T, class RNG>
+void VitterSample(size_t num_samples, const Range<T>& range,
+                  std::vector<T>* dest, const size_t start_index, RNG& rng) {
+  assert(range.size() >= num_samples);
+  assert(range.size() <= (1ULL << 53));
+  assert(start_index + num_samples <= dest->size());
+  if (num_samples == 0) return;
+
+  // Returns a uniform value in (0, 1].
+  const auto uniform = [&rng]() { return 1.0 - sampling::UniformDouble(rng); };
+
+  // The variable names follow the paper. `n` is the number of samples left to
+  // select and `big_n` is the number of records left to select from.
+  constexpr double kAlphaInverse = 13.0;
+  double n = num_samples;
+  double big_n = range.size();
+  T current = range.min();
+  T* out = dest->data() + start_index;
+
+  double v_prime = std::exp(std::log(uniform()) / n);
+  double qu1 = big_n - n + 1.0;
+  double threshold = kAlphaInverse * n;
+  while (n > 1.0 && threshold < big_n) {
+    const double n_min1_inv = 1.0 / (n - 1.0);
+    double skip = 0.0;
+    while (true) {
+      // Step D2: Generate `u` and `x`.
+      double x = 0.0;
+      while (true) {
+        x = big_n * (1.0 - v_prime);
+        skip = std::floor(x);
+        if (skip < qu1) break;
+        v_prime = std::exp(std::log(uniform()) / n);
+      }
+      const double u = uniform();
+      const double y1 = std::exp(std::log(u * big_n / qu1) * n_min1_inv);
+      v_prime = y1 * (1.0 - x / big_n) * (qu1 / (qu1 - skip));
+      if (v_prime <= 1.0) {
+        // Step D3: Accept the skip (the fast test succeeded).
+        break;
+      }
+
+      // Step D4: Compute the exact acceptance test.
+      double y2 = 1.0;
+      double top = big_n - 1.0;
+      double bottom = 0.0, limit = 0.0;
+      if (n - 1.0 > skip) {
+        bottom = big_n - n;
+        limit = big_n - skip;
+      } else {
+        bottom = big_n - skip - 1.0;
+        limit = qu1;
+      }
+      for (double t = big_n - 1.0; t >= limit; t -= 1.0) {
+        y2 = (y2 * top) / bottom;
+        top -= 1.0;
+        bottom -= 1.0;
+      }
+      if (big_n / (big_n - x) >= y1 * std::exp(std::log(y2) * n_min1_inv)) {
+        // Accept the skip.
+        v_prime = std::exp(std::log(uniform()) * n_min1_inv);
+        break;
+      }
+      v_prime = std::exp(std::log(uniform()) / n);
+    }
+
+    // Step D5: Skip `skip` records and select the next one.
+    current += static_cast<T>(skip);
+    *out++ = current++;
+    big_n -= skip + 1.0;
+    n -= 1.0;
+    qu1 -= skip;
+    threshold -= kAlphaInverse;
+  }
+
+  if (n > 1.0) {
+    // Method A is faster when the remaining sample is dense.
+    vitter::MethodA<T, RNG>(static_cast<size_t>(n), big_n, current, out, rng);
+  } else {
+    // Select the last sample uniformly from the remaining records.
+    const T skip = std::min(static_cast<T>(big_n * v_prime),
+                            static_cast<T>(big_n - 1.0));
+    *out = current + skip;
+  }
+}
+
 template <typename T, class RNG>
 void SampleWithoutReplacement(const size_t num_samples, const Range<T>& range,
                               std::vector<T>* dest, const size_t start_index,
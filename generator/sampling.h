@@ -29,6 +29,16 @@ template <typename T, class RNG>
 void FisherYatesSample(size_t num_samples, const Range<T>& range,
                        std::vector<T>* dest, size_t start_index, RNG& rng);
 
+// An implementation of Vitter's sequential sampling algorithm (Method D). The
+// samples are written in ascending order and no extra memory is used. The
+// range's size must be at most 2^53 (the computations use `double`s). For more
+// details, see:
+//   J. S. Vitter. An efficient algorithm for sequential random sampling. ACM
+//   TOMS 13(1), 1987.
+template <typename T, class RNG>
+void VitterSample(size_t num_samples, const Range<T>& range,
+                  std::vector<T>* dest, size_t start_index, RNG& rng);
+
 // Selects which of the above sampling algorithms to run (for performance
 // reasons) using heuristics based on the input parameters.
 template <typename T, class RNG>
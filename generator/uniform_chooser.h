@@ -23,6 +23,12 @@ class UniformChooser : public Chooser {
 
   size_t Next(PRNG& prng) override { return dist_(prng); }
 
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = dist_(prng);
+    }
+  }
+
   void SetItemCount(const size_t item_count) override {
     item_count_ = item_count;
     UpdateDistribution();
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <memory>
 #include <stdexcept>
 #include <unordered_set>
 
@@ -26,5 +27,37 @@ void UniformGenerator::Generate(PRNG& prng, std::vector<Request::Key>* dest,
                dest->begin() + start_index + num_keys_, prng);
 }
 
+void UniformGenerator::GenerateSorted(PRNG& prng,
+                                      std::vector<Request::Key>* dest,
+                                      const size_t start_index) const {
+  // Sequential sampling produces sorted keys without any extra memory.
+  VitterSample<Request::Key, PRNG>(num_keys_, range_, dest, start_index, prng);
+}
+
+std::vector<Generator::Part> UniformGenerator::Split(
+    const size_t num_parts) const {
+  std::vector<Part> parts;
+  if (num_parts <= 1 || num_keys_ < num_parts) return parts;
+  parts.reserve(num_parts);
+  // The products below do not overflow because keys use at most 48 bits.
+  const Request::Key range_size = range_.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    const Request::Key part_min = range_.min() + range_size * i / num_parts;
+    const Request::Key part_max =
+        range_.min() + range_size * (i + 1) / num_parts - 1;
+    const size_t part_keys =
+        num_keys_ * (i + 1) / num_parts - num_keys_ * i / num_parts;
+    const KeyRange part_range(part_min, part_max);
+    if (part_range.size() < part_keys) {
+      // Rounding left a subrange too small for its keys.
+      return {};
+    }
+    parts.push_back(
+        Part{part_keys,
+             std::make_unique<UniformGenerator>(part_keys, part_range)});
+  }
+  return parts;
+}
+
 }  // namespace gen
 }  // namespace ycsbr
@@ -17,6 +17,12 @@ class UniformGenerator : public Generator {
 
   void Generate(PRNG& prng, std::vector<Request::Key>* dest,
                 size_t start_index) const override;
+  void GenerateSorted(PRNG& prng, std::vector<Request::Key>* dest,
+                      size_t start_index) const override;
+
+  // Splits the range into `num_parts` equal subranges. Each subrange's number
+  // of keys is proportional to its size.
+  std::vector<Part> Split(size_t num_parts) const override;
 
  private:
   size_t num_keys_;
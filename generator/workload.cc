@@ -1,9 +1,17 @@
 #include "ycsbr/gen/workload.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 
+#include "keyspace_replicas.h"
 #include "ycsbr/buffered_workload.h"
 #include "ycsbr/gen/types.h"
+#include "ycsbr/impl/numa.h"
+#include "ycsbr/impl/thread_pool.h"
+#include "ycsbr/looping_workload.h"
+#include "ycsbr/pipelined_workload.h"
+#include "ycsbr/trace.h"
 
 namespace {
 
@@ -14,6 +22,18 @@ using namespace ycsbr::gen;
 // making updates).
 constexpr size_t kNumUniqueValues = 100;
 
+// Load keys are generated in independent parts of about this many keys (in
+// parallel). The number of parts only depends on the number of load keys, so
+// the generated keys do not depend on the number of cores.
+constexpr size_t kLoadKeysPerPart = 1ULL << 20;
+
+// Datasets are sorted in parallel in chunks of about this many keys.
+constexpr size_t kSortKeysPerChunk = 1ULL << 20;
+
+// Returns the key that `ApplyPhaseAndProducerIDs()` maps `key` to for the
+// initial load (i.e., for phase 0 and producer 0).
+Request::Key ApplyLoadIDs(const Request::Key key) { return key << 16; }
+
 void ApplyPhaseAndProducerIDs(std::vector<Request::Key>::iterator begin,
                               std::vector<Request::Key>::iterator end,
                               const PhaseID phase_id,
@@ -23,12 +43,42 @@ void ApplyPhaseAndProducerIDs(std::vector<Request::Key>::iterator begin,
   }
 }
 
+// Produces the same result as `std::sort()`, using all cores.
+void ParallelSort(std::vector<Request::Key>* keys) {
+  const size_t num_chunks =
+      (keys->size() + kSortKeysPerChunk - 1) / kSortKeysPerChunk;
+  if (num_chunks <= 1) {
+    std::sort(keys->begin(), keys->end());
+    return;
+  }
+  const auto chunk_begin = [keys, num_chunks](const size_t chunk) {
+    return keys->begin() + keys->size() * chunk / num_chunks;
+  };
+  impl::ParallelFor(num_chunks, [&](const size_t chunk) {
+    std::sort(chunk_begin(chunk), chunk_begin(chunk + 1));
+  });
+  // Merge pairs of adjacent sorted runs until one run remains.
+  for (size_t width = 1; width < num_chunks; width *= 2) {
+    const size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+    impl::ParallelFor(num_merges, [&](const size_t merge) {
+      const size_t first = merge * 2 * width;
+      const size_t middle = std::min(first + width, num_chunks);
+      const size_t last = std::min(first + 2 * width, num_chunks);
+      std::inplace_merge(chunk_begin(first), chunk_begin(middle),
+                         chunk_begin(last));
+    });
+  }
+}
+
 }  // namespace
 
 namespace ycsbr {
 
-// For convenience, instantiate a `BufferedWorkload` for `PhasedWorkload`.
+// For convenience, instantiate a `BufferedWorkload`, a `PipelinedWorkload`,
+// and a `LoopingWorkload` for `PhasedWorkload`.
 template class BufferedWorkload<gen::PhasedWorkload>;
+template class PipelinedWorkload<gen::PhasedWorkload>;
+template class LoopingWorkload<gen::PhasedWorkload>;
 
 namespace gen {
 
@@ -51,25 +101,73 @@ std::unique_ptr<PhasedWorkload> PhasedWorkload::LoadFromString(
 
 PhasedWorkload::PhasedWorkload(std::shared_ptr<WorkloadConfig> config,
                                const uint32_t prng_seed)
-    : prng_(prng_seed),
+    : prng_(prng_seed, config->GetPRNGType()),
       prng_seed_(prng_seed),
       config_(std::move(config)),
-      load_keys_(nullptr) {
+      replicate_load_keys_(false) {
   // If we're using a custom dataset, the user will call SetCustomLoadDataset()
   // to configure `load_keys_`.
   if (config_->UsingCustomDataset()) return;
 
-  load_keys_ = std::make_shared<std::vector<Request::Key>>(
-      config_->GetNumLoadRecords(), 0);
+  const size_t num_load_keys = config_->GetNumLoadRecords();
   auto load_gen = config_->GetLoadGenerator();
-  load_gen->Generate(prng_, load_keys_.get(), 0);
-  ApplyPhaseAndProducerIDs(load_keys_->begin(), load_keys_->end(),
-                           /*phase_id=*/0,
-                           /*producer_id=*/0);
 
-  // Keep the initial load keys sorted to allow for efficiently generating
-  // clustered hot sets.
-  std::sort(load_keys_->begin(), load_keys_->end());
+  // Keys that can be computed from their index are not stored. Note that
+  // applying the load IDs to a progression's keys produces another
+  // progression.
+  const auto progression = load_gen->SortedProgression();
+  if (progression.has_value()) {
+    load_keys_ = KeySpace::Arithmetic(ApplyLoadIDs(progression->start),
+                                      ApplyLoadIDs(progression->step),
+                                      num_load_keys);
+    return;
+  }
+
+  auto load_keys =
+      std::make_shared<std::vector<Request::Key>>(num_load_keys, 0);
+  std::vector<Generator::Part> parts = load_gen->Split(
+      (num_load_keys + kLoadKeysPerPart - 1) / kLoadKeysPerPart);
+
+  if (parts.empty()) {
+    load_gen->Generate(prng_, load_keys.get(), 0);
+    ApplyPhaseAndProducerIDs(load_keys->begin(), load_keys->end(),
+                             /*phase_id=*/0,
+                             /*producer_id=*/0);
+
+    // Keep the initial load keys sorted to allow for efficiently generating
+    // clustered hot sets.
+    std::sort(load_keys->begin(), load_keys->end());
+    load_keys_ = KeySpace::Materialized(std::move(load_keys));
+    return;
+  }
+
+  // Each part is generated using its own PRNG. The PRNGs' seeds are drawn
+  // sequentially (before generating any keys) so that the keys only depend on
+  // `prng_seed`.
+  std::vector<size_t> part_offsets;
+  std::vector<PRNG::result_type> part_seeds;
+  part_offsets.reserve(parts.size() + 1);
+  part_seeds.reserve(parts.size());
+  part_offsets.push_back(0);
+  for (const auto& part : parts) {
+    part_offsets.push_back(part_offsets.back() + part.num_keys);
+    part_seeds.push_back(prng_());
+  }
+  assert(part_offsets.back() == num_load_keys);
+
+  // Each part's keys are generated in ascending order. The parts' key ranges
+  // are disjoint and ascending, so the load keys end up sorted without an
+  // explicit sort.
+  const PRNG::Type prng_type = config_->GetPRNGType();
+  impl::ParallelFor(parts.size(), [&](const size_t i) {
+    PRNG part_prng(part_seeds[i], prng_type);
+    parts[i].generator->GenerateSorted(part_prng, load_keys.get(),
+                                       part_offsets[i]);
+    ApplyPhaseAndProducerIDs(load_keys->begin() + part_offsets[i],
+                             load_keys->begin() + part_offsets[i + 1],
+                             /*phase_id=*/0, /*producer_id=*/0);
+  });
+  load_keys_ = KeySpace::Materialized(std::move(load_keys));
 }
 
 void PhasedWorkload::SetCustomLoadDataset(std::vector<Request::Key> dataset) {
@@ -77,13 +175,18 @@ void PhasedWorkload::SetCustomLoadDataset(std::vector<Request::Key> dataset) {
   if (*std::max_element(dataset.begin(), dataset.end()) > kMaxKey) {
     throw std::invalid_argument("The maximum supported key is 2^48 - 1.");
   }
-  load_keys_ = std::make_shared<std::vector<Request::Key>>(std::move(dataset));
-  ApplyPhaseAndProducerIDs(load_keys_->begin(), load_keys_->end(),
+  auto load_keys =
+      std::make_shared<std::vector<Request::Key>>(std::move(dataset));
+  ApplyPhaseAndProducerIDs(load_keys->begin(), load_keys->end(),
                            /*phase_id=*/0, /*producer_id=*/0);
 
   // Keep the initial load keys sorted to allow for efficiently generating
   // clustered hot sets.
-  std::sort(load_keys_->begin(), load_keys_->end());
+  ParallelSort(load_keys.get());
+  load_keys_ = KeySpace::Materialized(std::move(load_keys));
+  if (replicate_load_keys_) {
+    load_key_replicas_ = std::make_shared<KeySpaceReplicas>(load_keys_);
+  }
 }
 
 void PhasedWorkload::AddCustomInsertList(const std::string& name,
@@ -99,6 +202,12 @@ void PhasedWorkload::AddCustomInsertList(const std::string& name,
   custom_inserts_->emplace(name, std::move(to_insert));
 }
 
+void PhasedWorkload::SetReplicateLoadKeysPerNumaNode(const bool replicate) {
+  replicate_load_keys_ = replicate;
+  load_key_replicas_ =
+      replicate ? std::make_shared<KeySpaceReplicas>(load_keys_) : nullptr;
+}
+
 size_t PhasedWorkload::GetRecordSizeBytes() const {
   return config_->GetRecordSizeBytes();
 }
@@ -107,7 +216,10 @@ BulkLoadTrace PhasedWorkload::GetLoadTrace(const bool sort_requests) const {
   Trace::Options options;
   options.value_size = config_->GetRecordSizeBytes() - sizeof(Request::Key);
   options.sort_requests = sort_requests;
-  return BulkLoadTrace::LoadFromKeys(*load_keys_, options);
+  if (load_keys_.IsMaterialized()) {
+    return BulkLoadTrace::LoadFromKeys(load_keys_.keys(), options);
+  }
+  return BulkLoadTrace::LoadFromKeys(load_keys_.ToVector(), options);
 }
 
 std::vector<Producer> PhasedWorkload::GetProducers(
@@ -120,32 +232,40 @@ std::vector<Producer> PhasedWorkload::GetProducers(
         // Producer to produce different requests from each other. So we include
         // the producer ID in its seed.
         Producer(config_, load_keys_, custom_inserts_, id, num_producers,
-                 prng_seed_ ^ id));
+                 prng_seed_ ^ id, load_key_replicas_));
   }
   return producers;
 }
 
 Producer::Producer(
-    std::shared_ptr<const WorkloadConfig> config,
-    std::shared_ptr<const std::vector<Request::Key>> load_keys,
+    std::shared_ptr<const WorkloadConfig> config, KeySpace load_keys,
     std::shared_ptr<
         const std::unordered_map<std::string, std::vector<Request::Key>>>
         custom_inserts,
-    const ProducerID id, const size_t num_producers, const uint32_t prng_seed)
+    const ProducerID id, const size_t num_producers, const uint32_t prng_seed,
+    std::shared_ptr<KeySpaceReplicas> load_key_replicas)
     : id_(id),
       num_producers_(num_producers),
       config_(std::move(config)),
-      prng_(prng_seed),
+      prng_(prng_seed, config_->GetPRNGType()),
       current_phase_(0),
       load_keys_(std::move(load_keys)),
-      num_load_keys_(load_keys_->size()),
+      num_load_keys_(load_keys_.size()),
+      load_key_replicas_(std::move(load_key_replicas)),
       custom_inserts_(std::move(custom_inserts)),
       next_insert_key_index_(0),
-      valuegen_(config_->GetRecordSizeBytes() - sizeof(Request::Key),
-                kNumUniqueValues, prng_),
-      op_dist_(0, 99) {}
+      op_dist_(0, 99),
+      next_request_index_(0),
+      requests_phase_(0) {}
 
 void Producer::Prepare() {
+  if (load_key_replicas_ != nullptr) {
+    load_keys_ = load_key_replicas_->ForNode(impl::CurrentNumaNode());
+  }
+  // The values must be generated before the inserts (they use the same PRNG).
+  valuegen_.emplace(config_->GetRecordSizeBytes() - sizeof(Request::Key),
+                    kNumUniqueValues, prng_);
+
   // Set up the workload phases.
   const size_t num_phases = config_->GetNumPhases();
   phases_.reserve(num_phases);
@@ -198,122 +318,175 @@ void Producer::Prepare() {
 
   // Set the phase chooser item counts based on the number of inserts the
   // producer will make in each phase.
-  size_t count = load_keys_->size();
+  size_t count = load_keys_.size();
   for (auto& phase : phases_) {
     phase.SetItemCount(count);
     count += phase.num_inserts;
   }
 }
 
-Request::Key Producer::ChooseKey(const std::unique_ptr<Chooser>& chooser) {
-  const size_t index = chooser->Next(prng_);
+Request::Key Producer::ToKey(const size_t index) const {
   if (index < num_load_keys_) {
-    return (*load_keys_)[index];
+    return load_keys_[index];
   }
   return insert_keys_[index - num_load_keys_];
 }
 
-Request Producer::Next() {
-  assert(HasNext());
+void Producer::GenerateRequests() {
+  assert(current_phase_ < phases_.size());
   Phase& this_phase = phases_[current_phase_];
-
-  Request::Operation next_op = Request::Operation::kInsert;
-
-  // If there are more requests left than inserts, we can randomly decide what
-  // request to do next. Otherwise we must do an insert. Note that we adjust
-  // `op_dist_` as needed to ensure that we do not generate an insert once
-  // `this_phase.num_inserts_left == 0`.
-  if (this_phase.num_inserts_left < this_phase.num_requests_left) {
-    // Decide what operation to do.
-    const uint32_t choice = op_dist_(prng_);
-    if (choice < this_phase.read_thres) {
-      next_op = Request::Operation::kRead;
-    } else if (choice < this_phase.rmw_thres) {
-      next_op = Request::Operation::kReadModifyWrite;
-    } else if (choice < this_phase.negativeread_thres) {
-      next_op = Request::Operation::kNegativeRead;
-    } else if (choice < this_phase.scan_thres) {
-      next_op = Request::Operation::kScan;
-    } else if (choice < this_phase.update_thres) {
-      next_op = Request::Operation::kUpdate;
-    } else {
-      next_op = Request::Operation::kInsert;
-      assert(this_phase.num_inserts_left > 0);
-    }
+  const size_t num_requests =
+      std::min(kRequestBatchSize, this_phase.num_requests_left);
+  ChooseOperations(num_requests);
+
+  requests_.resize(num_requests);
+  next_request_index_ = 0;
+  requests_phase_ = current_phase_;
+
+  // Inserts change the choosers' item counts, so the keys are chosen in runs
+  // that end at each insert.
+  size_t run_begin = 0;
+  for (size_t i = 0; i < num_requests; ++i) {
+    if (ops_[i] != Request::Operation::kInsert) continue;
+    ChooseKeys(run_begin, i);
+    requests_[i] = Request(Request::Operation::kInsert,
+                           insert_keys_[next_insert_key_index_], 0,
+                           valuegen_->NextValue(), valuegen_->value_size());
+    ++next_insert_key_index_;
+    this_phase.IncreaseItemCountBy(1);
+    run_begin = i + 1;
   }
+  ChooseKeys(run_begin, num_requests);
 
-  Request to_return;
-  switch (next_op) {
-    case Request::Operation::kRead: {
-      to_return = Request(Request::Operation::kRead,
-                          ChooseKey(this_phase.read_chooser), 0, nullptr, 0);
-      break;
-    }
-
-    case Request::Operation::kReadModifyWrite: {
-      to_return = Request(Request::Operation::kReadModifyWrite,
-                          ChooseKey(this_phase.rmw_chooser), 0,
-                          valuegen_.NextValue(), valuegen_.value_size());
-      break;
-    }
-
-    case Request::Operation::kNegativeRead: {
-      Request::Key to_read = ChooseKey(this_phase.negativeread_chooser);
-      to_read |= (0xFF << 8);
-      to_return =
-          Request(Request::Operation::kNegativeRead, to_read, 0, nullptr, 0);
-      break;
-    }
-
-    case Request::Operation::kScan: {
-      // We add 1 to the chosen scan length because `Chooser` instances always
-      // return values in a 0-based range.
-      to_return =
-          Request(Request::Operation::kScan, ChooseKey(this_phase.scan_chooser),
-                  this_phase.scan_length_chooser->Next(prng_) + 1, nullptr, 0);
-      break;
-    }
+  // Advance to the next batch.
+  this_phase.num_requests_left -= num_requests;
+  if (this_phase.num_requests_left == 0) {
+    ++current_phase_;
+    // Reset the operation selection distribution.
+    op_dist_ = std::uniform_int_distribution<uint32_t>(0, 99);
+  }
+}
 
-    case Request::Operation::kUpdate: {
-      to_return = Request(Request::Operation::kUpdate,
-                          ChooseKey(this_phase.update_chooser), 0,
-                          valuegen_.NextValue(), valuegen_.value_size());
-      break;
+void Producer::ChooseOperations(const size_t num_requests) {
+  Phase& this_phase = phases_[current_phase_];
+  ops_.resize(num_requests);
+  for (size_t i = 0; i < num_requests; ++i) {
+    Request::Operation next_op = Request::Operation::kInsert;
+    // If there are more requests left than inserts, we can randomly decide
+    // what request to do next. Otherwise we must do an insert. Note that we
+    // adjust `op_dist_` as needed to ensure that we do not generate an insert
+    // once `this_phase.num_inserts_left == 0`.
+    if (this_phase.num_inserts_left < this_phase.num_requests_left - i) {
+      // Decide what operation to do.
+      const uint32_t choice = op_dist_(prng_);
+      if (choice < this_phase.read_thres) {
+        next_op = Request::Operation::kRead;
+      } else if (choice < this_phase.rmw_thres) {
+        next_op = Request::Operation::kReadModifyWrite;
+      } else if (choice < this_phase.negativeread_thres) {
+        next_op = Request::Operation::kNegativeRead;
+      } else if (choice < this_phase.scan_thres) {
+        next_op = Request::Operation::kScan;
+      } else if (choice < this_phase.update_thres) {
+        next_op = Request::Operation::kUpdate;
+      } else {
+        next_op = Request::Operation::kInsert;
+        assert(this_phase.num_inserts_left > 0);
+      }
     }
+    ops_[i] = next_op;
 
-    case Request::Operation::kInsert: {
-      to_return = Request(Request::Operation::kInsert,
-                          insert_keys_[next_insert_key_index_], 0,
-                          valuegen_.NextValue(), valuegen_.value_size());
-      ++next_insert_key_index_;
+    if (next_op == Request::Operation::kInsert) {
       --this_phase.num_inserts_left;
-      this_phase.IncreaseItemCountBy(1);
       if (this_phase.num_inserts_left == 0) {
         // No more inserts left. We adjust the operation selection distribution
-        // to make sure we no longer select inserts during this phase. Note that
-        // the bounds used below are inclusive.
+        // to make sure we no longer select inserts during this phase. Note
+        // that the bounds used below are inclusive.
         if (this_phase.update_thres > 0) {
           op_dist_ = std::uniform_int_distribution<uint32_t>(
               0, this_phase.update_thres - 1);
         } else {
-          // This case should only occur if the workload is insert-only. However
-          // this means that this was the last request (we decrement the
-          // requests counter below).
-          assert(this_phase.num_requests_left == 1);
+          // This case should only occur if the workload is insert-only.
+          // However this means that this was the last request.
+          assert(this_phase.num_requests_left - i == 1);
         }
       }
-      break;
     }
   }
+}
 
-  // Advance to the next request.
-  --this_phase.num_requests_left;
-  if (this_phase.num_requests_left == 0) {
-    ++current_phase_;
-    // Reset the operation selection distribution.
-    op_dist_ = std::uniform_int_distribution<uint32_t>(0, 99);
+void Producer::ChooseKeys(const size_t begin, const size_t end) {
+  if (begin == end) return;
+  Phase& this_phase = phases_[current_phase_];
+
+  // Count the number of keys needed for each operation.
+  std::array<size_t, Request::kNumOperations> counts = {};
+  for (size_t i = begin; i < end; ++i) {
+    ++counts[static_cast<size_t>(ops_[i])];
+  }
+
+  const auto choose = [this, &counts](Request::Operation op,
+                                      const std::unique_ptr<Chooser>& chooser) {
+    const size_t count = counts[static_cast<size_t>(op)];
+    if (count == 0) return;
+    std::vector<size_t>& choices = choices_[static_cast<size_t>(op)];
+    choices.resize(count);
+    chooser->NextBatch(prng_, choices.data(), count);
+  };
+  choose(Request::Operation::kRead, this_phase.read_chooser);
+  choose(Request::Operation::kReadModifyWrite, this_phase.rmw_chooser);
+  choose(Request::Operation::kNegativeRead, this_phase.negativeread_chooser);
+  choose(Request::Operation::kScan, this_phase.scan_chooser);
+  choose(Request::Operation::kUpdate, this_phase.update_chooser);
+  const size_t num_scans =
+      counts[static_cast<size_t>(Request::Operation::kScan)];
+  if (num_scans > 0) {
+    scan_lengths_.resize(num_scans);
+    this_phase.scan_length_chooser->NextBatch(prng_, scan_lengths_.data(),
+                                              num_scans);
+  }
+
+  // Assemble the requests. `counts` is reused to track the next unused choice
+  // for each operation.
+  counts.fill(0);
+  for (size_t i = begin; i < end; ++i) {
+    const Request::Operation op = ops_[i];
+    const size_t choice_index = counts[static_cast<size_t>(op)]++;
+    const Request::Key key =
+        ToKey(choices_[static_cast<size_t>(op)][choice_index]);
+    switch (op) {
+      case Request::Operation::kRead: {
+        requests_[i] = Request(op, key, 0, nullptr, 0);
+        break;
+      }
+
+      case Request::Operation::kNegativeRead: {
+        requests_[i] = Request(op, key | (0xFF << 8), 0, nullptr, 0);
+        break;
+      }
+
+      case Request::Operation::kScan: {
+        // We add 1 to the chosen scan length because `Chooser` instances
+        // always return values in a 0-based range.
+        requests_[i] =
+            Request(op, key, scan_lengths_[choice_index] + 1, nullptr, 0);
+        break;
+      }
+
+      case Request::Operation::kReadModifyWrite:
+      case Request::Operation::kUpdate: {
+        requests_[i] = Request(op, key, 0, valuegen_->NextValue(),
+                               valuegen_->value_size());
+        break;
+      }
+
+      case Request::Operation::kInsert: {
+        // Inserts are handled by `GenerateRequests()`.
+        assert(false);
+        break;
+      }
+    }
   }
-  return to_return;
 }
 
 }  // namespace gen
@@ -44,9 +44,9 @@ class ZetaCache {
         // No previous values.
         return std::optional<std::pair<size_t, double>>();
       } else {
-        // Not an exact match, so the starting point should be the first zeta
-        // computed with a smaller item count.
-        return *std::prev(theta_map.end());
+        // Not an exact match, so the starting point should be the zeta
+        // computed with the largest smaller item count.
+        return *std::prev(it);
       }
     }
   }
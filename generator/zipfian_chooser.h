@@ -1,9 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
-#include <random>
 
 #include "hash.h"
 #include "ycsbr/gen/chooser.h"
@@ -16,6 +16,9 @@ namespace gen {
 // turn uses the algorithm presented in
 //   J. Gray et al. Quickly generating billion-record synthetic databases. In
 //   SIGMOD'94.
+//
+// This method needs `zeta(n)`, which takes O(item_count) time to compute. See
+// `RejectionInversionZipfianChooser` for an alternative that does not.
 class ZipfianChooser : public Chooser {
  public:
   // The value of `theta` must be in the exclusive range (0, 1).
@@ -25,6 +28,7 @@ class ZipfianChooser : public Chooser {
   // [0, item_count). Note that index 0 will be the most popular, followed by
   // index 1, and so on.
   size_t Next(PRNG& prng) override;
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override;
 
   // This requires some computation and can be slow if `delta` is large.
   void IncreaseItemCountBy(size_t delta) override;
@@ -36,6 +40,10 @@ class ZipfianChooser : public Chooser {
   size_t item_count() const;
 
  private:
+  // `NextBatch()` draws this many uniform values at a time.
+  static constexpr size_t kBatchChunkSize = 64;
+
+  size_t ToChoice(double u) const;
   static double ComputeZetaN(size_t item_count, double theta,
                              size_t prev_item_count = 0,
                              double prev_zeta_n = 0.0);
@@ -50,8 +58,6 @@ class ZipfianChooser : public Chooser {
   double zeta2theta_;
   double zeta_n_;
   double eta_;
-
-  std::uniform_real_distribution<double> dist_;
 };
 
 // Returns Zipfian-distributed values in the range [0, item_count), but ensuring
@@ -63,6 +69,7 @@ class ScatteredZipfianChooser : public ZipfianChooser {
   ScatteredZipfianChooser(size_t item_count, double theta,
                           uint64_t scatter_salt = 0);
   size_t Next(PRNG& prng) override;
+  void NextBatch(PRNG& prng, size_t* out, size_t n) override;
 
  private:
   uint64_t scatter_salt_;
@@ -78,8 +85,7 @@ inline ZipfianChooser::ZipfianChooser(const size_t item_count,
       thres_(1.0 + std::pow(0.5, theta)),
       zeta2theta_(ComputeZetaN(2, theta)),
       zeta_n_(0.0),
-      eta_(0.0),
-      dist_(0.0, 1.0) {
+      eta_(0.0) {
   UpdateZetaNWithCaching();
   UpdateETA();
 }
@@ -88,8 +94,25 @@ inline ScatteredZipfianChooser::ScatteredZipfianChooser(
     const size_t item_count, const double theta, const uint64_t scatter_salt)
     : ZipfianChooser(item_count, theta), scatter_salt_(scatter_salt) {}
 
-inline size_t ZipfianChooser::Next(PRNG& prng) {
-  const double u = dist_(prng);
+inline size_t ZipfianChooser::Next(PRNG& prng) { return ToChoice(prng.NextDouble()); }
+
+inline void ZipfianChooser::NextBatch(PRNG& prng, size_t* out,
+                                      const size_t n) {
+  // Drawing the uniform values separately keeps the PRNG out of the loop that
+  // computes the choices.
+  double u[kBatchChunkSize];
+  for (size_t start = 0; start < n; start += kBatchChunkSize) {
+    const size_t count = std::min(kBatchChunkSize, n - start);
+    for (size_t i = 0; i < count; ++i) {
+      u[i] = prng.NextDouble();
+    }
+    for (size_t i = 0; i < count; ++i) {
+      out[start + i] = ToChoice(u[i]);
+    }
+  }
+}
+
+inline size_t ZipfianChooser::ToChoice(const double u) const {
   const double uz = u * zeta_n_;
   if (uz < 1.0) return 0;
   if (uz < thres_) return 1;
@@ -100,17 +123,14 @@ inline size_t ZipfianChooser::Next(PRNG& prng) {
 inline size_t ScatteredZipfianChooser::Next(PRNG& prng) {
   // Most of the generator code assumes that we're running on a 64-bit system.
   static_assert(sizeof(uint64_t) == sizeof(size_t));
-  const uint64_t hashed_choice =
-      FNVHash64(ZipfianChooser::Next(prng) ^ scatter_salt_);
-#ifdef __SIZEOF_INT128__
-  // Fast modulo for 64-bit integers. See
-  // https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
-  return static_cast<uint64_t>((static_cast<__uint128_t>(hashed_choice) *
-                                static_cast<__uint128_t>(item_count())) >>
-                               64);
-#else
-  return hashed_choice % item_count();
-#endif
+  return ScatterChoice(ZipfianChooser::Next(prng), scatter_salt_,
+                       item_count());
+}
+
+inline void ScatteredZipfianChooser::NextBatch(PRNG& prng, size_t* out,
+                                               const size_t n) {
+  ZipfianChooser::NextBatch(prng, out, n);
+  ScatterChoices(out, n, scatter_salt_, item_count());
 }
 
 inline void ZipfianChooser::IncreaseItemCountBy(const size_t delta) {
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace ycsbr {
+
+// Passed to the asynchronous `DatabaseInterface` methods (see `db_example.h`).
+// The database must invoke the callback exactly once when the request
+// completes, on the worker thread that started the request (i.e., either
+// directly inside the asynchronous method or inside `PollAsync()`).
+class AsyncCallback {
+ public:
+  using Function = void (*)(void* context, bool succeeded);
+
+  AsyncCallback(Function function, void* context)
+      : function_(function), context_(context) {}
+
+  void operator()(bool succeeded) const { function_(context_, succeeded); }
+
+ private:
+  Function function_;
+  void* context_;
+};
+
+}  // namespace ycsbr
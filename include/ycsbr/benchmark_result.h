@@ -1,19 +1,28 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <iostream>
+#include <vector>
 
 #include "meter.h"
+#include "request.h"
 
 namespace ycsbr {
+namespace impl {
+class MetricsTracker;
+}  // namespace impl
 
 class BenchmarkResult {
  public:
   BenchmarkResult(std::chrono::nanoseconds total_run_time);
-  BenchmarkResult(std::chrono::nanoseconds total_run_time, uint32_t read_xor,
-                  FrozenMeter reads, FrozenMeter writes, FrozenMeter scans,
-                  size_t failed_reads, size_t failed_writes,
-                  size_t failed_scans);
+  BenchmarkResult(
+      std::chrono::nanoseconds total_run_time, uint32_t read_xor,
+      FrozenMeter reads, FrozenMeter writes, FrozenMeter scans,
+      size_t failed_reads, size_t failed_writes, size_t failed_scans,
+      FrozenMeter batches = FrozenMeter(),
+      std::array<FrozenMeter, Request::kNumOperations> operations = {},
+      std::array<size_t, Request::kNumOperations> failed_operations = {});
 
   template <typename Units>
   Units RunTime() const;
@@ -27,20 +36,74 @@ class BenchmarkResult {
   const FrozenMeter& Writes() const { return writes_; }
   const FrozenMeter& Scans() const { return scans_; }
 
+  // Batches of requests dispatched together (see `RunOptions::batch_size`).
+  // `NumRequests()` is the number of batches and `NumRecords()` is the number
+  // of requests that were batched. Batched requests are also included in
+  // `Reads()` and `Writes()` (with their batch's latency amortized across the
+  // batch).
+  const FrozenMeter& Batches() const { return batches_; }
+
   size_t NumFailedReads() const { return failed_reads_; }
   size_t NumFailedWrites() const { return failed_writes_; }
   size_t NumFailedScans() const { return failed_scans_; }
 
+  // The requests of one `Request::Operation` type (e.g., `Reads()` includes
+  // reads, negative reads, and the read half of read-modify-writes, whereas
+  // `ForOperation(kRead)` only includes reads). Unlike `Reads()`, these meters
+  // also include failed requests (e.g., negative reads that do not find a
+  // record), which are counted in `NumFailedForOperation()` too. The latency
+  // of a read-modify-write spans both its read and its write (its bytes are
+  // only counted in `Reads()` and `Writes()`). These meters are derived from
+  // the same latency samples as the meters above, so like the breakdowns below
+  // they store their latencies in histograms (their percentiles are
+  // approximate).
+  const FrozenMeter& ForOperation(Request::Operation op) const {
+    return operations_[static_cast<size_t>(op)];
+  }
+  size_t NumFailedForOperation(Request::Operation op) const {
+    return failed_operations_[static_cast<size_t>(op)];
+  }
+
+  // The results of each executor (i.e., each thread), indexed by executor ID.
+  // Each executor's run time only spans its own requests. Empty if the results
+  // were not produced by a `Session`.
+  //
+  // To avoid copying every latency sample, the breakdowns below store their
+  // latencies in histograms (see `LatencyHistogram`), so their percentiles are
+  // approximate (within 1%) even if the totals above are exact.
+  const std::vector<BenchmarkResult>& PerExecutor() const {
+    return per_executor_;
+  }
+
+  // The results of each workload phase, indexed by phase ID (across all
+  // executors). A phase's run time spans from when the first executor started
+  // the phase until the last executor finished it. Empty if the workload's
+  // producers do not report phases (see `workload_example.h`).
+  const std::vector<BenchmarkResult>& PerPhase() const { return per_phase_; }
+
   static void PrintCSVHeader(std::ostream& out);
   void PrintAsCSV(std::ostream& out, bool print_header = true) const;
 
+  // Prints `PerExecutor()` and `PerPhase()` as CSV, one row per executor and
+  // per phase. Each row starts with a `scope` column ("executor" or "phase")
+  // and an `id` column, followed by the columns of `PrintAsCSV()`.
+  void PrintBreakdownAsCSV(std::ostream& out, bool print_header = true) const;
+
  private:
+  friend class impl::MetricsTracker;
   friend std::ostream& operator<<(std::ostream& out,
                                   const BenchmarkResult& res);
+  // Prints the columns of `PrintCSVHeader()` (without a header).
+  void PrintCSVRow(std::ostream& out) const;
+
   const std::chrono::nanoseconds run_time_;
-  const FrozenMeter reads_, writes_, scans_;
+  const FrozenMeter reads_, writes_, scans_, batches_;
   const size_t failed_reads_, failed_writes_, failed_scans_;
   const uint32_t read_xor_;
+  const std::array<FrozenMeter, Request::kNumOperations> operations_;
+  const std::array<size_t, Request::kNumOperations> failed_operations_;
+  // Set by `impl::MetricsTracker`.
+  std::vector<BenchmarkResult> per_executor_, per_phase_;
 };
 
 std::ostream& operator<<(std::ostream& out, const BenchmarkResult& res);
@@ -1,3 +1,6 @@
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "request.h"
@@ -11,6 +14,12 @@ namespace ycsbr {
 // The purpose of this warpper is to help avoid the runtime overhead of
 // generating the workload. The trade-off is that more memory will be used (to
 // store all the requests).
+//
+// To reduce the memory used, the requests are stored in a compact 12 byte
+// encoding (instead of as 32 byte `Request`s). Workloads typically reuse a
+// small set of values, so each request stores an index into a table of the
+// distinct values it has seen instead of a value pointer and size. The
+// requests are decoded in `Next()`.
 template <class Workload>
 class BufferedWorkload {
  public:
@@ -32,13 +41,59 @@ class BufferedWorkload<Workload>::Producer {
   Producer(typename Workload::Producer producer);
   void Prepare();
   bool HasNext() const;
-  const Request& Next();
+  Request Next();
+
+  // Only available if the wrapped workload's producers report their phases
+  // (see `workload_example.h`).
+  template <typename WrappedProducer = typename Workload::Producer>
+  auto CurrentPhase() const -> decltype(static_cast<size_t>(
+      std::declval<const WrappedProducer&>().CurrentPhase())) {
+    return current_phase_;
+  }
 
  private:
+  // A request packed into 12 bytes.
+  struct CompactRequest {
+    Request::Key key;
+    // The upper `32 - kPayloadBits` bits store the request's operation (or
+    // `kEscapedOp`). The lower `kPayloadBits` bits store the scan amount (for
+    // scans), the index of the request's value in `values_` (for other
+    // operations), or the index of the request in `escaped_` (for escaped
+    // requests).
+    uint32_t info;
+  } __attribute__((packed));
+  static_assert(sizeof(CompactRequest) == 12);
+
+  static constexpr uint32_t kPayloadBits = 29;
+  static constexpr uint32_t kPayloadMask = (1U << kPayloadBits) - 1;
+  static constexpr uint32_t kEscapedOp = (1U << (32 - kPayloadBits)) - 1;
+
+  void Append(const Request& request);
+  // Returns `kPayloadMask + 1` if `values_` is full.
+  uint32_t ValueIndex(const char* value, size_t value_size);
+
   typename Workload::Producer producer_;
 
-  std::vector<Request> requests_;
+  std::vector<CompactRequest> requests_;
   size_t next_request_;
+
+  // The distinct values (and their sizes) used by the requests.
+  std::vector<std::pair<const char*, size_t>> values_;
+  // Requests that cannot be packed (e.g., scans that include a value) are
+  // stored as-is. These requests are rare.
+  std::vector<Request> escaped_;
+  // Only used while buffering the requests.
+  std::unordered_map<const char*, uint32_t> value_indices_;
+
+  // Phases usually span many requests, so only the requests where the phase
+  // changes are stored (if the wrapped producer reports phases).
+  struct PhaseChange {
+    size_t first_request;
+    size_t phase;
+  };
+  std::vector<PhaseChange> phase_changes_;
+  size_t next_phase_change_;
+  size_t current_phase_;
 };
 
 }  // namespace ycsbr
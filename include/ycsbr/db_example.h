@@ -5,6 +5,8 @@
 #include <utility>
 #include <vector>
 
+#include "async_callback.h"
+#include "record_buffer.h"
 #include "trace.h"
 
 namespace ycsbr {
@@ -59,6 +61,60 @@ class ExampleDatabaseInterface final {
   virtual bool Scan(
       Request::Key key, size_t amount,
       std::vector<std::pair<Request::Key, std::string>>* scan_out) = 0;
+
+  // The methods below are optional. If they are implemented, workers will
+  // dispatch batches of consecutive requests of the same type to them when
+  // `RunOptions::batch_size` is greater than 1.
+
+  // Read the values at `keys`. `values_out` will have the same size as `keys`
+  // and will contain empty strings; store the value for `keys[i]` in
+  // `(*values_out)[i]`. Return the number of keys that were found.
+  virtual size_t ReadBatch(const std::vector<Request::Key>& keys,
+                           std::vector<std::string>* values_out) = 0;
+
+  // Apply the writes in `requests`. The requests are either all inserts
+  // (`Request::Operation::kInsert`) or all updates
+  // (`Request::Operation::kUpdate`). Return the number of writes that
+  // succeeded.
+  virtual size_t WriteBatch(const std::vector<Request>& requests) = 0;
+
+  // The methods below are also optional. If they are implemented, workers use
+  // them instead of `Read()` and `Scan()` (except when batching or when using
+  // the asynchronous interface). Each worker reuses one `RecordBuffer`, so
+  // reading records does not require any allocations once the buffer has grown
+  // large enough. The buffer is empty when these methods are called.
+
+  // Read the value at the specified key and append it to `value_out` (e.g.,
+  // using `RecordBuffer::Append()`). Return true if the read succeeded.
+  virtual bool ReadInto(Request::Key key, RecordBuffer* value_out) = 0;
+
+  // Scan the key range starting from `key` for `amount` records and append
+  // them to `scan_out`. Return true if the scan succeeded.
+  virtual bool ScanInto(Request::Key key, size_t amount,
+                        RecordBuffer* scan_out) = 0;
+
+  // The asynchronous interface is also optional. If a database implements all
+  // of the methods below, each worker will keep up to
+  // `RunOptions::async_queue_depth` requests in flight. Each method starts a
+  // request and returns; when the request completes, the database must invoke
+  // `callback(succeeded)` on the same worker thread, either inside the method
+  // itself or inside `PollAsync()`. Any output buffers remain valid until the
+  // callback is invoked.
+
+  virtual void ReadAsync(Request::Key key, std::string* value_out,
+                         AsyncCallback callback) = 0;
+  virtual void InsertAsync(Request::Key key, const char* value,
+                           size_t value_size, AsyncCallback callback) = 0;
+  virtual void UpdateAsync(Request::Key key, const char* value,
+                           size_t value_size, AsyncCallback callback) = 0;
+  virtual void ScanAsync(
+      Request::Key key, size_t amount,
+      std::vector<std::pair<Request::Key, std::string>>* scan_out,
+      AsyncCallback callback) = 0;
+
+  // Called repeatedly by a worker while it has requests in flight. Run the
+  // callbacks of any of this worker's requests that have completed.
+  virtual void PollAsync() = 0;
 };
 
 }  // namespace ycsbr
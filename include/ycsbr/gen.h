@@ -14,6 +14,7 @@
 #include "gen/chooser.h"
 #include "gen/config.h"
 #include "gen/keygen.h"
+#include "gen/keyspace.h"
 #include "gen/keyrange.h"
 #include "gen/phase.h"
 #include "gen/types.h"
@@ -15,6 +15,16 @@ class Chooser {
  public:
   virtual ~Chooser() = default;
   virtual size_t Next(PRNG& prng) = 0;
+
+  // Writes `n` values to `out`. The values are the same as the ones returned by
+  // calling `Next()` `n` times, but implementations avoid the per-value virtual
+  // call (and may vectorize their computations).
+  virtual void NextBatch(PRNG& prng, size_t* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = Next(prng);
+    }
+  }
+
   virtual void SetItemCount(size_t item_count) = 0;
   virtual void IncreaseItemCountBy(size_t delta) = 0;
 };
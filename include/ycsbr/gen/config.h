@@ -25,6 +25,8 @@ class WorkloadConfig {
   virtual bool UsingCustomDataset() const = 0;
   virtual size_t GetNumLoadRecords() const = 0;
   virtual size_t GetRecordSizeBytes() const = 0;
+  // The pseudorandom number generator the workload should use.
+  virtual PRNG::Type GetPRNGType() const = 0;
   virtual std::unique_ptr<Generator> GetLoadGenerator() const = 0;
 
   virtual size_t GetNumPhases() const = 0;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "ycsbr/gen/types.h"
@@ -19,6 +21,38 @@ class Generator {
   // generated keys is stored by the `Generator` instance.
   virtual void Generate(PRNG& prng, std::vector<Request::Key>* dest,
                         size_t start_index) const = 0;
+
+  // Generates the same kind of keys as `Generate()`, but writes them in
+  // ascending order (generators can often avoid sorting their keys).
+  virtual void GenerateSorted(PRNG& prng, std::vector<Request::Key>* dest,
+                              size_t start_index) const = 0;
+
+  // An independent part of the keys produced by a `Generator`.
+  struct Part {
+    size_t num_keys;
+    std::unique_ptr<Generator> generator;
+  };
+
+  // Splits the keys this generator produces into about `num_parts` parts that
+  // can be generated independently (e.g., in parallel). Every key in part `i`
+  // must be smaller than every key in part `i + 1`, so the parts' sorted keys
+  // can be concatenated without merging. Returns an empty vector if this
+  // generator cannot be split.
+  virtual std::vector<Part> Split(size_t /*num_parts*/) const { return {}; }
+
+  // An arithmetic progression: `start`, `start + step`, `start + 2 * step`,
+  // and so on.
+  struct Progression {
+    Request::Key start;
+    Request::Key step;
+  };
+
+  // If this generator's keys, in ascending order, form an arithmetic
+  // progression, returns the progression. The keys can then be computed
+  // instead of stored.
+  virtual std::optional<Progression> SortedProgression() const {
+    return std::nullopt;
+  }
 };
 
 }  // namespace gen
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ycsbr/request.h"
+
+namespace ycsbr {
+namespace gen {
+
+// The keys in a workload's initial load, in ascending order. The keys are
+// either stored in a (shared) vector or, for datasets whose keys form an
+// arithmetic progression (e.g., the "linspace" distribution), computed from
+// their index. Computed keys use no memory and looking them up does not touch
+// memory, which keeps cache misses out of the request generation path.
+//
+// `KeySpace` instances are cheap to copy; copies share the stored keys.
+class KeySpace {
+ public:
+  // An empty key space.
+  KeySpace() : keys_(nullptr), size_(0), start_(0), step_(0) {}
+
+  // Uses the given keys, which must be sorted.
+  static KeySpace Materialized(
+      std::shared_ptr<const std::vector<Request::Key>> keys) {
+    assert(keys != nullptr);
+    KeySpace space;
+    space.size_ = keys->size();
+    space.keys_ = std::move(keys);
+    return space;
+  }
+
+  // Key `i` is `start + i * step`.
+  static KeySpace Arithmetic(const Request::Key start, const Request::Key step,
+                             const size_t size) {
+    KeySpace space;
+    space.start_ = start;
+    space.step_ = step;
+    space.size_ = size;
+    return space;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the `index`-th smallest key.
+  Request::Key operator[](const size_t index) const {
+    assert(index < size_);
+    if (keys_ != nullptr) {
+      return (*keys_)[index];
+    }
+    return start_ + index * step_;
+  }
+
+  // Returns true iff the keys are stored in memory (see `keys()`).
+  bool IsMaterialized() const { return keys_ != nullptr; }
+  // Only valid if `IsMaterialized()` is true.
+  const std::vector<Request::Key>& keys() const {
+    assert(keys_ != nullptr);
+    return *keys_;
+  }
+
+  // Returns a copy of all the keys.
+  std::vector<Request::Key> ToVector() const {
+    if (keys_ != nullptr) return *keys_;
+    std::vector<Request::Key> keys(size_);
+    for (size_t i = 0; i < size_; ++i) {
+      keys[i] = start_ + i * step_;
+    }
+    return keys;
+  }
+
+ private:
+  std::shared_ptr<const std::vector<Request::Key>> keys_;
+  size_t size_;
+  Request::Key start_, step_;
+};
+
+}  // namespace gen
+}  // namespace ycsbr
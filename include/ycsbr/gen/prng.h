@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace ycsbr {
+namespace gen {
+
+// The pseudorandom number generator used by the workload generator. It
+// satisfies the C++ `UniformRandomBitGenerator` requirements, so it can be used
+// with the standard library's distributions.
+//
+// The generator algorithm is selected at runtime (e.g., using the `prng` key in
+// a workload configuration file). Apart from `kMT19937`, all the algorithms use
+// at most 32 bytes of state and are much faster than `std::mt19937`. Two
+// `PRNG`s of the same type created with the same seed produce the same
+// sequence of numbers.
+//
+// As a `UniformRandomBitGenerator`, the generator produces 32-bit numbers so
+// that `kMT19937` (the default) produces exactly the same sequences as
+// `std::mt19937` did when it was the only option. The other algorithms return
+// the upper 32 bits of their 64-bit outputs. `NextUint64()` and `NextDouble()`
+// use all 64 bits of those outputs instead (one generator step per call), so
+// the workload generator uses them where it can.
+class PRNG {
+ public:
+  enum class Type {
+    // std::mt19937
+    kMT19937,
+    // xoshiro256** (Blackman and Vigna)
+    kXoshiro256StarStar,
+    // PCG64 (XSL RR 128/64) (O'Neill)
+    kPCG64,
+    // wyrand (Wang Yi)
+    kWyRand,
+  };
+  static constexpr Type kDefaultType = Type::kMT19937;
+
+  // Returns the type with the given name ("mt19937", "xoshiro256**", "pcg64",
+  // or "wyrand"). Throws `std::invalid_argument` if the name is unknown.
+  static Type TypeFromString(const std::string& name);
+  static const char* TypeName(Type type);
+
+  using result_type = uint32_t;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  explicit PRNG(uint64_t seed = 42, Type type = kDefaultType);
+  PRNG(const PRNG& other);
+  PRNG& operator=(const PRNG& other);
+  PRNG(PRNG&&) noexcept = default;
+  PRNG& operator=(PRNG&&) noexcept = default;
+
+  result_type operator()();
+
+  // Returns a uniformly distributed 64-bit number.
+  uint64_t NextUint64();
+  // Returns a uniformly distributed number in [0, 1). For `kMT19937`, this
+  // returns the same value as `std::uniform_real_distribution<double>(0, 1)`.
+  double NextDouble();
+
+  Type type() const { return type_; }
+
+ private:
+  using uint128_t = unsigned __int128;
+
+  static uint64_t SplitMix64(uint64_t* state);
+  static uint64_t RotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  uint64_t NextXoshiro256StarStar();
+  uint64_t NextPCG64();
+  uint64_t NextWyRand();
+
+  Type type_;
+  union {
+    uint64_t xoshiro[4];
+    struct {
+      uint128_t state;
+      uint128_t increment;
+    } pcg;
+    uint64_t wyrand;
+  } state_;
+  // Only used by `Type::kMT19937` (its state is large).
+  std::unique_ptr<std::mt19937> mt_;
+};
+
+// Implementation details follow.
+
+inline PRNG::Type PRNG::TypeFromString(const std::string& name) {
+  if (name == "mt19937") return Type::kMT19937;
+  if (name == "xoshiro256**") return Type::kXoshiro256StarStar;
+  if (name == "pcg64") return Type::kPCG64;
+  if (name == "wyrand") return Type::kWyRand;
+  throw std::invalid_argument("Unknown PRNG type: " + name);
+}
+
+inline const char* PRNG::TypeName(const Type type) {
+  switch (type) {
+    case Type::kMT19937:
+      return "mt19937";
+    case Type::kXoshiro256StarStar:
+      return "xoshiro256**";
+    case Type::kPCG64:
+      return "pcg64";
+    case Type::kWyRand:
+      return "wyrand";
+  }
+  return "unknown";
+}
+
+inline PRNG::PRNG(uint64_t seed, const Type type) : type_(type), state_() {
+  switch (type_) {
+    case Type::kMT19937:
+      mt_ = std::make_unique<std::mt19937>(static_cast<uint32_t>(seed));
+      break;
+    case Type::kXoshiro256StarStar:
+      // The state is seeded using SplitMix64, as recommended by the authors.
+      for (auto& word : state_.xoshiro) {
+        word = SplitMix64(&seed);
+      }
+      break;
+    case Type::kPCG64: {
+      const uint64_t s0 = SplitMix64(&seed);
+      const uint64_t s1 = SplitMix64(&seed);
+      const uint64_t i0 = SplitMix64(&seed);
+      const uint64_t i1 = SplitMix64(&seed);
+      // The increment must be odd.
+      state_.pcg.increment = ((static_cast<uint128_t>(i0) << 64) | i1) | 1;
+      state_.pcg.state = (static_cast<uint128_t>(s0) << 64) | s1;
+      break;
+    }
+    case Type::kWyRand:
+      state_.wyrand = SplitMix64(&seed);
+      break;
+  }
+}
+
+inline PRNG::PRNG(const PRNG& other)
+    : type_(other.type_),
+      state_(other.state_),
+      mt_(other.mt_ != nullptr ? std::make_unique<std::mt19937>(*other.mt_)
+                               : nullptr) {}
+
+inline PRNG& PRNG::operator=(const PRNG& other) {
+  if (this == &other) return *this;
+  type_ = other.type_;
+  state_ = other.state_;
+  mt_ = other.mt_ != nullptr ? std::make_unique<std::mt19937>(*other.mt_)
+                             : nullptr;
+  return *this;
+}
+
+inline PRNG::result_type PRNG::operator()() {
+  switch (type_) {
+    case Type::kXoshiro256StarStar:
+      return static_cast<result_type>(NextXoshiro256StarStar() >> 32);
+    case Type::kPCG64:
+      return static_cast<result_type>(NextPCG64() >> 32);
+    case Type::kWyRand:
+      return static_cast<result_type>(NextWyRand() >> 32);
+    case Type::kMT19937:
+    default:
+      return (*mt_)();
+  }
+}
+
+inline uint64_t PRNG::NextUint64() {
+  switch (type_) {
+    case Type::kXoshiro256StarStar:
+      return NextXoshiro256StarStar();
+    case Type::kPCG64:
+      return NextPCG64();
+    case Type::kWyRand:
+      return NextWyRand();
+    case Type::kMT19937:
+    default: {
+      const uint64_t high = (*mt_)();
+      return (high << 32) | (*mt_)();
+    }
+  }
+}
+
+inline double PRNG::NextDouble() {
+  if (type_ == Type::kMT19937) {
+    return std::generate_canonical<double, std::numeric_limits<double>::digits>(
+        *mt_);
+  }
+  // Uses the upper 53 bits (the precision of a double).
+  return (NextUint64() >> 11) * 0x1.0p-53;
+}
+
+inline uint64_t PRNG::SplitMix64(uint64_t* state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t PRNG::NextXoshiro256StarStar() {
+  uint64_t* s = state_.xoshiro;
+  const uint64_t result = RotateLeft(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = RotateLeft(s[3], 45);
+  return result;
+}
+
+inline uint64_t PRNG::NextPCG64() {
+  constexpr uint128_t kMultiplier =
+      (static_cast<uint128_t>(2549297995355413924ULL) << 64) |
+      4865540595714422341ULL;
+  const uint128_t old_state = state_.pcg.state;
+  state_.pcg.state = old_state * kMultiplier + state_.pcg.increment;
+  const uint64_t xored = static_cast<uint64_t>(old_state >> 64) ^
+                         static_cast<uint64_t>(old_state);
+  const int rotation = static_cast<int>(old_state >> 122);
+  return (xored >> rotation) | (xored << ((-rotation) & 63));
+}
+
+inline uint64_t PRNG::NextWyRand() {
+  state_.wyrand += 0xa0761d6478bd642fULL;
+  const uint128_t product = static_cast<uint128_t>(state_.wyrand) *
+                            (state_.wyrand ^ 0xe7037ed1a0b428dbULL);
+  return static_cast<uint64_t>(product >> 64) ^
+         static_cast<uint64_t>(product);
+}
+
+}  // namespace gen
+}  // namespace ycsbr
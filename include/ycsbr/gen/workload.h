@@ -1,13 +1,16 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <random>
 #include <unordered_map>
 #include <vector>
 
 #include "ycsbr/gen/config.h"
+#include "ycsbr/gen/keyspace.h"
 #include "ycsbr/gen/phase.h"
 #include "ycsbr/gen/types.h"
 #include "ycsbr/gen/valuegen.h"
@@ -17,6 +20,8 @@
 namespace ycsbr {
 namespace gen {
 
+class KeySpaceReplicas;
+
 // Represents a customizable workload with "phases". The workload configuration
 // must be specified in a YAML file. See `tests/workloads/custom.yml` for an
 // example.
@@ -49,6 +54,16 @@ class PhasedWorkload {
   void AddCustomInsertList(const std::string& name,
                            std::vector<Request::Key> to_insert);
 
+  // If set to true, each NUMA node gets its own copy of the load keys (only if
+  // they are stored in memory; see `KeySpace`). Each producer then reads the
+  // copy on the NUMA node it runs on, which avoids remote memory accesses when
+  // the producers run on several nodes (e.g., in a `Session` that uses
+  // `ThreadPlacement::kNumaAware`). The copies are made when the producers are
+  // prepared and use one load dataset's worth of memory per node.
+  // The copies are shared by all of the producers this workload creates
+  // (e.g., across the runs of a `LoopingWorkload`).
+  void SetReplicateLoadKeysPerNumaNode(bool replicate);
+
   // Retrieve the size of the records in the workload, in bytes.
   size_t GetRecordSizeBytes() const;
 
@@ -75,9 +90,13 @@ class PhasedWorkload {
   PRNG prng_;
   uint32_t prng_seed_;
   std::shared_ptr<WorkloadConfig> config_;
-  std::shared_ptr<std::vector<Request::Key>> load_keys_;
+  KeySpace load_keys_;
   std::shared_ptr<std::unordered_map<std::string, std::vector<Request::Key>>>
       custom_inserts_;
+  bool replicate_load_keys_;
+  // Set iff `replicate_load_keys_` is true. Recreated when the load keys
+  // change.
+  std::shared_ptr<KeySpaceReplicas> load_key_replicas_;
 };
 
 // Used by the workload runner to actually execute the workload. This class
@@ -87,20 +106,43 @@ class PhasedWorkload::Producer {
   void Prepare();
 
   bool HasNext() const {
-    return current_phase_ < phases_.size() && phases_[current_phase_].HasNext();
+    return next_request_index_ < requests_.size() ||
+           (current_phase_ < phases_.size() &&
+            phases_[current_phase_].HasNext());
   }
-  Request Next();
+  Request Next() {
+    if (next_request_index_ >= requests_.size()) {
+      GenerateRequests();
+    }
+    return requests_[next_request_index_++];
+  }
+
+  // The phase of the request most recently returned by `Next()`.
+  PhaseID CurrentPhase() const { return requests_phase_; }
 
  private:
+  // Requests are generated in batches of (up to) this size. Generating
+  // requests in batches lets the key choosers produce their keys together,
+  // which avoids a virtual call per key.
+  static constexpr size_t kRequestBatchSize = 64;
+
   friend class PhasedWorkload;
-  Producer(std::shared_ptr<const WorkloadConfig> config,
-           std::shared_ptr<const std::vector<Request::Key>> load_keys,
+  Producer(std::shared_ptr<const WorkloadConfig> config, KeySpace load_keys,
            std::shared_ptr<
                const std::unordered_map<std::string, std::vector<Request::Key>>>
                custom_inserts,
-           ProducerID id, size_t num_producers, uint32_t prng_seed);
-
-  Request::Key ChooseKey(const std::unique_ptr<Chooser>& chooser);
+           ProducerID id, size_t num_producers, uint32_t prng_seed,
+           std::shared_ptr<KeySpaceReplicas> load_key_replicas);
+
+  // Replaces `requests_` with the next batch of requests.
+  void GenerateRequests();
+  // Chooses the operations of the next `num_requests` requests in the current
+  // phase (stored in `ops_`).
+  void ChooseOperations(size_t num_requests);
+  // Fills in the requests in `requests_[begin, end)`. The range must not
+  // contain inserts (they change the choosers' item counts).
+  void ChooseKeys(size_t begin, size_t end);
+  Request::Key ToKey(size_t index) const;
 
   ProducerID id_;
   size_t num_producers_;
@@ -111,8 +153,11 @@ class PhasedWorkload::Producer {
   PhaseID current_phase_;
 
   // The keys that were loaded.
-  std::shared_ptr<const std::vector<Request::Key>> load_keys_;
+  KeySpace load_keys_;
   size_t num_load_keys_;
+  // If not null, `load_keys_` is replaced by the copy on the producer's NUMA
+  // node in `Prepare()`.
+  std::shared_ptr<KeySpaceReplicas> load_key_replicas_;
 
   // Custom keys to insert.
   std::shared_ptr<
@@ -123,9 +168,22 @@ class PhasedWorkload::Producer {
   std::vector<Request::Key> insert_keys_;
   size_t next_insert_key_index_;
 
-  ValueGenerator valuegen_;
+  // Created in `Prepare()`, so that the values are allocated by the thread
+  // that runs the producer.
+  std::optional<ValueGenerator> valuegen_;
 
   std::uniform_int_distribution<uint32_t> op_dist_;
+
+  // The current batch of requests (all in phase `requests_phase_`).
+  std::vector<Request> requests_;
+  size_t next_request_index_;
+  PhaseID requests_phase_;
+
+  // Scratch space used to generate a batch of requests. `choices_` holds the
+  // key choices for each operation type (indexed by `Request::Operation`).
+  std::vector<Request::Operation> ops_;
+  std::array<std::vector<size_t>, Request::kNumOperations> choices_;
+  std::vector<size_t> scan_lengths_;
 };
 
 }  // namespace gen
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "../run_options.h"
+
+namespace ycsbr {
+namespace impl {
+
+// Computes the times at which an open-loop worker should send its requests.
+// The schedule only depends on the configured rate, arrival process, and seed
+// (i.e., it does not depend on when previous requests complete).
+class ArrivalSchedule {
+ public:
+  ArrivalSchedule(double requests_per_second,
+                  RunOptions::ArrivalProcess process, uint32_t seed);
+
+  // Returns the time (relative to the start of the run) at which the next
+  // request is supposed to be sent.
+  std::chrono::nanoseconds NextArrival();
+
+ private:
+  RunOptions::ArrivalProcess process_;
+  double mean_interval_ns_;
+  // Accumulated using a `double` to avoid drift caused by rounding each
+  // individual inter-arrival time.
+  double next_arrival_ns_;
+  std::mt19937_64 prng_;
+  std::exponential_distribution<double> dist_;
+};
+
+// Blocks the calling thread until `deadline` has passed.
+inline void WaitUntil(const std::chrono::steady_clock::time_point deadline) {
+  // Sleeping is too coarse grained for short waits, so we only sleep if the
+  // deadline is far away. Otherwise we spin.
+  constexpr auto kSpinThreshold = std::chrono::microseconds(100);
+  auto now = std::chrono::steady_clock::now();
+  while (now < deadline) {
+    if (deadline - now > kSpinThreshold) {
+      std::this_thread::sleep_for(deadline - now - kSpinThreshold);
+    }
+    now = std::chrono::steady_clock::now();
+  }
+}
+
+// Implementation details follow.
+
+inline ArrivalSchedule::ArrivalSchedule(
+    const double requests_per_second,
+    const RunOptions::ArrivalProcess process, const uint32_t seed)
+    : process_(process),
+      mean_interval_ns_(0.0),
+      next_arrival_ns_(0.0),
+      prng_(seed),
+      dist_(1.0) {
+  if (requests_per_second <= 0.0) {
+    throw std::invalid_argument("The target request rate must be positive.");
+  }
+  mean_interval_ns_ = 1e9 / requests_per_second;
+}
+
+inline std::chrono::nanoseconds ArrivalSchedule::NextArrival() {
+  const auto arrival = std::chrono::nanoseconds(
+      static_cast<std::chrono::nanoseconds::rep>(next_arrival_ns_));
+  if (process_ == RunOptions::ArrivalProcess::kPoisson) {
+    // Exponentially distributed inter-arrival times with the requested mean.
+    next_arrival_ns_ += dist_(prng_) * mean_interval_ns_;
+  } else {
+    next_arrival_ns_ += mean_interval_ns_;
+  }
+  return arrival;
+}
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../async_callback.h"
+#include "../request.h"
+#include "../run_options.h"
+#include "clock.h"
+#include "executor.h"
+#include "flag.h"
+#include "run_stage.h"
+#include "tracking.h"
+
+namespace ycsbr {
+namespace impl {
+
+// Runs a workload against a database that implements the asynchronous
+// interface (see `db_example.h`). Each worker keeps up to
+// `RunOptions::async_queue_depth` requests in flight. Latencies are measured
+// from when a request is started until its completion callback runs.
+//
+// This executor exposes the same interface as `Executor`.
+template <class DatabaseInterface, typename WorkloadProducer,
+          typename Clock = SteadyClock>
+class AsyncExecutor {
+ public:
+  AsyncExecutor(DatabaseInterface* db, WorkloadProducer producer, size_t id,
+                const Flag* can_start, const RunOptions& options);
+
+  AsyncExecutor(const AsyncExecutor&) = delete;
+  AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+  // Runs the workload produced by the producer.
+  void operator()();
+
+  void WaitForReady() const;
+  void WaitForCompletion() const;
+  MetricsTracker&& GetResults() &&;
+
+  // Also counts the executor's requests in `live` (see `LiveMetricsMonitor`).
+  // Must be called before the executor is allowed to start.
+  void SetLiveCounters(LiveCounters* live) { tracker_.SetLiveCounters(live); }
+
+  // Makes the executor follow the stages set in `control` (see `RunStage`).
+  // Must be called before the executor is allowed to start.
+  void SetRunStage(const RunStageControl* control) { run_stage_ = control; }
+
+  // Returns true iff the executor completed before `deadline`.
+  bool WaitForCompletionUntil(
+      const std::chrono::steady_clock::time_point& deadline) const {
+    return done_.WaitUntil(deadline);
+  }
+
+ private:
+  // Holds the state of an in-flight request.
+  struct Slot {
+    AsyncExecutor* owner;
+    size_t index;
+    Request req;
+    // The phase of `req` (see `ReportsPhase`).
+    size_t phase;
+    bool measure_latency;
+    // True during the write phase of a read-modify-write.
+    bool writing;
+    typename Clock::TimePoint start;
+    // When the write of a read-modify-write was started.
+    typename Clock::TimePoint write_start;
+    std::string value_out;
+    std::vector<std::pair<Request::Key, std::string>> scan_out;
+  };
+
+  static constexpr bool kReportsPhase = ReportsPhase<WorkloadProducer>::value;
+
+  void WorkloadLoop();
+  void Start(Slot* slot);
+  void StartReadModifyWriteUpdate(Slot* slot);
+  static void OnComplete(void* context, bool succeeded);
+  void Complete(Slot* slot, bool succeeded);
+  void Release(Slot* slot);
+
+  // Errors cannot be thrown from inside completion callbacks (they run inside
+  // the database's code). They are recorded and thrown by the workload loop.
+  void SetError(const char* message);
+
+  Flag ready_;
+  const Flag* can_start_;
+  Flag done_;
+
+  DatabaseInterface* db_;
+  WorkloadProducer producer_;
+  MetricsTracker tracker_;
+  size_t id_;
+
+  // Not owned. Null if the run does not have stages.
+  const RunStageControl* run_stage_;
+  RunStage last_stage_;
+
+  const RunOptions options_;
+  size_t latency_sampling_counter_;
+  size_t throughput_sampling_counter_;
+  uint32_t read_xor_;
+
+  // The slots are allocated once; their addresses must not change while the
+  // workload runs.
+  std::vector<Slot> slots_;
+  std::vector<size_t> free_slots_;
+  // Read-modify-writes whose read completed and whose update needs to start.
+  std::vector<size_t> pending_updates_;
+  size_t in_flight_;
+  const char* error_;
+
+  // Used to print out throughput samples, if requested.
+  std::ofstream throughput_output_file_;
+};
+
+// Implementation details follow.
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::AsyncExecutor(
+    DatabaseInterface* db, WorkloadProducer producer, const size_t id,
+    const Flag* can_start, const RunOptions& options)
+    : ready_(),
+      can_start_(can_start),
+      done_(),
+      db_(db),
+      producer_(std::move(producer)),
+      tracker_(options, Clock::NanosPerTick()),
+      id_(id),
+      run_stage_(nullptr),
+      last_stage_(RunStage::kMeasure),
+      options_(options),
+      latency_sampling_counter_(0),
+      throughput_sampling_counter_(0),
+      read_xor_(0),
+      slots_(options.async_queue_depth),
+      in_flight_(0),
+      error_(nullptr),
+      throughput_output_file_() {
+  if (options.async_queue_depth == 0) {
+    throw std::invalid_argument("The async queue depth must be at least 1.");
+  }
+  free_slots_.reserve(slots_.size());
+  pending_updates_.reserve(slots_.size());
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    slots_[i].owner = this;
+    slots_[i].index = i;
+    // Slots are handed out in increasing index order.
+    free_slots_.push_back(slots_.size() - i - 1);
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::WaitForReady()
+    const {
+  return ready_.Wait();
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::WaitForCompletion()
+    const {
+  done_.Wait();
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline MetricsTracker&&
+AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::GetResults() && {
+  WaitForCompletion();
+  return std::move(tracker_);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::operator()() {
+  // Run any needed preparation code.
+  producer_.Prepare();
+
+  // Sets up the throughput sample output file, if needed.
+  if (options_.throughput_sample_period > 0) {
+    throughput_output_file_ = CreateThroughputOutputFile(options_, id_);
+  }
+
+  // Now ready to proceed; wait until we're told to start.
+  ready_.Raise();
+  can_start_->Wait();
+
+  // Run the job.
+  WorkloadLoop();
+
+  // Notify others that we are done.
+  done_.Raise();
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::WorkloadLoop() {
+  tracker_.ResetSample();
+  tracker_.MarkStart();
+
+  while (true) {
+    // When the run stops (or a request fails), the in-flight requests are
+    // completed but no new requests are started.
+    const bool stopping =
+        error_ != nullptr ||
+        !ObserveRunStage(run_stage_, &last_stage_, &tracker_);
+
+    // Read-modify-writes take priority, since their slots are still in use.
+    while (!pending_updates_.empty()) {
+      const size_t index = pending_updates_.back();
+      pending_updates_.pop_back();
+      if (error_ != nullptr) {
+        // Skip the write; its slot is no longer in use.
+        Release(&slots_[index]);
+        continue;
+      }
+      StartReadModifyWriteUpdate(&slots_[index]);
+    }
+
+    // Fill the queue. Note that the database may run completion callbacks
+    // inside `Start()`, which releases slots.
+    while (!stopping && !free_slots_.empty() && producer_.HasNext()) {
+      Slot* slot = &slots_[free_slots_.back()];
+      free_slots_.pop_back();
+      slot->req = producer_.Next();
+      if constexpr (kReportsPhase) {
+        slot->phase = producer_.CurrentPhase();
+      }
+      slot->writing = false;
+      if (++latency_sampling_counter_ >= options_.latency_sample_period) {
+        slot->measure_latency = true;
+        latency_sampling_counter_ = 0;
+      } else {
+        slot->measure_latency = false;
+      }
+      Start(slot);
+    }
+
+    if (in_flight_ == 0 && pending_updates_.empty() &&
+        (stopping || !producer_.HasNext())) {
+      // Errors are only reported once there are no in-flight requests, since
+      // the database may still complete them into this executor's slots.
+      if (error_ != nullptr) {
+        throw std::runtime_error(error_);
+      }
+      break;
+    }
+    db_->PollAsync();
+  }
+  tracker_.MarkEnd();
+
+  // Used to prevent optimizing away reads.
+  tracker_.SetReadXOR(read_xor_);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::Start(
+    Slot* slot) {
+  const Request& req = slot->req;
+  const AsyncCallback callback(&AsyncExecutor::OnComplete, slot);
+  ++in_flight_;
+  if (slot->measure_latency) {
+    slot->start = Clock::Now();
+  }
+
+  switch (req.op) {
+    case Request::Operation::kRead:
+    case Request::Operation::kNegativeRead:
+    case Request::Operation::kReadModifyWrite:
+      slot->value_out.clear();
+      db_->ReadAsync(req.key, &slot->value_out, callback);
+      break;
+
+    case Request::Operation::kInsert:
+      db_->InsertAsync(req.key, req.value, req.value_size, callback);
+      break;
+
+    case Request::Operation::kUpdate:
+      db_->UpdateAsync(req.key, req.value, req.value_size, callback);
+      break;
+
+    case Request::Operation::kScan:
+      slot->scan_out.clear();
+      slot->scan_out.reserve(req.scan_amount);
+      db_->ScanAsync(req.key, req.scan_amount, &slot->scan_out, callback);
+      break;
+
+    default:
+      throw std::runtime_error("Unrecognized request operation!");
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer,
+                          Clock>::StartReadModifyWriteUpdate(Slot* slot) {
+  // The update's latency is measured from when it is started.
+  slot->writing = true;
+  if (slot->measure_latency) {
+    slot->write_start = Clock::Now();
+  }
+  db_->UpdateAsync(slot->req.key, slot->req.value, slot->req.value_size,
+                   AsyncCallback(&AsyncExecutor::OnComplete, slot));
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer,
+                          Clock>::OnComplete(void* context,
+                                             const bool succeeded) {
+  Slot* slot = static_cast<Slot*>(context);
+  slot->owner->Complete(slot, succeeded);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::Complete(
+    Slot* slot, const bool succeeded) {
+  // `request_run_time` spans the whole request (i.e., both the read and the
+  // write of a read-modify-write).
+  std::optional<std::chrono::nanoseconds> run_time, request_run_time;
+  if (slot->measure_latency) {
+    const auto now = Clock::Now();
+    run_time =
+        Clock::Ticks(slot->writing ? slot->write_start : slot->start, now);
+    request_run_time = Clock::Ticks(slot->start, now);
+  }
+  const Request& req = slot->req;
+  if constexpr (kReportsPhase) {
+    // Requests from different phases can be in flight at the same time, so
+    // the phases' run times overlap slightly.
+    tracker_.EnterPhase(slot->phase);
+  }
+
+  switch (req.op) {
+    case Request::Operation::kRead:
+    case Request::Operation::kNegativeRead: {
+      if (succeeded) {
+        read_xor_ ^=
+            *reinterpret_cast<const uint32_t*>(slot->value_out.c_str());
+      }
+      tracker_.RecordRead(req.op, run_time, slot->value_out.size(),
+                          succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        SetError("Failed to read a key that was expected to be found.");
+      }
+      break;
+    }
+
+    case Request::Operation::kInsert: {
+      tracker_.RecordWrite(req.op, run_time, req.value_size + sizeof(req.key),
+                           succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        SetError("Failed to insert a record (expected to succeed).");
+      }
+      break;
+    }
+
+    case Request::Operation::kUpdate: {
+      tracker_.RecordWrite(req.op, run_time, req.value_size, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        SetError("Failed to update a record (expected to succeed).");
+      }
+      break;
+    }
+
+    case Request::Operation::kScan: {
+      if (succeeded && slot->scan_out.size() > 0) {
+        read_xor_ ^= *reinterpret_cast<const uint32_t*>(
+            slot->scan_out.front().second.c_str());
+      }
+      size_t scanned_bytes = 0;
+      for (const auto& entry : slot->scan_out) {
+        scanned_bytes += sizeof(entry.first) + entry.second.size();
+      }
+      tracker_.RecordScan(run_time, scanned_bytes, slot->scan_out.size(),
+                          succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        SetError("Failed to run a range scan (expected to succeed).");
+      }
+      if (options_.expect_scan_amount_found &&
+          slot->scan_out.size() < req.scan_amount) {
+        SetError("A range scan returned too few (or too many) records.");
+      }
+      break;
+    }
+
+    case Request::Operation::kReadModifyWrite: {
+      if (slot->writing) {
+        tracker_.RecordReadModifyWriteWrite(run_time, request_run_time,
+                                            req.value_size, succeeded);
+        if (!succeeded && options_.expect_request_success) {
+          SetError(
+              "Failed to update a record during a read-modify-write "
+              "(expected to succeed).");
+        }
+        break;
+      }
+      if (succeeded) {
+        read_xor_ ^=
+            *reinterpret_cast<const uint32_t*>(slot->value_out.c_str());
+      }
+      tracker_.RecordReadModifyWriteRead(run_time, slot->value_out.size(),
+                                         succeeded);
+      if (!succeeded) {
+        if (options_.expect_request_success) {
+          SetError(
+              "Failed to read a record during a read-modify-write (expected "
+              "to succeed).");
+        }
+        // Skip the write if the read failed.
+        break;
+      }
+      // The update is started by the workload loop (the slot stays in use).
+      pending_updates_.push_back(slot->index);
+      return;
+    }
+
+    default:
+      break;
+  }
+
+  Release(slot);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::Release(
+    Slot* slot) {
+  --in_flight_;
+  free_slots_.push_back(slot->index);
+
+  if (options_.throughput_sample_period > 0 &&
+      ++throughput_sampling_counter_ >= options_.throughput_sample_period) {
+    auto sample = tracker_.GetSample();
+    // Not flushed, to keep I/O off of the worker's request path.
+    throughput_output_file_ << sample.MRecordsPerSecond() << ","
+                            << sample.ElapsedTimeNanos().count() << '\n';
+    throughput_sampling_counter_ = 0;
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void AsyncExecutor<DatabaseInterface, WorkloadProducer, Clock>::SetError(
+    const char* message) {
+  if (error_ == nullptr) {
+    error_ = message;
+  }
+}
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -4,20 +4,24 @@ inline BenchmarkResult::BenchmarkResult(std::chrono::nanoseconds total_run_time)
     : BenchmarkResult(total_run_time, 0, FrozenMeter(), FrozenMeter(),
                       FrozenMeter(), 0, 0, 0) {}
 
-inline BenchmarkResult::BenchmarkResult(std::chrono::nanoseconds total_run_time,
-                                        uint32_t read_xor, FrozenMeter reads,
-                                        FrozenMeter writes, FrozenMeter scans,
-                                        size_t failed_reads,
-                                        size_t failed_writes,
-                                        size_t failed_scans)
+inline BenchmarkResult::BenchmarkResult(
+    std::chrono::nanoseconds total_run_time, uint32_t read_xor,
+    FrozenMeter reads, FrozenMeter writes, FrozenMeter scans,
+    size_t failed_reads, size_t failed_writes, size_t failed_scans,
+    FrozenMeter batches,
+    std::array<FrozenMeter, Request::kNumOperations> operations,
+    std::array<size_t, Request::kNumOperations> failed_operations)
     : run_time_(total_run_time),
       reads_(reads),
       writes_(writes),
       scans_(scans),
+      batches_(batches),
       failed_reads_(failed_reads),
       failed_writes_(failed_writes),
       failed_scans_(failed_scans),
-      read_xor_(read_xor) {}
+      read_xor_(read_xor),
+      operations_(std::move(operations)),
+      failed_operations_(failed_operations) {}
 
 template <typename Units>
 inline Units BenchmarkResult::RunTime() const {
@@ -74,6 +78,21 @@ inline std::ostream& operator<<(std::ostream& out, const BenchmarkResult& res) {
       << std::endl;
   out << "Write Throughput (MiB/s):  " << res.ThroughputWriteMiBPerSecond()
       << std::endl;
+  const FrozenMeter& rmws =
+      res.ForOperation(Request::Operation::kReadModifyWrite);
+  if (rmws.NumRequests() > 0) {
+    out << "Total RMW requests:        " << rmws.NumRequests() << std::endl;
+  }
+  const FrozenMeter& negative_reads =
+      res.ForOperation(Request::Operation::kNegativeRead);
+  if (negative_reads.NumRequests() > 0) {
+    out << "Total negative reads:      " << negative_reads.NumRequests()
+        << std::endl;
+  }
+  if (res.Batches().NumRequests() > 0) {
+    out << "Total batches:             " << res.Batches().NumRequests()
+        << std::endl;
+  }
   out << "Read XOR (ignore):         " << res.read_xor_;
   return out;
 }
@@ -81,16 +100,38 @@ inline std::ostream& operator<<(std::ostream& out, const BenchmarkResult& res) {
 inline void BenchmarkResult::PrintCSVHeader(std::ostream& out) {
   out << "num_reads,num_writes,num_scans,num_scanned_keys,reads_ns_p99,"
          "reads_ns_p50,writes_ns_p99,writes_ns_p50,krequests_per_s,"
-         "krecords_per_s,read_mib_per_s,write_mib_per_s"
+         "krecords_per_s,read_mib_per_s,write_mib_per_s,num_rmws,"
+         "rmws_ns_p99,rmws_ns_p50,num_negative_reads,negative_reads_ns_p99,"
+         "negative_reads_ns_p50"
       << std::endl;
 }
 
 inline void BenchmarkResult::PrintAsCSV(std::ostream& out,
                                         bool print_header) const {
-  using nanoseconds = std::chrono::nanoseconds;
   if (print_header) {
     PrintCSVHeader(out);
   }
+  PrintCSVRow(out);
+}
+
+inline void BenchmarkResult::PrintBreakdownAsCSV(std::ostream& out,
+                                                 bool print_header) const {
+  if (print_header) {
+    out << "scope,id,";
+    PrintCSVHeader(out);
+  }
+  for (size_t id = 0; id < per_executor_.size(); ++id) {
+    out << "executor," << id << ",";
+    per_executor_[id].PrintCSVRow(out);
+  }
+  for (size_t id = 0; id < per_phase_.size(); ++id) {
+    out << "phase," << id << ",";
+    per_phase_[id].PrintCSVRow(out);
+  }
+}
+
+inline void BenchmarkResult::PrintCSVRow(std::ostream& out) const {
+  using nanoseconds = std::chrono::nanoseconds;
   out << Reads().NumRequests() << ",";
   out << Writes().NumRequests() << ",";
   out << Scans().NumRequests() << ",";
@@ -102,7 +143,15 @@ inline void BenchmarkResult::PrintAsCSV(std::ostream& out,
   out << ThroughputThousandRequestsPerSecond() << ",";
   out << ThroughputThousandRecordsPerSecond() << ",";
   out << ThroughputReadMiBPerSecond() << ",";
-  out << ThroughputWriteMiBPerSecond() << std::endl;
+  out << ThroughputWriteMiBPerSecond();
+  for (const auto op : {Request::Operation::kReadModifyWrite,
+                        Request::Operation::kNegativeRead}) {
+    const FrozenMeter& meter = ForOperation(op);
+    out << "," << meter.NumRequests();
+    out << "," << meter.LatencyPercentile<nanoseconds>(0.99).count();
+    out << "," << meter.LatencyPercentile<nanoseconds>(0.5).count();
+  }
+  out << std::endl;
 }
 
 }  // namespace ycsbr
@@ -1,5 +1,8 @@
 // Implementation of declarations in buffered_workload.h. Do not include this
 // header!
+#include <stdexcept>
+
+#include "db_traits.h"
 
 namespace ycsbr {
 
@@ -32,7 +35,10 @@ BufferedWorkload<Workload>::GetProducers(const size_t num_producers) const {
 template <class Workload>
 inline BufferedWorkload<Workload>::Producer::Producer(
     typename Workload::Producer producer)
-    : producer_(std::move(producer)), next_request_(0) {}
+    : producer_(std::move(producer)),
+      next_request_(0),
+      next_phase_change_(0),
+      current_phase_(0) {}
 
 template <class Workload>
 inline void BufferedWorkload<Workload>::Producer::Prepare() {
@@ -40,12 +46,23 @@ inline void BufferedWorkload<Workload>::Producer::Prepare() {
 
   // Record all generated requests.
   while (producer_.HasNext()) {
-    requests_.push_back(producer_.Next());
+    Append(producer_.Next());
+    if constexpr (impl::ReportsPhase<typename Workload::Producer>::value) {
+      const size_t phase = producer_.CurrentPhase();
+      if (phase_changes_.empty() || phase_changes_.back().phase != phase) {
+        phase_changes_.push_back(PhaseChange{requests_.size() - 1, phase});
+      }
+    }
   }
+  requests_.shrink_to_fit();
+  value_indices_.clear();
+  value_indices_.rehash(0);
 
   // Always reset the next request counter, even though producers are not
   // supposed to be prepared and used more than once.
   next_request_ = 0;
+  next_phase_change_ = 0;
+  current_phase_ = 0;
 }
 
 template <class Workload>
@@ -54,8 +71,68 @@ inline bool BufferedWorkload<Workload>::Producer::HasNext() const {
 }
 
 template <class Workload>
-inline const Request& BufferedWorkload<Workload>::Producer::Next() {
-  return requests_[next_request_++];
+inline Request BufferedWorkload<Workload>::Producer::Next() {
+  if (next_phase_change_ < phase_changes_.size() &&
+      phase_changes_[next_phase_change_].first_request == next_request_) {
+    current_phase_ = phase_changes_[next_phase_change_++].phase;
+  }
+  const CompactRequest& compact = requests_[next_request_++];
+  const uint32_t op = compact.info >> kPayloadBits;
+  const uint32_t payload = compact.info & kPayloadMask;
+  if (op == static_cast<uint32_t>(Request::Operation::kScan)) {
+    return Request(Request::Operation::kScan, compact.key, payload, nullptr, 0);
+  }
+  if (op == kEscapedOp) {
+    return escaped_[payload];
+  }
+  const auto& value = values_[payload];
+  return Request(static_cast<Request::Operation>(op), compact.key, 0,
+                 value.first, value.second);
+}
+
+template <class Workload>
+inline void BufferedWorkload<Workload>::Producer::Append(
+    const Request& request) {
+  const uint32_t op = static_cast<uint32_t>(request.op);
+  uint32_t payload = kPayloadMask + 1;
+  if (request.op == Request::Operation::kScan) {
+    if (request.value == nullptr && request.value_size == 0) {
+      payload = request.scan_amount;
+    }
+  } else if (request.scan_amount == 0 && op < kEscapedOp) {
+    payload = ValueIndex(request.value, request.value_size);
+  }
+
+  if (payload <= kPayloadMask) {
+    requests_.push_back(
+        CompactRequest{request.key, (op << kPayloadBits) | payload});
+    return;
+  }
+  if (escaped_.size() > kPayloadMask) {
+    throw std::length_error("BufferedWorkload: Too many unpackable requests.");
+  }
+  requests_.push_back(CompactRequest{
+      request.key, (kEscapedOp << kPayloadBits) |
+                       static_cast<uint32_t>(escaped_.size())});
+  escaped_.push_back(request);
+}
+
+template <class Workload>
+inline uint32_t BufferedWorkload<Workload>::Producer::ValueIndex(
+    const char* const value, const size_t value_size) {
+  const auto it = value_indices_.find(value);
+  if (it != value_indices_.end() && values_[it->second].second == value_size) {
+    return it->second;
+  }
+  if (values_.size() > kPayloadMask) {
+    return kPayloadMask + 1;
+  }
+  // If the same value is used with a different size, the most recent size is
+  // indexed (the older entry remains valid).
+  const uint32_t index = static_cast<uint32_t>(values_.size());
+  values_.emplace_back(value, value_size);
+  value_indices_[value] = index;
+  return index;
 }
 
 }  // namespace ycsbr
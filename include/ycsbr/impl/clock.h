@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define YCSBR_HAS_TSC_CLOCK 1
+#endif
+
+namespace ycsbr {
+namespace impl {
+
+// Clocks used by the executor to measure request latencies. A clock provides
+// the following:
+//
+//   using TimePoint = ...;
+//   static TimePoint Now();
+//   // The number of clock ticks between `start` and `end`.
+//   static std::chrono::nanoseconds Ticks(TimePoint start, TimePoint end);
+//   // The time point corresponding to a `std::chrono::steady_clock` time point.
+//   static TimePoint FromSteadyClock(std::chrono::steady_clock::time_point tp);
+//   // Used to convert ticks into nanoseconds.
+//   static double NanosPerTick();
+//
+// Latencies are recorded in ticks (stored in a `std::chrono::nanoseconds`) and
+// are only converted into nanoseconds when the meters are frozen.
+
+class SteadyClock {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+  static TimePoint Now() { return std::chrono::steady_clock::now(); }
+  static std::chrono::nanoseconds Ticks(TimePoint start, TimePoint end) {
+    return end - start;
+  }
+  static TimePoint FromSteadyClock(std::chrono::steady_clock::time_point tp) {
+    return tp;
+  }
+  static double NanosPerTick() { return 1.0; }
+};
+
+#ifdef YCSBR_HAS_TSC_CLOCK
+
+// Uses the processor's time stamp counter. Reading the counter is much cheaper
+// than `std::chrono::steady_clock::now()`, but it is only a reliable clock if
+// the processor has an invariant TSC (check using `IsSupported()`).
+class TscClock {
+ public:
+  using TimePoint = uint64_t;
+
+  // Returns true iff the processor reports an invariant TSC (i.e., the counter
+  // ticks at a constant rate regardless of frequency scaling and power states).
+  static bool IsSupported() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+        eax < 0x80000007) {
+      return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1U << 8)) != 0;
+  }
+
+  static TimePoint Now() {
+    // `rdtscp` waits for prior instructions to complete before reading the
+    // counter.
+    unsigned int aux;
+    return __rdtscp(&aux);
+  }
+
+  static std::chrono::nanoseconds Ticks(TimePoint start, TimePoint end) {
+    return std::chrono::nanoseconds(end - start);
+  }
+
+  static TimePoint FromSteadyClock(std::chrono::steady_clock::time_point tp) {
+    const auto now = Now();
+    const auto steady_now = std::chrono::steady_clock::now();
+    const double ticks_ago = (steady_now - tp).count() / NanosPerTick();
+    return now - static_cast<TimePoint>(ticks_ago);
+  }
+
+  // The counter's period is calibrated against `std::chrono::steady_clock` the
+  // first time this method is called.
+  static double NanosPerTick() {
+    static const double nanos_per_tick = Calibrate();
+    return nanos_per_tick;
+  }
+
+ private:
+  static double Calibrate() {
+    constexpr auto kCalibrationTime = std::chrono::milliseconds(10);
+    const auto steady_start = std::chrono::steady_clock::now();
+    const TimePoint tsc_start = Now();
+    std::this_thread::sleep_for(kCalibrationTime);
+    const auto steady_end = std::chrono::steady_clock::now();
+    const TimePoint tsc_end = Now();
+    return static_cast<double>((steady_end - steady_start).count()) /
+           (tsc_end - tsc_start);
+  }
+};
+
+#endif  // YCSBR_HAS_TSC_CLOCK
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../async_callback.h"
+#include "../record_buffer.h"
+#include "../request.h"
+
+namespace ycsbr {
+namespace impl {
+
+// Used to detect the optional methods a `DatabaseInterface` can implement (see
+// `db_example.h`).
+
+template <class DatabaseInterface, typename = void>
+struct SupportsReadBatch : std::false_type {};
+
+template <class DatabaseInterface>
+struct SupportsReadBatch<
+    DatabaseInterface,
+    std::void_t<decltype(std::declval<DatabaseInterface&>().ReadBatch(
+        std::declval<const std::vector<Request::Key>&>(),
+        std::declval<std::vector<std::string>*>()))>> : std::true_type {};
+
+template <class DatabaseInterface, typename = void>
+struct SupportsWriteBatch : std::false_type {};
+
+template <class DatabaseInterface>
+struct SupportsWriteBatch<
+    DatabaseInterface,
+    std::void_t<decltype(std::declval<DatabaseInterface&>().WriteBatch(
+        std::declval<const std::vector<Request>&>()))>> : std::true_type {};
+
+template <class DatabaseInterface, typename = void>
+struct SupportsReadInto : std::false_type {};
+
+template <class DatabaseInterface>
+struct SupportsReadInto<
+    DatabaseInterface,
+    std::void_t<decltype(std::declval<DatabaseInterface&>().ReadInto(
+        std::declval<Request::Key>(), std::declval<RecordBuffer*>()))>>
+    : std::true_type {};
+
+template <class DatabaseInterface, typename = void>
+struct SupportsScanInto : std::false_type {};
+
+template <class DatabaseInterface>
+struct SupportsScanInto<
+    DatabaseInterface,
+    std::void_t<decltype(std::declval<DatabaseInterface&>().ScanInto(
+        std::declval<Request::Key>(), std::declval<size_t>(),
+        std::declval<RecordBuffer*>()))>> : std::true_type {};
+
+// True iff the database implements the asynchronous interface (all of
+// `ReadAsync()`, `InsertAsync()`, `UpdateAsync()`, `ScanAsync()`, and
+// `PollAsync()`).
+template <class DatabaseInterface, typename = void>
+struct SupportsAsync : std::false_type {};
+
+template <class DatabaseInterface>
+struct SupportsAsync<
+    DatabaseInterface,
+    std::void_t<
+        decltype(std::declval<DatabaseInterface&>().ReadAsync(
+            std::declval<Request::Key>(), std::declval<std::string*>(),
+            std::declval<AsyncCallback>())),
+        decltype(std::declval<DatabaseInterface&>().InsertAsync(
+            std::declval<Request::Key>(), std::declval<const char*>(),
+            std::declval<size_t>(), std::declval<AsyncCallback>())),
+        decltype(std::declval<DatabaseInterface&>().UpdateAsync(
+            std::declval<Request::Key>(), std::declval<const char*>(),
+            std::declval<size_t>(), std::declval<AsyncCallback>())),
+        decltype(std::declval<DatabaseInterface&>().ScanAsync(
+            std::declval<Request::Key>(), std::declval<size_t>(),
+            std::declval<
+                std::vector<std::pair<Request::Key, std::string>>*>(),
+            std::declval<AsyncCallback>())),
+        decltype(std::declval<DatabaseInterface&>().PollAsync())>>
+    : std::true_type {};
+
+// Used to detect the optional methods a `CustomWorkload::Producer` can
+// implement (see `workload_example.h`).
+
+template <class Producer, typename = void>
+struct ReportsPhase : std::false_type {};
+
+template <class Producer>
+struct ReportsPhase<Producer, std::void_t<decltype(static_cast<size_t>(
+                                  std::declval<const Producer&>()
+                                      .CurrentPhase()))>> : std::true_type {};
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -1,22 +1,32 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "../record_buffer.h"
 #include "../request.h"
 #include "../run_options.h"
+#include "arrival_schedule.h"
+#include "clock.h"
+#include "db_traits.h"
 #include "flag.h"
+#include "run_stage.h"
 #include "tracking.h"
 
 namespace ycsbr {
 namespace impl {
 
-template <class DatabaseInterface, typename WorkloadProducer>
+// Latencies are measured using `Clock` (see `clock.h`).
+template <class DatabaseInterface, typename WorkloadProducer,
+          typename Clock = SteadyClock>
 class Executor {
  public:
   Executor(DatabaseInterface* db, WorkloadProducer producer, size_t id,
@@ -32,13 +42,62 @@ class Executor {
   void WaitForCompletion() const;
   MetricsTracker&& GetResults() &&;
 
+  // Also counts the executor's requests in `live` (see `LiveMetricsMonitor`).
+  // Must be called before the executor is allowed to start.
+  void SetLiveCounters(LiveCounters* live) { tracker_.SetLiveCounters(live); }
+
+  // Makes the executor follow the stages set in `control` (see `RunStage`).
+  // Must be called before the executor is allowed to start.
+  void SetRunStage(const RunStageControl* control) { run_stage_ = control; }
+
+  // Returns true iff the executor completed before `deadline`.
+  bool WaitForCompletionUntil(
+      const std::chrono::steady_clock::time_point& deadline) const {
+    return done_.WaitUntil(deadline);
+  }
+
   // Meant for use by YCSBR's internal microbenchmarks.
   void BM_WorkloadLoop();
 
  private:
+  using TimePoint = typename Clock::TimePoint;
+  static constexpr bool kSupportsReadBatch =
+      SupportsReadBatch<DatabaseInterface>::value;
+  static constexpr bool kSupportsWriteBatch =
+      SupportsWriteBatch<DatabaseInterface>::value;
+  static constexpr bool kSupportsReadInto =
+      SupportsReadInto<DatabaseInterface>::value;
+  static constexpr bool kSupportsScanInto =
+      SupportsScanInto<DatabaseInterface>::value;
+  static constexpr bool kReportsPhase = ReportsPhase<WorkloadProducer>::value;
+
   void WorkloadLoop();
   void SetupOutputFileIfNeeded();
 
+  // Returns the phase of the request most recently returned by the producer
+  // (always 0 if the producer does not report phases).
+  size_t ProducerPhase() const;
+
+  // Runs a single request against the database and records its metrics.
+  void ProcessRequest(const Request& req, bool measure_latency,
+                      const std::optional<TimePoint>& intended_start);
+  // Reads the value at `key` (into `records_out_` if the database supports
+  // `ReadInto()`) and forces a read of the value. Returns true iff the read
+  // succeeded. `*value_size` is set to the size of the value that was read.
+  bool ReadValue(Request::Key key, size_t* value_size);
+
+  // Used when dispatching batches of requests (see `RunOptions::batch_size`).
+  void BatchedWorkloadLoop();
+  static bool CanBatch(Request::Operation op);
+  static bool InSameBatch(Request::Operation first, Request::Operation next);
+  void ProcessReadBatch();
+  void ProcessWriteBatch();
+
+  // Returns true if the latency of the next `num_requests` requests should be
+  // measured.
+  bool ShouldMeasureLatency(size_t num_requests);
+  void SampleThroughputIfNeeded(size_t num_requests);
+
   Flag ready_;
   const Flag* can_start_;
   Flag done_;
@@ -48,18 +107,35 @@ class Executor {
   MetricsTracker tracker_;
   size_t id_;
 
+  // Not owned. Null if the run does not have stages.
+  const RunStageControl* run_stage_;
+  RunStage last_stage_;
+
   const RunOptions options_;
   size_t latency_sampling_counter_;
   size_t throughput_sampling_counter_;
 
+  // Used to prevent optimizing away reads.
+  uint32_t read_xor_;
+  std::string value_out_;
+  std::vector<std::pair<Request::Key, std::string>> scan_out_;
+  // Used instead of `value_out_` and `scan_out_` if the database supports
+  // `ReadInto()` and `ScanInto()` respectively.
+  RecordBuffer records_out_;
+
+  // Buffers used when dispatching batches.
+  std::vector<Request> batch_;
+  std::vector<Request::Key> batch_keys_;
+  std::vector<std::string> batch_values_out_;
+
   // Used to print out throughput samples, if requested.
   std::ofstream throughput_output_file_;
 };
 
 // Implementation details follow.
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline Executor<DatabaseInterface, WorkloadProducer>::Executor(
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline Executor<DatabaseInterface, WorkloadProducer, Clock>::Executor(
     DatabaseInterface* db, WorkloadProducer producer, const size_t id,
     const Flag* can_start, const RunOptions& options)
     : ready_(),
@@ -67,48 +143,66 @@ inline Executor<DatabaseInterface, WorkloadProducer>::Executor(
       done_(),
       db_(db),
       producer_(std::move(producer)),
-      tracker_(),
+      tracker_(options, Clock::NanosPerTick()),
       id_(id),
+      run_stage_(nullptr),
+      last_stage_(RunStage::kMeasure),
       options_(options),
       latency_sampling_counter_(0),
       throughput_sampling_counter_(0),
+      read_xor_(0),
       throughput_output_file_() {}
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void Executor<DatabaseInterface, WorkloadProducer>::WaitForReady()
-    const {
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::WaitForReady() const {
   return ready_.Wait();
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void Executor<DatabaseInterface, WorkloadProducer>::WaitForCompletion()
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::WaitForCompletion()
     const {
   done_.Wait();
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
 inline MetricsTracker&&
-Executor<DatabaseInterface, WorkloadProducer>::GetResults() && {
+Executor<DatabaseInterface, WorkloadProducer, Clock>::GetResults() && {
   WaitForCompletion();
   return std::move(tracker_);
 }
 
-template <typename Callable>
+// Returns the latency in `Clock` ticks. If `intended_start` is provided, the
+// latency is measured from that time instead of from when `callable` is
+// actually invoked (used in open-loop mode).
+template <typename Clock = SteadyClock, typename Callable>
 inline std::optional<std::chrono::nanoseconds> MeasurementHelper(
-    Callable&& callable, bool measure_latency) {
+    Callable&& callable, bool measure_latency,
+    const std::optional<typename Clock::TimePoint>& intended_start =
+        std::nullopt) {
   if (!measure_latency) {
     callable();
     return std::optional<std::chrono::nanoseconds>();
   }
 
-  const auto start = std::chrono::steady_clock::now();
+  const auto start =
+      intended_start.has_value() ? *intended_start : Clock::Now();
   callable();
-  const auto end = std::chrono::steady_clock::now();
-  return end - start;
+  const auto end = Clock::Now();
+  return Clock::Ticks(start, end);
+}
+
+// Returns (up to) the first four bytes of `value`. Used to force a read of
+// values that were extracted from the database.
+inline uint32_t ValuePrefix(const std::string_view value) {
+  uint32_t prefix = 0;
+  std::memcpy(&prefix, value.data(), std::min(value.size(), sizeof(prefix)));
+  return prefix;
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void Executor<DatabaseInterface, WorkloadProducer>::operator()() {
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void Executor<DatabaseInterface, WorkloadProducer, Clock>::operator()() {
   // Run any needed preparation code.
   producer_.Prepare();
 
@@ -126,188 +220,453 @@ inline void Executor<DatabaseInterface, WorkloadProducer>::operator()() {
   done_.Raise();
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void
-Executor<DatabaseInterface, WorkloadProducer>::SetupOutputFileIfNeeded() {
-  if (options_.throughput_sample_period == 0) return;
+// Applies the current stage of the run to `tracker` (if the run has stages,
+// i.e., if `control` is not null). `last_stage` holds the stage that was last
+// applied. Returns false iff the executor should stop issuing requests.
+inline bool ObserveRunStage(const RunStageControl* control,
+                            RunStage* last_stage, MetricsTracker* tracker) {
+  if (control == nullptr) return true;
+  const RunStage stage = control->Get();
+  if (stage != *last_stage) {
+    *last_stage = stage;
+    tracker->SetMeasuring(stage == RunStage::kMeasure);
+  }
+  return stage != RunStage::kStop;
+}
+
+// Creates the throughput sample output file for the worker with ID `id`.
+inline std::ofstream CreateThroughputOutputFile(const RunOptions& options,
+                                                const size_t id) {
   const auto filename =
-      options_.output_dir /
-      (options_.throughput_output_file_prefix + std::to_string(id_) + ".csv");
-  throughput_output_file_ = std::ofstream(filename);
-  if (throughput_output_file_.fail()) {
+      options.output_dir /
+      (options.throughput_output_file_prefix + std::to_string(id) + ".csv");
+  std::ofstream out(filename);
+  if (out.fail()) {
     throw std::invalid_argument("Failed to create output file: " +
                                 filename.string());
   }
-  throughput_output_file_ << "mrecords_per_s,elapsed_ns" << std::endl;
+  out << "mrecords_per_s,elapsed_ns" << std::endl;
+  return out;
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void Executor<DatabaseInterface, WorkloadProducer>::WorkloadLoop() {
-  // Initialize state needed for the replay.
-  uint32_t read_xor = 0;
-  std::string value_out;
-  std::vector<std::pair<Request::Key, std::string>> scan_out;
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void Executor<DatabaseInterface, WorkloadProducer,
+                     Clock>::SetupOutputFileIfNeeded() {
+  if (options_.throughput_sample_period == 0) return;
+  throughput_output_file_ = CreateThroughputOutputFile(options_, id_);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline bool
+Executor<DatabaseInterface, WorkloadProducer, Clock>::ShouldMeasureLatency(
+    const size_t num_requests) {
+  latency_sampling_counter_ += num_requests;
+  if (latency_sampling_counter_ >= options_.latency_sample_period) {
+    latency_sampling_counter_ = 0;
+    return true;
+  }
+  return false;
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::SampleThroughputIfNeeded(
+    const size_t num_requests) {
+  if (options_.throughput_sample_period == 0) return;
+  throughput_sampling_counter_ += num_requests;
+  if (throughput_sampling_counter_ >= options_.throughput_sample_period) {
+    auto sample = tracker_.GetSample();
+    // Not flushed, to keep I/O off of the worker's request path.
+    throughput_output_file_ << sample.MRecordsPerSecond() << ","
+                            << sample.ElapsedTimeNanos().count() << '\n';
+    throughput_sampling_counter_ = 0;
+  }
+}
 
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::WorkloadLoop() {
+  read_xor_ = 0;
   tracker_.ResetSample();
+  tracker_.MarkStart();
+
+  const bool open_loop = options_.target_requests_per_second_per_worker > 0.0;
+  if constexpr (kSupportsReadBatch || kSupportsWriteBatch) {
+    // Batching is not used in open-loop mode, since each request has its own
+    // intended send time.
+    if (options_.batch_size > 1 && !open_loop) {
+      BatchedWorkloadLoop();
+      tracker_.MarkEnd();
+      tracker_.SetReadXOR(read_xor_);
+      return;
+    }
+  }
+
+  // Used when running open-loop.
+  std::optional<ArrivalSchedule> schedule;
+  if (open_loop) {
+    schedule.emplace(options_.target_requests_per_second_per_worker,
+                     options_.arrival_process,
+                     options_.arrival_seed + static_cast<uint32_t>(id_));
+  }
+  std::optional<TimePoint> intended_start;
+  const auto run_start = std::chrono::steady_clock::now();
 
   // Run our trace slice.
   while (producer_.HasNext()) {
+    if (!ObserveRunStage(run_stage_, &last_stage_, &tracker_)) break;
     const auto& req = producer_.Next();
-
-    bool measure_latency = false;
-    if (++latency_sampling_counter_ >= options_.latency_sample_period) {
-      measure_latency = true;
-      latency_sampling_counter_ = 0;
+    if constexpr (kReportsPhase) {
+      tracker_.EnterPhase(producer_.CurrentPhase());
+    }
+    const bool measure_latency = ShouldMeasureLatency(1);
+
+    if (schedule.has_value()) {
+      // Wait until this request is supposed to be sent. If we are behind
+      // schedule, we send it immediately and the delay is included in its
+      // latency.
+      const auto deadline = run_start + schedule->NextArrival();
+      WaitUntil(deadline);
+      intended_start = Clock::FromSteadyClock(deadline);
     }
 
-    switch (req.op) {
-      case Request::Operation::kRead:
-      case Request::Operation::kNegativeRead: {
-        bool succeeded = false;
-        value_out.clear();
-        const auto run_time = MeasurementHelper(
-            [this, &req, &value_out, &read_xor, &succeeded]() {
-              succeeded = db_->Read(req.key, &value_out);
-              if (succeeded) {
-                // Force a read of the extracted value. We want to count this
-                // time against the read latency too.
-                read_xor ^=
-                    *reinterpret_cast<const uint32_t*>(value_out.c_str());
-              }
-            },
-            measure_latency);
-        tracker_.RecordRead(run_time, value_out.size(), succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to read a key that was expected to be found.");
-        }
-        break;
+    ProcessRequest(req, measure_latency, intended_start);
+    SampleThroughputIfNeeded(1);
+  }
+  tracker_.MarkEnd();
+  // Used to prevent optimizing away reads.
+  tracker_.SetReadXOR(read_xor_);
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void Executor<DatabaseInterface, WorkloadProducer, Clock>::ProcessRequest(
+    const Request& req, const bool measure_latency,
+    const std::optional<TimePoint>& intended_start) {
+  switch (req.op) {
+    case Request::Operation::kRead:
+    case Request::Operation::kNegativeRead: {
+      bool succeeded = false;
+      size_t value_size = 0;
+      const auto run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded, &value_size]() {
+            succeeded = ReadValue(req.key, &value_size);
+          },
+          measure_latency, intended_start);
+      tracker_.RecordRead(req.op, run_time, value_size, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to read a key that was expected to be found.");
       }
+      break;
+    }
 
-      case Request::Operation::kInsert: {
-        // Inserts count the whole record size, since this should be the first
-        // time the entire record is written to the DB.
-        bool succeeded = false;
-        const auto run_time = MeasurementHelper(
-            [this, &req, &succeeded]() {
-              succeeded = db_->Insert(req.key, req.value, req.value_size);
-            },
-            measure_latency);
-        tracker_.RecordWrite(run_time, req.value_size + sizeof(req.key),
-                             succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to insert a record (expected to succeed).");
-        }
-        break;
+    case Request::Operation::kInsert: {
+      // Inserts count the whole record size, since this should be the first
+      // time the entire record is written to the DB.
+      bool succeeded = false;
+      const auto run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded]() {
+            succeeded = db_->Insert(req.key, req.value, req.value_size);
+          },
+          measure_latency, intended_start);
+      tracker_.RecordWrite(req.op, run_time, req.value_size + sizeof(req.key),
+                           succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to insert a record (expected to succeed).");
       }
+      break;
+    }
 
-      case Request::Operation::kUpdate: {
-        // Updates only record the value size, since the key should already
-        // exist in the DB.
-        bool succeeded = false;
-        const auto run_time = MeasurementHelper(
-            [this, &req, &succeeded]() {
-              succeeded = db_->Update(req.key, req.value, req.value_size);
-            },
-            measure_latency);
-        tracker_.RecordWrite(run_time, req.value_size, succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to update a record (expected to succeed).");
-        }
-        break;
+    case Request::Operation::kUpdate: {
+      // Updates only record the value size, since the key should already
+      // exist in the DB.
+      bool succeeded = false;
+      const auto run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded]() {
+            succeeded = db_->Update(req.key, req.value, req.value_size);
+          },
+          measure_latency, intended_start);
+      tracker_.RecordWrite(req.op, run_time, req.value_size, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to update a record (expected to succeed).");
       }
+      break;
+    }
 
-      case Request::Operation::kScan: {
-        bool succeeded = false;
-        scan_out.clear();
-        scan_out.reserve(req.scan_amount);
-        const auto run_time = MeasurementHelper(
-            [this, &req, &scan_out, &read_xor, &succeeded]() {
-              succeeded = db_->Scan(req.key, req.scan_amount, &scan_out);
-              if (succeeded && scan_out.size() > 0) {
-                // Force a read of the first extracted value. We want to count
-                // this time against the read latency too.
-                read_xor ^= *reinterpret_cast<const uint32_t*>(
-                    scan_out.front().second.c_str());
+    case Request::Operation::kScan: {
+      bool succeeded = false;
+      if constexpr (kSupportsScanInto) {
+        records_out_.Clear();
+        records_out_.Reserve(req.scan_amount, /*value_bytes=*/0);
+      } else {
+        scan_out_.clear();
+        scan_out_.reserve(req.scan_amount);
+      }
+      const auto run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded]() {
+            // Force a read of the first extracted value. We want to count
+            // this time against the read latency too.
+            if constexpr (kSupportsScanInto) {
+              succeeded =
+                  db_->ScanInto(req.key, req.scan_amount, &records_out_);
+              if (succeeded && !records_out_.empty()) {
+                read_xor_ ^= ValuePrefix(records_out_.value(0));
+              }
+            } else {
+              succeeded = db_->Scan(req.key, req.scan_amount, &scan_out_);
+              if (succeeded && scan_out_.size() > 0) {
+                read_xor_ ^= *reinterpret_cast<const uint32_t*>(
+                    scan_out_.front().second.c_str());
               }
-            },
-            measure_latency);
-        size_t scanned_bytes = 0;
-        for (const auto& entry : scan_out) {
+            }
+          },
+          measure_latency, intended_start);
+      size_t scanned_bytes = 0, num_scanned = 0;
+      if constexpr (kSupportsScanInto) {
+        num_scanned = records_out_.size();
+        scanned_bytes =
+            num_scanned * sizeof(Request::Key) + records_out_.ValueBytes();
+      } else {
+        num_scanned = scan_out_.size();
+        for (const auto& entry : scan_out_) {
           scanned_bytes += sizeof(entry.first) + entry.second.size();
         }
-        tracker_.RecordScan(run_time, scanned_bytes, scan_out.size(),
-                            succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to run a range scan (expected to succeed).");
-        }
-        if (options_.expect_scan_amount_found &&
-            scan_out.size() < req.scan_amount) {
-          throw std::runtime_error(
-              "A range scan returned too few (or too many) records.");
-        }
-        break;
       }
+      tracker_.RecordScan(run_time, scanned_bytes, num_scanned, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to run a range scan (expected to succeed).");
+      }
+      if (options_.expect_scan_amount_found && num_scanned < req.scan_amount) {
+        throw std::runtime_error(
+            "A range scan returned too few (or too many) records.");
+      }
+      break;
+    }
 
-      case Request::Operation::kReadModifyWrite: {
-        bool succeeded = false;
-
-        // First, do the read.
-        const auto read_run_time = MeasurementHelper(
-            [this, &req, &value_out, &read_xor, &succeeded]() {
-              // Do the read.
-              succeeded = db_->Read(req.key, &value_out);
-              if (!succeeded) return;
-              // Force a read of the extracted value. We want to count this
-              // time against the read latency too.
-              read_xor ^= *reinterpret_cast<const uint32_t*>(value_out.c_str());
-            },
-            measure_latency);
-        tracker_.RecordRead(read_run_time, value_out.size(), succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to read a record during a read-modify-write (expected to "
-              "succeed).");
-        }
-        // Skip the write if the read failed.
-        if (!succeeded) break;
-
-        // Now do the write.
-        const auto write_run_time = MeasurementHelper(
-            [this, &req, &succeeded]() {
-              succeeded = db_->Update(req.key, req.value, req.value_size);
-            },
-            measure_latency);
-        tracker_.RecordWrite(write_run_time, req.value_size, succeeded);
-        if (!succeeded && options_.expect_request_success) {
-          throw std::runtime_error(
-              "Failed to update a record during a read-modify-write (expected "
-              "to succeed).");
-        }
+    case Request::Operation::kReadModifyWrite: {
+      bool succeeded = false;
+      size_t value_size = 0;
+
+      // First, do the read.
+      const auto read_run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded, &value_size]() {
+            succeeded = ReadValue(req.key, &value_size);
+          },
+          measure_latency, intended_start);
+      tracker_.RecordReadModifyWriteRead(read_run_time, value_size, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to read a record during a read-modify-write (expected to "
+            "succeed).");
+      }
+      // Skip the write if the read failed.
+      if (!succeeded) break;
+
+      // Now do the write. This latency is always measured from when the
+      // write is actually sent (the read's latency accounts for any delay).
+      const auto write_run_time = MeasurementHelper<Clock>(
+          [this, &req, &succeeded]() {
+            succeeded = db_->Update(req.key, req.value, req.value_size);
+          },
+          measure_latency);
+      // The read-modify-write's latency spans both its read and its write.
+      std::optional<std::chrono::nanoseconds> run_time;
+      if (read_run_time.has_value() && write_run_time.has_value()) {
+        run_time = *read_run_time + *write_run_time;
+      }
+      tracker_.RecordReadModifyWriteWrite(write_run_time, run_time,
+                                          req.value_size, succeeded);
+      if (!succeeded && options_.expect_request_success) {
+        throw std::runtime_error(
+            "Failed to update a record during a read-modify-write (expected "
+            "to succeed).");
+      }
+      break;
+    }
+
+    default:
+      throw std::runtime_error("Unrecognized request operation!");
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline bool Executor<DatabaseInterface, WorkloadProducer, Clock>::ReadValue(
+    const Request::Key key, size_t* const value_size) {
+  // Force a read of the extracted value. We want to count this time against
+  // the read latency too.
+  if constexpr (kSupportsReadInto) {
+    records_out_.Clear();
+    const bool succeeded = db_->ReadInto(key, &records_out_);
+    *value_size = records_out_.ValueBytes();
+    if (succeeded && !records_out_.empty()) {
+      read_xor_ ^= ValuePrefix(records_out_.value(0));
+    }
+    return succeeded;
+  } else {
+    value_out_.clear();
+    const bool succeeded = db_->Read(key, &value_out_);
+    *value_size = value_out_.size();
+    if (succeeded) {
+      read_xor_ ^= *reinterpret_cast<const uint32_t*>(value_out_.c_str());
+    }
+    return succeeded;
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline bool Executor<DatabaseInterface, WorkloadProducer, Clock>::CanBatch(
+    const Request::Operation op) {
+  switch (op) {
+    case Request::Operation::kRead:
+    case Request::Operation::kNegativeRead:
+      return kSupportsReadBatch;
+    case Request::Operation::kInsert:
+    case Request::Operation::kUpdate:
+      return kSupportsWriteBatch;
+    default:
+      return false;
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline bool Executor<DatabaseInterface, WorkloadProducer, Clock>::InSameBatch(
+    const Request::Operation first, const Request::Operation next) {
+  // Reads and negative reads are not mixed so that a batch's `ReadBatch()`
+  // result can be attributed to a single operation type.
+  return first == next;
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline size_t
+Executor<DatabaseInterface, WorkloadProducer, Clock>::ProducerPhase() const {
+  if constexpr (kReportsPhase) {
+    return producer_.CurrentPhase();
+  } else {
+    return 0;
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::BatchedWorkloadLoop() {
+  batch_.reserve(options_.batch_size);
+  // Holds the request that ended the previous batch (it needs to be processed
+  // next).
+  std::optional<Request> lookahead;
+
+  while (lookahead.has_value() || producer_.HasNext()) {
+    if (!ObserveRunStage(run_stage_, &last_stage_, &tracker_)) break;
+    const Request req = lookahead.has_value() ? *lookahead : producer_.Next();
+    lookahead.reset();
+    // The producer has not advanced past `req` (even if it is a lookahead).
+    const size_t phase = ProducerPhase();
+    if constexpr (kReportsPhase) {
+      tracker_.EnterPhase(phase);
+    }
+
+    if (!CanBatch(req.op)) {
+      ProcessRequest(req, ShouldMeasureLatency(1), std::nullopt);
+      SampleThroughputIfNeeded(1);
+      continue;
+    }
+
+    // Gather consecutive requests of the same type (and in the same phase).
+    batch_.clear();
+    batch_.push_back(req);
+    while (batch_.size() < options_.batch_size && producer_.HasNext()) {
+      const Request& next = producer_.Next();
+      if (!InSameBatch(req.op, next.op) || ProducerPhase() != phase) {
+        lookahead = next;
         break;
       }
+      batch_.push_back(next);
+    }
 
-      default:
-        throw std::runtime_error("Unrecognized request operation!");
+    if (req.op == Request::Operation::kInsert ||
+        req.op == Request::Operation::kUpdate) {
+      ProcessWriteBatch();
+    } else {
+      ProcessReadBatch();
     }
+    SampleThroughputIfNeeded(batch_.size());
+  }
+}
 
-    if (options_.throughput_sample_period > 0 &&
-        ++throughput_sampling_counter_ >= options_.throughput_sample_period) {
-      auto sample = tracker_.GetSample();
-      throughput_output_file_ << sample.MRecordsPerSecond() << ","
-                              << sample.ElapsedTimeNanos().count() << std::endl;
-      throughput_sampling_counter_ = 0;
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::ProcessReadBatch() {
+  if constexpr (kSupportsReadBatch) {
+    batch_keys_.clear();
+    for (const auto& req : batch_) {
+      batch_keys_.push_back(req.key);
+    }
+    batch_values_out_.resize(batch_keys_.size());
+    for (auto& value : batch_values_out_) {
+      value.clear();
+    }
+
+    size_t num_found = 0;
+    const auto run_time = MeasurementHelper<Clock>(
+        [this, &num_found]() {
+          num_found = db_->ReadBatch(batch_keys_, &batch_values_out_);
+          // Force a read of the extracted values. We want to count this time
+          // against the read latency too.
+          for (const auto& value : batch_values_out_) {
+            if (value.empty()) continue;
+            read_xor_ ^= *reinterpret_cast<const uint32_t*>(value.c_str());
+          }
+        },
+        ShouldMeasureLatency(batch_.size()));
+
+    size_t read_bytes = 0;
+    for (const auto& value : batch_values_out_) {
+      read_bytes += value.size();
+    }
+    // Read batches only hold one type of request (see `InSameBatch()`), so
+    // `num_found` alone determines the number of failed requests.
+    tracker_.RecordReadBatch(batch_.front().op, run_time, batch_.size(),
+                             num_found, read_bytes);
+    if (num_found < batch_.size() && options_.expect_request_success) {
+      throw std::runtime_error(
+          "Failed to read a key that was expected to be found.");
+    }
+  }
+}
+
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::ProcessWriteBatch() {
+  if constexpr (kSupportsWriteBatch) {
+    size_t num_succeeded = 0;
+    const auto run_time = MeasurementHelper<Clock>(
+        [this, &num_succeeded]() { num_succeeded = db_->WriteBatch(batch_); },
+        ShouldMeasureLatency(batch_.size()));
+
+    // Inserts count the whole record size; updates only count the value size
+    // (see `ProcessRequest()`).
+    size_t write_bytes = 0;
+    for (const auto& req : batch_) {
+      write_bytes += req.value_size;
+      if (req.op == Request::Operation::kInsert) {
+        write_bytes += sizeof(req.key);
+      }
+    }
+    // Write batches only hold one type of request (see `InSameBatch()`).
+    tracker_.RecordWriteBatch(batch_.front().op, run_time, batch_.size(),
+                              num_succeeded, write_bytes);
+    if (num_succeeded < batch_.size() && options_.expect_request_success) {
+      throw std::runtime_error(
+          "Failed to write a batch of records (expected to succeed).");
     }
   }
-  // Used to prevent optimizing away reads.
-  tracker_.SetReadXOR(read_xor);
 }
 
-template <class DatabaseInterface, typename WorkloadProducer>
-inline void Executor<DatabaseInterface, WorkloadProducer>::BM_WorkloadLoop() {
+template <class DatabaseInterface, typename WorkloadProducer, typename Clock>
+inline void
+Executor<DatabaseInterface, WorkloadProducer, Clock>::BM_WorkloadLoop() {
   WorkloadLoop();
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <future>
 
 namespace ycsbr {
@@ -26,6 +27,12 @@ class Flag {
   // exclusion.
   void Wait() const { future_.get(); }
 
+  // Waits for this flag to be raised or for `deadline` to pass, whichever
+  // happens first. Returns true iff the flag was raised.
+  bool WaitUntil(const std::chrono::steady_clock::time_point& deadline) const {
+    return future_.wait_until(deadline) == std::future_status::ready;
+  }
+
  private:
   std::promise<void> flag_;
   std::shared_future<void> future_;
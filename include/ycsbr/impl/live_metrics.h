@@ -0,0 +1,310 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../latency_histogram.h"
+#include "../run_options.h"
+
+namespace ycsbr {
+namespace impl {
+
+// The live metrics counters have a single writer (a worker), so a relaxed load
+// and store is enough to increment them (and avoids a locked read-modify-write
+// on the worker's hot path).
+inline void IncrementRelaxed(std::atomic<uint64_t>* counter,
+                             const uint64_t amount) {
+  counter->store(counter->load(std::memory_order_relaxed) + amount,
+                 std::memory_order_relaxed);
+}
+
+// A latency histogram that is written by one thread and read concurrently by
+// another. It uses the same buckets as `LatencyHistogram`. The counts only ever
+// increase, so the reader computes the counts recorded during an interval by
+// subtracting an earlier snapshot.
+class LiveHistogram {
+ public:
+  // Percentiles have a relative error of at most 2^-5 (about 3%).
+  static constexpr int kPrecisionBits = 6;
+
+  LiveHistogram() : counts_(LatencyHistogram::NumBuckets(kPrecisionBits)) {}
+
+  // Must only be called by the writer.
+  void Record(const std::chrono::nanoseconds latency, const uint64_t count) {
+    const uint64_t value = latency.count() < 0 ? 0 : latency.count();
+    IncrementRelaxed(
+        &counts_[LatencyHistogram::BucketIndex(value, kPrecisionBits)], count);
+  }
+
+  // Adds the counts recorded since the snapshot in `previous` to `window` and
+  // then updates `previous`. Both vectors must have `NumBuckets()` entries.
+  void Collect(std::vector<uint64_t>* previous,
+               std::vector<uint64_t>* window) const {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      const uint64_t count = counts_[i].load(std::memory_order_relaxed);
+      (*window)[i] += count - (*previous)[i];
+      (*previous)[i] = count;
+    }
+  }
+
+  static size_t NumBuckets() {
+    return LatencyHistogram::NumBuckets(kPrecisionBits);
+  }
+
+  // Returns the upper bound of the bucket that holds `percentile` (between 0.0
+  // and 1.0 inclusive) in `counts`, or 0 if `counts` is empty.
+  static uint64_t Percentile(const std::vector<uint64_t>& counts,
+                             const double percentile) {
+    uint64_t total = 0;
+    for (const uint64_t count : counts) {
+      total += count;
+    }
+    if (total == 0) return 0;
+    uint64_t rank = percentile * total;
+    if (rank == total) {
+      --rank;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+      seen += counts[i];
+      if (seen > rank) {
+        return LatencyHistogram::BucketUpperBound(i, kPrecisionBits);
+      }
+    }
+    return 0;
+  }
+
+ private:
+  std::vector<std::atomic<uint64_t>> counts_;
+};
+
+// The live metrics of one worker. Only the worker writes them (through its
+// `MetricsTracker`) and only the `LiveMetricsMonitor` reads them. Each worker's
+// counters start on their own cache line to avoid false sharing.
+struct alignas(64) LiveCounters {
+  // The counters of one kind of request.
+  struct Op {
+    void Record(const std::optional<std::chrono::nanoseconds>& run_time,
+                const uint64_t num_succeeded, const uint64_t num_failed) {
+      if (num_succeeded > 0) {
+        IncrementRelaxed(&succeeded, num_succeeded);
+        if (run_time.has_value()) {
+          latency.Record(*run_time, num_succeeded);
+        }
+      }
+      if (num_failed > 0) {
+        IncrementRelaxed(&failed, num_failed);
+      }
+    }
+
+    std::atomic<uint64_t> succeeded{0};
+    std::atomic<uint64_t> failed{0};
+    // Only the sampled latencies are recorded (see
+    // `RunOptions::latency_sample_period`), in `Clock` ticks.
+    LiveHistogram latency;
+  };
+
+  Op reads, writes, scans;
+};
+
+// Periodically merges the workers' `LiveCounters` and writes one row of
+// metrics for the whole run per period (see `RunOptions::live_metrics_period`)
+// to a CSV or JSON Lines file. The workers never do any I/O for these metrics.
+class LiveMetricsMonitor {
+ public:
+  // Creates the output file. Latencies are converted from ticks into
+  // nanoseconds using `nanos_per_tick`. Throws `std::invalid_argument` if the
+  // output file cannot be created.
+  LiveMetricsMonitor(const RunOptions& options, size_t num_workers,
+                     double nanos_per_tick);
+  ~LiveMetricsMonitor();
+
+  LiveMetricsMonitor(const LiveMetricsMonitor&) = delete;
+  LiveMetricsMonitor& operator=(const LiveMetricsMonitor&) = delete;
+
+  LiveCounters* counters(size_t worker) { return workers_[worker].get(); }
+
+  // Starts the monitor thread.
+  void Start();
+  // Writes a final row (covering the time since the last row) and stops the
+  // monitor thread.
+  void Stop();
+
+ private:
+  // The counts of one kind of request. Used both for the merged counts of one
+  // period and for the previous snapshot of each worker's counters.
+  struct OpCounts {
+    uint64_t succeeded = 0, failed = 0;
+    std::vector<uint64_t> latency =
+        std::vector<uint64_t>(LiveHistogram::NumBuckets());
+  };
+  static constexpr size_t kNumOps = 3;
+
+  void MonitorMain();
+  void WriteRow(std::chrono::steady_clock::time_point now);
+  void WriteHeader();
+
+  const RunOptions::LiveMetricsFormat format_;
+  const std::chrono::milliseconds period_;
+  const double nanos_per_tick_;
+  std::ofstream out_;
+
+  std::vector<std::unique_ptr<LiveCounters>> workers_;
+  // Indexed by worker, then by op (reads, writes, scans).
+  std::vector<std::array<OpCounts, kNumOps>> snapshots_;
+
+  std::chrono::steady_clock::time_point start_, last_row_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_;
+  std::thread thread_;
+};
+
+// Implementation details follow.
+
+inline LiveMetricsMonitor::LiveMetricsMonitor(const RunOptions& options,
+                                              const size_t num_workers,
+                                              const double nanos_per_tick)
+    : format_(options.live_metrics_format),
+      period_(options.live_metrics_period),
+      nanos_per_tick_(nanos_per_tick),
+      snapshots_(num_workers),
+      stop_(false) {
+  const auto filename =
+      options.output_dir /
+      (options.live_metrics_file +
+       (format_ == RunOptions::LiveMetricsFormat::kCSV ? ".csv" : ".jsonl"));
+  out_.open(filename);
+  if (out_.fail()) {
+    throw std::invalid_argument("Failed to create output file: " +
+                                filename.string());
+  }
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<LiveCounters>());
+  }
+  WriteHeader();
+}
+
+inline LiveMetricsMonitor::~LiveMetricsMonitor() {
+  if (!thread_.joinable()) return;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+inline void LiveMetricsMonitor::Start() {
+  start_ = last_row_ = std::chrono::steady_clock::now();
+  thread_ = std::thread(&LiveMetricsMonitor::MonitorMain, this);
+}
+
+inline void LiveMetricsMonitor::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  WriteRow(std::chrono::steady_clock::now());
+}
+
+inline void LiveMetricsMonitor::MonitorMain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto next_row = start_ + period_;
+  while (!cv_.wait_until(lock, next_row, [this]() { return stop_; })) {
+    WriteRow(std::chrono::steady_clock::now());
+    next_row += period_;
+  }
+}
+
+inline void LiveMetricsMonitor::WriteHeader() {
+  if (format_ != RunOptions::LiveMetricsFormat::kCSV) return;
+  out_ << "elapsed_ms,krequests_per_s";
+  for (const char* op : {"read", "write", "scan"}) {
+    out_ << ",num_" << op << "s,num_failed_" << op << "s," << op
+         << "s_ns_p50," << op << "s_ns_p99";
+  }
+  out_ << '\n';
+}
+
+inline void LiveMetricsMonitor::WriteRow(
+    const std::chrono::steady_clock::time_point now) {
+  std::array<OpCounts, kNumOps> window;
+  uint64_t num_requests = 0;
+  for (size_t worker = 0; worker < workers_.size(); ++worker) {
+    const LiveCounters& counters = *workers_[worker];
+    const std::array<const LiveCounters::Op*, kNumOps> ops = {
+        &counters.reads, &counters.writes, &counters.scans};
+    for (size_t i = 0; i < kNumOps; ++i) {
+      OpCounts& snapshot = snapshots_[worker][i];
+      const uint64_t succeeded =
+          ops[i]->succeeded.load(std::memory_order_relaxed);
+      const uint64_t failed = ops[i]->failed.load(std::memory_order_relaxed);
+      window[i].succeeded += succeeded - snapshot.succeeded;
+      window[i].failed += failed - snapshot.failed;
+      snapshot.succeeded = succeeded;
+      snapshot.failed = failed;
+      ops[i]->latency.Collect(&snapshot.latency, &window[i].latency);
+    }
+  }
+  for (const auto& op : window) {
+    num_requests += op.succeeded + op.failed;
+  }
+
+  const double window_ms =
+      std::chrono::duration<double, std::milli>(now - last_row_).count();
+  const uint64_t elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - start_)
+          .count();
+  last_row_ = now;
+  // (requests / millisecond) is equivalent to (krequests / second)
+  const double krequests_per_s =
+      window_ms > 0.0 ? num_requests / window_ms : 0.0;
+  const auto percentile_ns = [this](const OpCounts& op, double percentile) {
+    return static_cast<uint64_t>(
+        LiveHistogram::Percentile(op.latency, percentile) * nanos_per_tick_);
+  };
+
+  if (format_ == RunOptions::LiveMetricsFormat::kCSV) {
+    out_ << elapsed_ms << ',' << krequests_per_s;
+    for (const auto& op : window) {
+      out_ << ',' << op.succeeded << ',' << op.failed << ','
+           << percentile_ns(op, 0.5) << ',' << percentile_ns(op, 0.99);
+    }
+  } else {
+    out_ << "{\"elapsed_ms\":" << elapsed_ms
+         << ",\"krequests_per_s\":" << krequests_per_s;
+    const char* names[kNumOps] = {"read", "write", "scan"};
+    for (size_t i = 0; i < kNumOps; ++i) {
+      const char* op = names[i];
+      out_ << ",\"num_" << op << "s\":" << window[i].succeeded
+           << ",\"num_failed_" << op << "s\":" << window[i].failed << ",\""
+           << op << "s_ns_p50\":" << percentile_ns(window[i], 0.5) << ",\""
+           << op << "s_ns_p99\":" << percentile_ns(window[i], 0.99);
+    }
+    out_ << '}';
+  }
+  // Flushed so that the file can be followed while the workload runs (this
+  // is not on a worker's path).
+  out_ << std::endl;
+}
+
+}  // namespace impl
+}  // namespace ycsbr
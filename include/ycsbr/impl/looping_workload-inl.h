@@ -0,0 +1,153 @@
+// Implementation of declarations in looping_workload.h. Do not include this
+// header!
+#include <map>
+#include <mutex>
+
+namespace ycsbr {
+
+// Holds the wrapped producers of the upcoming repetitions. The first producer
+// to start a repetition creates the producers for all of them.
+template <class Workload>
+class LoopingWorkload<Workload>::ProducerPool {
+ public:
+  ProducerPool(const Workload* workload, size_t num_producers,
+               size_t num_active);
+
+  // Returns the wrapped producer with ID `id` for repetition `loop`.
+  typename Workload::Producer Take(size_t loop, size_t id);
+
+  // Called when a producer will not repeat because it has no requests (so its
+  // producers in later repetitions are not kept around for it).
+  void Retire();
+
+ private:
+  struct Loop {
+    std::vector<std::optional<typename Workload::Producer>> producers;
+    size_t num_taken;
+  };
+
+  const Workload* workload_;
+  const size_t num_producers_;
+
+  std::mutex mutex_;
+  // The number of producers that still take part in the repetitions.
+  size_t num_active_;
+  // Indexed by repetition. A repetition is removed once all of the active
+  // producers have taken their producer.
+  std::map<size_t, Loop> loops_;
+};
+
+template <class Workload>
+inline LoopingWorkload<Workload>::LoopingWorkload(const Workload& workload,
+                                                  Options options)
+    : workload_(workload), options_(std::move(options)) {}
+
+template <class Workload>
+inline std::vector<typename LoopingWorkload<Workload>::Producer>
+LoopingWorkload<Workload>::GetProducers(const size_t num_producers) const {
+  std::vector<typename Workload::Producer> producers =
+      workload_.GetProducers(num_producers);
+  const auto pool = std::make_shared<ProducerPool>(&workload_, num_producers,
+                                                   producers.size());
+  std::vector<Producer> wrapper_producers;
+  wrapper_producers.reserve(producers.size());
+  for (size_t id = 0; id < producers.size(); ++id) {
+    wrapper_producers.push_back(
+        Producer(this, pool, id, std::move(producers[id])));
+  }
+  return wrapper_producers;
+}
+
+template <class Workload>
+inline LoopingWorkload<Workload>::Producer::Producer(
+    const LoopingWorkload* workload, std::shared_ptr<ProducerPool> pool,
+    const size_t id, typename Workload::Producer producer)
+    : workload_(workload),
+      pool_(std::move(pool)),
+      id_(id),
+      loops_(1),
+      empty_(false) {
+  producer_.emplace(std::move(producer));
+}
+
+template <class Workload>
+inline void LoopingWorkload<Workload>::Producer::Prepare() {
+  producer_->Prepare();
+  empty_ = !producer_->HasNext();
+  if (empty_) {
+    pool_->Retire();
+  }
+}
+
+template <class Workload>
+inline bool LoopingWorkload<Workload>::Producer::HasNext() const {
+  if (producer_->HasNext()) return true;
+  const size_t max_loops = workload_->options_.max_loops;
+  return !empty_ && (max_loops == 0 || loops_ < max_loops);
+}
+
+template <class Workload>
+inline Request LoopingWorkload<Workload>::Producer::Next() {
+  if (!producer_->HasNext()) {
+    Restart();
+  }
+  return producer_->Next();
+}
+
+template <class Workload>
+inline void LoopingWorkload<Workload>::Producer::Restart() {
+  // Release the finished producer's resources first.
+  producer_.reset();
+  ++loops_;
+  producer_.emplace(pool_->Take(loops_, id_));
+  producer_->Prepare();
+}
+
+template <class Workload>
+inline LoopingWorkload<Workload>::ProducerPool::ProducerPool(
+    const Workload* workload, const size_t num_producers,
+    const size_t num_active)
+    : workload_(workload),
+      num_producers_(num_producers),
+      num_active_(num_active) {}
+
+template <class Workload>
+inline typename Workload::Producer
+LoopingWorkload<Workload>::ProducerPool::Take(const size_t loop,
+                                              const size_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = loops_.find(loop);
+  if (it == loops_.end()) {
+    std::vector<typename Workload::Producer> producers =
+        workload_->GetProducers(num_producers_);
+    Loop new_loop;
+    new_loop.producers.reserve(producers.size());
+    for (auto& producer : producers) {
+      new_loop.producers.emplace_back(std::move(producer));
+    }
+    new_loop.num_taken = 0;
+    it = loops_.emplace(loop, std::move(new_loop)).first;
+  }
+  Loop& current = it->second;
+  typename Workload::Producer producer(std::move(*current.producers[id]));
+  current.producers[id].reset();
+  if (++current.num_taken >= num_active_) {
+    loops_.erase(it);
+  }
+  return producer;
+}
+
+template <class Workload>
+inline void LoopingWorkload<Workload>::ProducerPool::Retire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  --num_active_;
+  for (auto it = loops_.begin(); it != loops_.end();) {
+    if (it->second.num_taken >= num_active_) {
+      it = loops_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace ycsbr
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace ycsbr {
+namespace impl {
+
+// A read-only memory mapping of an entire file.
+class MappedFile {
+ public:
+  // Throws `std::runtime_error` if the file cannot be opened or mapped.
+  explicit MappedFile(const std::string& file);
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Tells the kernel that the mapping will be read sequentially (so it can
+  // read ahead aggressively).
+  void AdviseSequential() const;
+
+ private:
+  void Unmap();
+
+  const char* data_;
+  size_t size_;
+};
+
+// Implementation details follow.
+
+inline MappedFile::MappedFile(const std::string& file)
+    : data_(nullptr), size_(0) {
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open file: " + file + " (" +
+                             std::strerror(errno) + ")");
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    const int err = errno;
+    close(fd);
+    throw std::runtime_error("Failed to stat file: " + file + " (" +
+                             std::strerror(err) + ")");
+  }
+  size_ = static_cast<size_t>(file_stat.st_size);
+  if (size_ == 0) {
+    // Empty files cannot be mapped.
+    close(fd);
+    return;
+  }
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int err = errno;
+  // The mapping remains valid after the file descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    throw std::runtime_error("Failed to map file: " + file + " (" +
+                             std::strerror(err) + ")");
+  }
+  data_ = static_cast<const char*>(data);
+}
+
+inline MappedFile::~MappedFile() { Unmap(); }
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this == &other) return *this;
+  Unmap();
+  data_ = other.data_;
+  size_ = other.size_;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  return *this;
+}
+
+inline void MappedFile::AdviseSequential() const {
+  if (data_ == nullptr) return;
+  // This is only a hint, so errors are ignored.
+  madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+inline void MappedFile::Unmap() {
+  if (data_ == nullptr) return;
+  munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ycsbr {
+namespace impl {
+
+// The machine's NUMA topology (which cores belong to which NUMA node), read
+// from sysfs. On machines without NUMA support (or if sysfs is not available),
+// all cores are reported to be on node 0.
+class NumaTopology {
+ public:
+  // Returns the topology of this machine (read once).
+  static const NumaTopology& Get();
+
+  // Used for testing. `node_cpu_lists[i]` holds node `i`'s cores, in the
+  // kernel's "cpulist" format (e.g., "0-3,8-11").
+  static NumaTopology FromCpuLists(
+      const std::vector<std::string>& node_cpu_lists);
+
+  size_t num_nodes() const { return cores_.size(); }
+  const std::vector<size_t>& CoresOnNode(size_t node) const {
+    return cores_[node];
+  }
+  // Returns 0 if the core is unknown.
+  size_t NodeOfCore(size_t core) const;
+
+  // Returns a core map for `num_threads` threads (see `Session`) that assigns
+  // the threads to cores round-robin across the nodes (i.e., thread `i` runs on
+  // node `i % num_nodes()`). If there are more threads than cores, cores are
+  // reused.
+  std::vector<size_t> CoreMap(size_t num_threads) const;
+
+  // Parses a "cpulist" (e.g., "0-3,8-11").
+  static std::vector<size_t> ParseCpuList(const std::string& cpu_list);
+
+ private:
+  NumaTopology() = default;
+
+  // `cores_[i]` holds the cores on node `i`, in ascending order.
+  std::vector<std::vector<size_t>> cores_;
+};
+
+// Returns the NUMA node that the calling thread is currently running on (0 if
+// it cannot be determined). The result is only stable if the thread is pinned
+// to a core.
+inline size_t CurrentNumaNode() {
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+  return node;
+}
+
+// Implementation details follow.
+
+inline const NumaTopology& NumaTopology::Get() {
+  static const NumaTopology topology = []() {
+    std::vector<std::string> node_cpu_lists;
+    for (size_t node = 0;; ++node) {
+      std::ifstream cpu_list_file("/sys/devices/system/node/node" +
+                                  std::to_string(node) + "/cpulist");
+      if (!cpu_list_file) break;
+      std::string cpu_list;
+      std::getline(cpu_list_file, cpu_list);
+      node_cpu_lists.push_back(std::move(cpu_list));
+    }
+    if (node_cpu_lists.empty()) {
+      const size_t num_cores =
+          std::max(1U, std::thread::hardware_concurrency());
+      node_cpu_lists.push_back("0-" + std::to_string(num_cores - 1));
+    }
+    return FromCpuLists(node_cpu_lists);
+  }();
+  return topology;
+}
+
+inline NumaTopology NumaTopology::FromCpuLists(
+    const std::vector<std::string>& node_cpu_lists) {
+  NumaTopology topology;
+  for (const auto& cpu_list : node_cpu_lists) {
+    topology.cores_.push_back(ParseCpuList(cpu_list));
+  }
+  return topology;
+}
+
+inline size_t NumaTopology::NodeOfCore(const size_t core) const {
+  for (size_t node = 0; node < cores_.size(); ++node) {
+    if (std::binary_search(cores_[node].begin(), cores_[node].end(), core)) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+inline std::vector<size_t> NumaTopology::CoreMap(
+    const size_t num_threads) const {
+  // Nodes without cores (e.g., memory-only nodes) are skipped.
+  std::vector<const std::vector<size_t>*> nodes;
+  for (const auto& cores : cores_) {
+    if (!cores.empty()) nodes.push_back(&cores);
+  }
+  std::vector<size_t> core_map;
+  core_map.reserve(num_threads);
+  if (nodes.empty()) return core_map;
+  for (size_t i = 0; i < num_threads; ++i) {
+    const std::vector<size_t>& cores = *nodes[i % nodes.size()];
+    core_map.push_back(cores[(i / nodes.size()) % cores.size()]);
+  }
+  return core_map;
+}
+
+inline std::vector<size_t> NumaTopology::ParseCpuList(
+    const std::string& cpu_list) {
+  std::vector<size_t> cores;
+  size_t pos = 0;
+  while (pos < cpu_list.size()) {
+    size_t end = cpu_list.find(',', pos);
+    if (end == std::string::npos) end = cpu_list.size();
+    const std::string range = cpu_list.substr(pos, end - pos);
+    pos = end + 1;
+    if (range.empty() || range == "\n") continue;
+    const size_t dash = range.find('-');
+    const size_t first = std::strtoul(range.c_str(), nullptr, 10);
+    const size_t last =
+        dash == std::string::npos
+            ? first
+            : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+    for (size_t core = first; core <= last; ++core) {
+      cores.push_back(core);
+    }
+  }
+  std::sort(cores.begin(), cores.end());
+  return cores;
+}
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -0,0 +1,262 @@
+// Implementation of declarations in persisted_workload.h. Do not include this
+// header!
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "../trace.h"
+#include "db_traits.h"
+#include "util.h"
+
+namespace ycsbr {
+
+template <class Workload>
+inline void PersistedWorkload::Write(const Workload& workload,
+                                     const size_t num_producers,
+                                     const std::string& file,
+                                     const size_t requests_per_block) {
+  if (requests_per_block == 0 ||
+      requests_per_block > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Invalid number of requests per block.");
+  }
+  std::ofstream output(file,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output) {
+    throw std::runtime_error("Failed to open file for writing: " + file);
+  }
+  output.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+
+  // The header is rewritten with the final counts at the end.
+  impl::PersistedWorkloadHeader header = {};
+  std::copy(std::begin(impl::kPersistedWorkloadMagic),
+            std::end(impl::kPersistedWorkloadMagic), header.magic);
+  header.version = impl::kPersistedWorkloadVersion;
+  header.requests_per_block = static_cast<uint32_t>(requests_per_block);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t offset = sizeof(header);
+
+  std::vector<impl::PersistedProducerInfo> producer_infos;
+  std::vector<uint64_t> block_offsets;
+  std::vector<impl::PersistedPhaseChange> phase_changes;
+  std::vector<Request> block;
+  block.reserve(requests_per_block);
+  std::string encoded;
+  const auto flush_block = [&]() {
+    if (block.empty()) return;
+    encoded.clear();
+    impl::EncodeTraceV3Block(block.data(), block.size(), &encoded);
+    output.write(encoded.data(), encoded.size());
+    block_offsets.push_back(offset);
+    offset += encoded.size();
+    block.clear();
+  };
+
+  auto producers = workload.GetProducers(num_producers);
+  for (auto& producer : producers) {
+    impl::PersistedProducerInfo info = {};
+    info.first_block = block_offsets.size();
+    producer.Prepare();
+    while (producer.HasNext()) {
+      const Request req = producer.Next();
+      if (req.value_size != 0) {
+        if (header.value_size == 0) {
+          header.value_size = req.value_size;
+        } else if (header.value_size != req.value_size) {
+          throw std::invalid_argument(
+              "PersistedWorkload requires all values to have the same size.");
+        }
+      }
+      if constexpr (impl::ReportsPhase<typename Workload::Producer>::value) {
+        const uint64_t phase = producer.CurrentPhase();
+        if (info.num_phase_changes == 0 ||
+            phase_changes.back().phase != phase) {
+          phase_changes.push_back(
+              impl::PersistedPhaseChange{info.num_requests, phase});
+          ++info.num_phase_changes;
+        }
+      }
+      block.push_back(req);
+      ++info.num_requests;
+      if (block.size() == requests_per_block) {
+        flush_block();
+      }
+    }
+    // Each producer's requests start in a new block.
+    flush_block();
+    producer_infos.push_back(info);
+  }
+
+  output.write(reinterpret_cast<const char*>(producer_infos.data()),
+               producer_infos.size() * sizeof(impl::PersistedProducerInfo));
+  output.write(reinterpret_cast<const char*>(block_offsets.data()),
+               block_offsets.size() * sizeof(uint64_t));
+  output.write(
+      reinterpret_cast<const char*>(phase_changes.data()),
+      phase_changes.size() * sizeof(impl::PersistedPhaseChange));
+  header.num_producers = producer_infos.size();
+  header.num_blocks = block_offsets.size();
+  header.index_offset = offset;
+  output.seekp(0);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  output.close();
+}
+
+inline PersistedWorkload::PersistedWorkload(const std::string& file,
+                                            const uint32_t rng_seed)
+    : file_(file), header_(), num_requests_(0) {
+  const char* const data = file_.data();
+  const size_t size = file_.size();
+  if (size < sizeof(header_) ||
+      memcmp(data, impl::kPersistedWorkloadMagic,
+             sizeof(impl::kPersistedWorkloadMagic)) != 0) {
+    throw std::runtime_error("Not a persisted workload file: " + file);
+  }
+  memcpy(&header_, data, sizeof(header_));
+  if (header_.version != impl::kPersistedWorkloadVersion) {
+    throw std::runtime_error("Unsupported persisted workload version: " +
+                             std::to_string(header_.version));
+  }
+  if (header_.requests_per_block == 0 || header_.index_offset > size ||
+      header_.index_offset < sizeof(header_) ||
+      (size - header_.index_offset) / sizeof(impl::PersistedProducerInfo) <
+          header_.num_producers) {
+    throw std::runtime_error("Corrupt persisted workload (invalid header).");
+  }
+  const size_t infos_size =
+      header_.num_producers * sizeof(impl::PersistedProducerInfo);
+  if ((size - header_.index_offset - infos_size) / sizeof(uint64_t) <
+      header_.num_blocks) {
+    throw std::runtime_error("Corrupt persisted workload (invalid header).");
+  }
+  producers_.resize(header_.num_producers);
+  memcpy(producers_.data(), data + header_.index_offset, infos_size);
+  block_offsets_.resize(header_.num_blocks);
+  const size_t block_offsets_end =
+      header_.index_offset + infos_size + header_.num_blocks * sizeof(uint64_t);
+  memcpy(block_offsets_.data(), data + header_.index_offset + infos_size,
+         header_.num_blocks * sizeof(uint64_t));
+
+  // Each producer's blocks must directly follow the previous producer's.
+  uint64_t next_block = 0;
+  uint64_t num_phase_changes = 0;
+  for (const auto& info : producers_) {
+    if (info.first_block != next_block ||
+        info.num_phase_changes > info.num_requests) {
+      throw std::runtime_error(
+          "Corrupt persisted workload (invalid producer index).");
+    }
+    next_block += (info.num_requests + header_.requests_per_block - 1) /
+                  header_.requests_per_block;
+    num_requests_ += info.num_requests;
+    num_phase_changes += info.num_phase_changes;
+  }
+  if (next_block != header_.num_blocks ||
+      (size - block_offsets_end) / sizeof(impl::PersistedPhaseChange) <
+          num_phase_changes) {
+    throw std::runtime_error(
+        "Corrupt persisted workload (invalid producer index).");
+  }
+  phase_changes_.resize(num_phase_changes);
+  memcpy(phase_changes_.data(), data + block_offsets_end,
+         num_phase_changes * sizeof(impl::PersistedPhaseChange));
+  uint64_t prev = sizeof(header_);
+  for (const uint64_t offset : block_offsets_) {
+    if (offset < prev || offset > header_.index_offset) {
+      throw std::runtime_error(
+          "Corrupt persisted workload (invalid block index).");
+    }
+    prev = offset;
+  }
+
+  if (header_.value_size > 0) {
+    std::mt19937 rng(rng_seed);
+    values_ = impl::GetRandomBytes(
+        std::max<size_t>(kNumUniqueValues * header_.value_size,
+                         sizeof(uint32_t)),
+        rng);
+  }
+}
+
+inline std::vector<PersistedWorkload::Producer>
+PersistedWorkload::GetProducers(const size_t num_producers) const {
+  if (num_producers != producers_.size()) {
+    throw std::invalid_argument(
+        "The persisted workload was written for " +
+        std::to_string(producers_.size()) + " producer(s), but " +
+        std::to_string(num_producers) + " were requested.");
+  }
+  std::vector<Producer> producers;
+  producers.reserve(num_producers);
+  size_t first_phase_change = 0;
+  for (size_t producer_id = 0; producer_id < num_producers; ++producer_id) {
+    producers.push_back(Producer(this, producer_id, first_phase_change));
+    first_phase_change += producers_[producer_id].num_phase_changes;
+  }
+  return producers;
+}
+
+inline PersistedWorkload::Producer::Producer(const PersistedWorkload* workload,
+                                             const size_t producer_id,
+                                             const size_t first_phase_change)
+    : workload_(workload),
+      remaining_(workload->producers_[producer_id].num_requests),
+      next_block_(workload->producers_[producer_id].first_block),
+      value_index_(0),
+      block_index_(0),
+      next_request_(0),
+      next_phase_change_(first_phase_change),
+      end_phase_change_(first_phase_change +
+                        workload->producers_[producer_id].num_phase_changes),
+      current_phase_(0) {}
+
+inline void PersistedWorkload::Producer::Prepare() {
+  block_.reserve(std::min<size_t>(remaining_,
+                                  workload_->header_.requests_per_block));
+}
+
+inline Request PersistedWorkload::Producer::Next() {
+  if (block_index_ == block_.size()) {
+    NextBlock();
+  }
+  if (next_phase_change_ < end_phase_change_ &&
+      workload_->phase_changes_[next_phase_change_].first_request ==
+          next_request_) {
+    current_phase_ = workload_->phase_changes_[next_phase_change_++].phase;
+  }
+  ++next_request_;
+  --remaining_;
+  return block_[block_index_++];
+}
+
+inline void PersistedWorkload::Producer::NextBlock() {
+  const impl::PersistedWorkloadHeader& header = workload_->header_;
+  const size_t count =
+      std::min<size_t>(remaining_, header.requests_per_block);
+  const char* const data = workload_->file_.data();
+  const size_t begin = workload_->block_offsets_[next_block_];
+  const size_t end = next_block_ + 1 < workload_->block_offsets_.size()
+                         ? workload_->block_offsets_[next_block_ + 1]
+                         : header.index_offset;
+  block_.resize(count);
+  impl::DecodeTraceV3Block(data + begin, data + end, count,
+                           /*swap_key_bytes=*/false, block_.data());
+  ++next_block_;
+  block_index_ = 0;
+
+  if (workload_->values_ == nullptr) return;
+  for (auto& req : block_) {
+    if (req.op == Request::Operation::kInsert ||
+        req.op == Request::Operation::kUpdate ||
+        req.op == Request::Operation::kReadModifyWrite) {
+      req.value = &workload_->values_[(value_index_ % kNumUniqueValues) *
+                                      header.value_size];
+      req.value_size = header.value_size;
+      ++value_index_;
+    }
+  }
+}
+
+}  // namespace ycsbr
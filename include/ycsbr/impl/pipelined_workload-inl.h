@@ -0,0 +1,296 @@
+// Implementation of declarations in pipelined_workload.h. Do not include this
+// header!
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "affinity.h"
+#include "db_traits.h"
+#include "spsc_queue.h"
+
+namespace ycsbr {
+
+// Runs the wrapped producer on a background thread.
+template <class Workload>
+class PipelinedWorkload<Workload>::Producer::Pipeline {
+ public:
+  Pipeline(typename Workload::Producer producer, size_t queue_capacity,
+           std::optional<size_t> generator_core);
+  ~Pipeline();
+
+  // Starts the generator thread and waits until the queue is full (or until
+  // all the requests have been generated).
+  void Start();
+
+  bool HasNext();
+  Request Next();
+  // The phase of the request most recently returned by `Next()`.
+  size_t CurrentPhase() const { return current_phase_; }
+
+ private:
+  static constexpr bool kReportsPhase =
+      impl::ReportsPhase<typename Workload::Producer>::value;
+  struct PhasedRequest {
+    Request request;
+    size_t phase = 0;
+  };
+  // Requests only carry their phase if the wrapped producer reports it.
+  using QueueEntry = std::conditional_t<kReportsPhase, PhasedRequest, Request>;
+
+  void GeneratorMain();
+
+  // Block the generator while the queue is full and the consumer while it is
+  // empty. Each side only blocks after it has spun for a while.
+  void WaitForSpace();
+  void WaitForRequests();
+  // Wakes up the side that `blocked` belongs to.
+  void WakeUp(std::atomic<bool>* blocked);
+
+  typename Workload::Producer producer_;
+  const std::optional<size_t> generator_core_;
+  impl::SPSCQueue<QueueEntry> queue_;
+  // Only accessed by the consumer.
+  size_t current_phase_;
+
+  // Set when the queue is full for the first time (or when the generator
+  // finishes, whichever happens first).
+  std::atomic<bool> ready_;
+  // Set by the generator thread after it pushes its last request. `error_` is
+  // written before `done_` is set.
+  std::atomic<bool> done_;
+  std::exception_ptr error_;
+  // Set to stop the generator thread early.
+  std::atomic<bool> stop_;
+
+  // Set while a side is blocked. The consumer wakes the generator up once the
+  // queue is half empty, and the generator wakes the consumer up after it
+  // pushes a request (or finishes).
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<bool> generator_blocked_;
+  std::atomic<bool> consumer_blocked_;
+
+  std::thread thread_;
+};
+
+template <class Workload>
+inline PipelinedWorkload<Workload>::PipelinedWorkload(const Workload& workload,
+                                                      Options options)
+    : workload_(workload), options_(std::move(options)) {}
+
+template <class Workload>
+inline const Workload& PipelinedWorkload<Workload>::workload() const {
+  return workload_;
+}
+
+template <class Workload>
+inline std::vector<typename PipelinedWorkload<Workload>::Producer>
+PipelinedWorkload<Workload>::GetProducers(const size_t num_producers) const {
+  // Get the actual producers.
+  std::vector<typename Workload::Producer> producers =
+      workload_.GetProducers(num_producers);
+
+  // Construct the wrapper producers.
+  std::vector<typename PipelinedWorkload<Workload>::Producer> wrapper_producers;
+  wrapper_producers.reserve(producers.size());
+  for (size_t i = 0; i < producers.size(); ++i) {
+    std::optional<size_t> core;
+    if (!options_.generator_cores.empty()) {
+      core = options_.generator_cores[i % options_.generator_cores.size()];
+    }
+    wrapper_producers.emplace_back(std::move(producers[i]),
+                                   options_.queue_capacity, core);
+  }
+
+  return wrapper_producers;
+}
+
+template <class Workload>
+inline PipelinedWorkload<Workload>::Producer::Producer(
+    typename Workload::Producer producer, const size_t queue_capacity,
+    const std::optional<size_t> generator_core)
+    : pipeline_(std::make_unique<Pipeline>(std::move(producer), queue_capacity,
+                                           generator_core)) {}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Prepare() {
+  pipeline_->Start();
+}
+
+template <class Workload>
+inline bool PipelinedWorkload<Workload>::Producer::HasNext() const {
+  return pipeline_->HasNext();
+}
+
+template <class Workload>
+inline Request PipelinedWorkload<Workload>::Producer::Next() {
+  return pipeline_->Next();
+}
+
+template <class Workload>
+inline PipelinedWorkload<Workload>::Producer::Pipeline::Pipeline(
+    typename Workload::Producer producer, const size_t queue_capacity,
+    const std::optional<size_t> generator_core)
+    : producer_(std::move(producer)),
+      generator_core_(generator_core),
+      queue_(queue_capacity),
+      current_phase_(0),
+      ready_(false),
+      done_(false),
+      stop_(false),
+      generator_blocked_(false),
+      consumer_blocked_(false) {}
+
+template <class Workload>
+inline PipelinedWorkload<Workload>::Producer::Pipeline::~Pipeline() {
+  if (!thread_.joinable()) return;
+  // The executor may stop consuming requests early (e.g., if it encounters an
+  // error), in which case the generator thread may be waiting for space.
+  stop_.store(true, std::memory_order_relaxed);
+  WakeUp(&generator_blocked_);
+  thread_.join();
+}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Pipeline::Start() {
+  // Producers are not supposed to be prepared more than once.
+  assert(!thread_.joinable());
+  thread_ = std::thread(&Pipeline::GeneratorMain, this);
+  impl::SpinWait wait;
+  while (!ready_.load(std::memory_order_acquire)) {
+    wait.Wait();
+  }
+  // Surface errors in the wrapped producer's `Prepare()` right away.
+  if (done_.load(std::memory_order_acquire) && error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+}
+
+template <class Workload>
+inline bool PipelinedWorkload<Workload>::Producer::Pipeline::HasNext() {
+  if (!queue_.Empty()) return true;
+  impl::SpinWait wait;
+  while (true) {
+    // `done_` must be read before the queue is checked. Otherwise the generator
+    // could push its last requests (and finish) in between the two checks.
+    const bool done = done_.load(std::memory_order_acquire);
+    if (!queue_.Empty()) return true;
+    if (done) {
+      if (error_ != nullptr) std::rethrow_exception(error_);
+      return false;
+    }
+    if (!wait.TrySpin()) WaitForRequests();
+  }
+}
+
+template <class Workload>
+inline Request PipelinedWorkload<Workload>::Producer::Pipeline::Next() {
+  QueueEntry entry;
+  if (!queue_.TryPop(&entry)) {
+    // Wait for the generator thread.
+    const bool has_next = HasNext();
+    assert(has_next);
+    (void)has_next;
+    queue_.TryPop(&entry);
+  }
+  if (generator_blocked_.load(std::memory_order_relaxed) &&
+      queue_.Size() <= queue_.capacity() / 2) {
+    WakeUp(&generator_blocked_);
+  }
+  if constexpr (kReportsPhase) {
+    current_phase_ = entry.phase;
+    return entry.request;
+  } else {
+    return entry;
+  }
+}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Pipeline::GeneratorMain() {
+  try {
+    if (generator_core_.has_value()) {
+      impl::PinToCore(*generator_core_);
+    }
+    producer_.Prepare();
+    while (producer_.HasNext()) {
+      QueueEntry entry;
+      if constexpr (kReportsPhase) {
+        entry.request = producer_.Next();
+        entry.phase = producer_.CurrentPhase();
+      } else {
+        entry = producer_.Next();
+      }
+      impl::SpinWait wait;
+      while (!queue_.TryPush(entry)) {
+        ready_.store(true, std::memory_order_release);
+        if (stop_.load(std::memory_order_relaxed)) return;
+        if (!wait.TrySpin()) WaitForSpace();
+      }
+      if (consumer_blocked_.load(std::memory_order_relaxed)) {
+        WakeUp(&consumer_blocked_);
+      }
+    }
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+  done_.store(true, std::memory_order_release);
+  ready_.store(true, std::memory_order_release);
+  WakeUp(&consumer_blocked_);
+}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Pipeline::WaitForSpace() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  generator_blocked_.store(true, std::memory_order_relaxed);
+  // The consumer may have blocked before the queue filled up.
+  if (consumer_blocked_.load(std::memory_order_relaxed)) {
+    consumer_blocked_.store(false, std::memory_order_relaxed);
+    cv_.notify_all();
+  }
+  // The queue is checked after `generator_blocked_` is set. If the consumer
+  // misses the flag while popping, it sees it on one of its next pops (the
+  // queue is full, so there are more requests for it to pop).
+  if (!queue_.Full()) {
+    generator_blocked_.store(false, std::memory_order_relaxed);
+    return;
+  }
+  cv_.wait(lock, [this]() {
+    return !generator_blocked_.load(std::memory_order_relaxed) ||
+           stop_.load(std::memory_order_relaxed);
+  });
+  generator_blocked_.store(false, std::memory_order_relaxed);
+}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Pipeline::WaitForRequests() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  consumer_blocked_.store(true, std::memory_order_relaxed);
+  // The generator may have blocked before the queue drained.
+  if (generator_blocked_.load(std::memory_order_relaxed)) {
+    generator_blocked_.store(false, std::memory_order_relaxed);
+    cv_.notify_all();
+  }
+  if (!queue_.Empty() || done_.load(std::memory_order_acquire)) {
+    consumer_blocked_.store(false, std::memory_order_relaxed);
+    return;
+  }
+  cv_.wait(lock, [this]() {
+    return !consumer_blocked_.load(std::memory_order_relaxed);
+  });
+}
+
+template <class Workload>
+inline void PipelinedWorkload<Workload>::Producer::Pipeline::WakeUp(
+    std::atomic<bool>* blocked) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocked->store(false, std::memory_order_relaxed);
+  }
+  cv_.notify_all();
+}
+
+}  // namespace ycsbr
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <atomic>
+
+namespace ycsbr {
+namespace impl {
+
+// The stages of a run with a warm-up, a cool-down, and/or a deadline (see
+// `RunOptions::run_duration`).
+enum class RunStage { kWarmup, kMeasure, kCooldown, kStop };
+
+// Holds the current stage of a run. The session's main thread advances the
+// stage and the executors poll it between requests. It is on its own cache
+// line, since the executors read it often and it is rarely written.
+class alignas(64) RunStageControl {
+ public:
+  explicit RunStageControl(RunStage stage) : stage_(stage) {}
+
+  RunStage Get() const { return stage_.load(std::memory_order_relaxed); }
+  void Set(RunStage stage) { stage_.store(stage, std::memory_order_relaxed); }
+
+ private:
+  std::atomic<RunStage> stage_;
+};
+
+}  // namespace impl
+}  // namespace ycsbr
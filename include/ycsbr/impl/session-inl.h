@@ -1,12 +1,22 @@
 #include <cassert>
 #include <chrono>
+#include <exception>
+#include <future>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <thread>
+#include <type_traits>
 
 #include "../meter.h"
 #include "../trace_workload.h"
+#include "async_executor.h"
+#include "clock.h"
+#include "db_traits.h"
 #include "executor.h"
+#include "live_metrics.h"
+#include "numa.h"
+#include "run_stage.h"
 
 namespace ycsbr {
 
@@ -31,12 +41,22 @@ inline Session<DatabaseInterface>::Session(size_t num_threads,
                            db_.ShutdownWorker(std::this_thread::get_id());
                          }))),
       num_threads_(num_threads),
-      initialized_(false) {
+      initialized_(false),
+      numa_aware_(false) {
   if (num_threads == 0) {
     throw std::invalid_argument("Must use at least 1 thread.");
   }
 }
 
+template <class DatabaseInterface>
+inline Session<DatabaseInterface>::Session(const size_t num_threads,
+                                           const ThreadPlacement placement)
+    : Session(num_threads, placement == ThreadPlacement::kNumaAware
+                               ? impl::NumaTopology::Get().CoreMap(num_threads)
+                               : std::vector<size_t>()) {
+  numa_aware_ = placement == ThreadPlacement::kNumaAware;
+}
+
 template <class DatabaseInterface>
 inline Session<DatabaseInterface>::~Session() {
   Terminate();
@@ -99,21 +119,71 @@ template <class DatabaseInterface>
 template <class CustomWorkload>
 inline BenchmarkResult Session<DatabaseInterface>::RunWorkload(
     const CustomWorkload& workload, const RunOptions& options) {
-  using Runner =
-      impl::Executor<DatabaseInterface, typename CustomWorkload::Producer>;
+#ifdef YCSBR_HAS_TSC_CLOCK
+  if (options.use_cycle_counter && impl::TscClock::IsSupported()) {
+    return RunWorkloadImpl<CustomWorkload, impl::TscClock>(workload, options);
+  }
+#endif
+  return RunWorkloadImpl<CustomWorkload, impl::SteadyClock>(workload, options);
+}
+
+template <class DatabaseInterface>
+template <class CustomWorkload, typename Clock>
+inline BenchmarkResult Session<DatabaseInterface>::RunWorkloadImpl(
+    const CustomWorkload& workload, const RunOptions& options) {
+  // Databases that implement the asynchronous interface are run using the
+  // asynchronous executor.
+  constexpr bool kUseAsync = impl::SupportsAsync<DatabaseInterface>::value;
+  using Runner = std::conditional_t<
+      kUseAsync,
+      impl::AsyncExecutor<DatabaseInterface,
+                          typename CustomWorkload::Producer, Clock>,
+      impl::Executor<DatabaseInterface, typename CustomWorkload::Producer,
+                     Clock>>;
+  if (kUseAsync && options.target_requests_per_second_per_worker > 0.0) {
+    throw std::invalid_argument(
+        "Open-loop mode is not supported with asynchronous databases.");
+  }
+
+  if (options.cooldown.count() > 0 && options.run_duration.count() == 0) {
+    throw std::invalid_argument("A cool-down requires a run duration.");
+  }
+  if (options.run_duration.count() > 0 &&
+      options.warmup + options.cooldown >= options.run_duration) {
+    throw std::invalid_argument(
+        "The warm-up and cool-down must be shorter than the run duration.");
+  }
 
   auto producers = workload.GetProducers(num_threads_);
   assert(producers.size() == num_threads_);
 
+  // Created before the executors start, since it may fail to create its
+  // output file.
+  std::optional<impl::LiveMetricsMonitor> monitor;
+  if (options.live_metrics_period.count() > 0) {
+    monitor.emplace(options, producers.size(), Clock::NanosPerTick());
+  }
+
   impl::Flag can_start;
   std::vector<std::unique_ptr<Runner>> executors;
   executors.reserve(num_threads_);
 
-  size_t executor_id = 0;
-  for (auto& producer : producers) {
-    executors.push_back(std::make_unique<Runner>(
-        &db_, std::move(producer), executor_id++, &can_start, options));
-    threads_->SubmitNoWait([exec = executors.back().get()]() { (*exec)(); });
+  if (numa_aware_) {
+    StartExecutorsOnWorkers(std::move(producers), &can_start, options,
+                            &executors);
+  } else {
+    try {
+      size_t executor_id = 0;
+      for (auto& producer : producers) {
+        executors.push_back(std::make_unique<Runner>(
+            &db_, std::move(producer), executor_id++, &can_start, options));
+        threads_->SubmitNoWait(
+            [exec = executors.back().get()]() { (*exec)(); });
+      }
+    } catch (...) {
+      AbortExecutors(executors, &can_start);
+      throw;
+    }
   }
 
   // Wait for the executors to finish performing their startup work.
@@ -121,13 +191,70 @@ inline BenchmarkResult Session<DatabaseInterface>::RunWorkload(
     executor->WaitForReady();
   }
 
+  if (monitor.has_value()) {
+    for (size_t i = 0; i < executors.size(); ++i) {
+      executors[i]->SetLiveCounters(monitor->counters(i));
+    }
+    monitor->Start();
+  }
+
+  // Only needed if the run has a warm-up, a cool-down, or a deadline.
+  std::optional<impl::RunStageControl> stage;
+  if (options.warmup.count() > 0 || options.run_duration.count() > 0) {
+    stage.emplace(options.warmup.count() > 0 ? impl::RunStage::kWarmup
+                                             : impl::RunStage::kMeasure);
+    for (auto& executor : executors) {
+      executor->SetRunStage(&*stage);
+    }
+  }
+
   // Start the workload and the timer.
   const auto start = std::chrono::steady_clock::now();
   can_start.Raise();
+
+  // The measured part of the run. If the run has stages, the main thread
+  // advances them at their scheduled times (unless the executors finish
+  // first).
+  std::optional<std::chrono::steady_clock::time_point> measure_start = start;
+  std::optional<std::chrono::steady_clock::time_point> measure_end;
+  if (stage.has_value()) {
+    const auto wait_until = [&executors](const auto deadline) {
+      for (auto& executor : executors) {
+        if (!executor->WaitForCompletionUntil(deadline)) return false;
+      }
+      return true;
+    };
+    bool done = false;
+    if (options.warmup.count() > 0) {
+      measure_start.reset();
+      done = wait_until(start + options.warmup);
+      if (!done) {
+        measure_start = std::chrono::steady_clock::now();
+        stage->Set(impl::RunStage::kMeasure);
+      }
+    }
+    if (!done && options.run_duration.count() > 0) {
+      const auto deadline = start + options.run_duration;
+      if (options.cooldown.count() > 0) {
+        done = wait_until(deadline - options.cooldown);
+        if (!done) {
+          measure_end = std::chrono::steady_clock::now();
+          stage->Set(impl::RunStage::kCooldown);
+        }
+      }
+      if (!done) {
+        wait_until(deadline);
+        stage->Set(impl::RunStage::kStop);
+      }
+    }
+  }
   for (auto& executor : executors) {
     executor->WaitForCompletion();
   }
   const auto end = std::chrono::steady_clock::now();
+  if (monitor.has_value()) {
+    monitor->Stop();
+  }
 
   // Retrieve the results.
   std::vector<impl::MetricsTracker> results;
@@ -136,7 +263,76 @@ inline BenchmarkResult Session<DatabaseInterface>::RunWorkload(
     results.emplace_back(std::move(*executor).GetResults());
   }
 
-  return impl::MetricsTracker::FinalizeGroup(end - start, std::move(results));
+  // Nothing is measured if the executors finish during the warm-up.
+  const auto run_time = measure_start.has_value()
+                            ? measure_end.value_or(end) - *measure_start
+                            : std::chrono::steady_clock::duration(0);
+  return impl::MetricsTracker::FinalizeGroup(run_time, std::move(results));
+}
+
+template <class DatabaseInterface>
+template <class Runner, class Producer>
+inline void Session<DatabaseInterface>::StartExecutorsOnWorkers(
+    std::vector<Producer> producers, impl::Flag* can_start,
+    const RunOptions& options,
+    std::vector<std::unique_ptr<Runner>>* executors) {
+  // Each executor blocks until `can_start` is raised, so every executor runs
+  // on a different worker thread.
+  const size_t num_executors = producers.size();
+  executors->resize(num_executors);
+  std::vector<std::promise<void>> constructed(num_executors);
+  std::exception_ptr error;
+  size_t num_submitted = 0;
+  try {
+    for (; num_submitted < num_executors; ++num_submitted) {
+      const size_t id = num_submitted;
+      threads_->SubmitNoWait([this, id, can_start, &options, executors,
+                              &constructed,
+                              producer = std::move(producers[id])]() mutable {
+        Runner* executor = nullptr;
+        try {
+          (*executors)[id] = std::make_unique<Runner>(
+              &db_, std::move(producer), id, can_start, options);
+          executor = (*executors)[id].get();
+        } catch (...) {
+          constructed[id].set_exception(std::current_exception());
+          return;
+        }
+        constructed[id].set_value();
+        (*executor)();
+      });
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  // The submitted tasks refer to `constructed`, so wait for all of them.
+  for (size_t id = 0; id < num_submitted; ++id) {
+    try {
+      constructed[id].get_future().get();
+    } catch (...) {
+      if (error == nullptr) error = std::current_exception();
+    }
+  }
+  if (error == nullptr) return;
+  AbortExecutors(*executors, can_start);
+  std::rethrow_exception(error);
+}
+
+template <class DatabaseInterface>
+template <class Runner>
+inline void Session<DatabaseInterface>::AbortExecutors(
+    const std::vector<std::unique_ptr<Runner>>& executors,
+    impl::Flag* can_start) {
+  // The executors check the run stage before each request.
+  impl::RunStageControl stop(impl::RunStage::kStop);
+  for (const auto& executor : executors) {
+    if (executor != nullptr) executor->SetRunStage(&stop);
+  }
+  can_start->Raise();
+  for (const auto& executor : executors) {
+    if (executor != nullptr) executor->WaitForCompletion();
+  }
 }
 
 }  // namespace ycsbr
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace ycsbr {
+namespace impl {
+
+// A bounded lock-free single-producer single-consumer queue (a ring buffer).
+// Exactly one thread may call `TryPush()` and exactly one (other) thread may
+// call `TryPop()`.
+//
+// The producer and consumer indices are kept on separate cache lines. Each
+// side also caches the last value it read of the other side's index, so the
+// shared cache lines are only read when the queue looks full (or empty).
+template <typename T>
+class SPSCQueue {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit SPSCQueue(size_t capacity);
+
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Returns false if the queue is full.
+  bool TryPush(T item);
+  // Returns false if the queue is empty.
+  bool TryPop(T* item);
+
+  // Only meaningful when called by the consumer.
+  bool Empty() const;
+  size_t Size() const;
+  // Only meaningful when called by the producer.
+  bool Full() const;
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+  static size_t RoundUpToPowerOfTwo(size_t value);
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) std::atomic<size_t> head_;
+  size_t cached_tail_;
+
+  // Written by the producer.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_;
+  size_t cached_head_;
+};
+
+// Used when waiting on a `SPSCQueue`. Spins briefly and then yields the
+// processor (the other side may be running on the same core).
+class SpinWait {
+ public:
+  SpinWait() : spins_(0) {}
+  void Wait() {
+    if (!TrySpin()) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Spins briefly and returns true, unless the spin budget is used up (the
+  // caller should then block instead).
+  bool TrySpin() {
+    if (spins_ >= kMaxSpins) return false;
+    ++spins_;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+    return true;
+  }
+
+ private:
+  static constexpr size_t kMaxSpins = 64;
+  size_t spins_;
+};
+
+// Implementation details follow.
+
+template <typename T>
+inline size_t SPSCQueue<T>::RoundUpToPowerOfTwo(const size_t value) {
+  size_t result = 1;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+template <typename T>
+inline SPSCQueue<T>::SPSCQueue(const size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity == 0 ? 1 : capacity) - 1),
+      slots_(new T[mask_ + 1]),
+      head_(0),
+      cached_tail_(0),
+      tail_(0),
+      cached_head_(0) {}
+
+template <typename T>
+inline bool SPSCQueue<T>::TryPush(T item) {
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - cached_head_ > mask_) {
+    cached_head_ = head_.load(std::memory_order_acquire);
+    if (tail - cached_head_ > mask_) return false;
+  }
+  slots_[tail & mask_] = std::move(item);
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::TryPop(T* item) {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head == cached_tail_) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head == cached_tail_) return false;
+  }
+  *item = std::move(slots_[head & mask_]);
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::Empty() const {
+  return head_.load(std::memory_order_relaxed) ==
+         tail_.load(std::memory_order_acquire);
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::Size() const {
+  return tail_.load(std::memory_order_acquire) -
+         head_.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::Full() const {
+  return tail_.load(std::memory_order_relaxed) -
+             head_.load(std::memory_order_acquire) >
+         mask_;
+}
+
+}  // namespace impl
+}  // namespace ycsbr
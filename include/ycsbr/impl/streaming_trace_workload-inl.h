@@ -0,0 +1,440 @@
+// Implementation of declarations in streaming_trace_workload.h. Do not include
+// this header!
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "mapped_file.h"
+#include "util.h"
+
+namespace ycsbr {
+
+// Reads and decodes a producer's slice of the trace on a background thread.
+class StreamingTraceWorkload::Reader {
+ public:
+  Reader(const StreamingTraceWorkload* workload, size_t start_index,
+         size_t num_requests);
+  ~Reader();
+
+  // Returns the next block of decoded requests. Calling this method releases
+  // the block returned by the previous call (so it can be refilled).
+  const std::vector<Request>& Acquire();
+
+ private:
+  static constexpr size_t kReadSize = 1ULL << 20;
+
+  void ReaderMain();
+  void AssignValues(std::vector<Request>* block);
+  // Returns the number of bytes read (0 at the end of the file).
+  size_t ReadAt(size_t offset, char* dest, size_t size);
+
+  // Returns the number of writes (see `impl::IsTraceWrite()`) in `block`,
+  // up to (but excluding) `end`.
+  static size_t CountWrites(const std::vector<Request>& block, size_t end);
+
+  // Used for legacy traces.
+  void SkipToStartLegacy();
+  // Decodes requests from `raw_` until `block` has `limit` requests or `raw_`
+  // has no more complete requests.
+  void DecodeLegacy(std::vector<Request>* block, size_t limit);
+  // Reads more of the file into `raw_`. Throws if the file ends prematurely.
+  void Refill();
+
+  // Used for v3 traces.
+  void DecodeV3(std::vector<Request>* block, size_t limit);
+  // Reads and decodes the next block of the file into `staged_`.
+  void LoadV3Block();
+  // Positions the reader at `start_index_`.
+  void SkipToStartV3();
+
+  const StreamingTraceWorkload* workload_;
+  size_t start_index_;
+  size_t num_requests_;
+  int fd_;
+
+  // Only used by the reader thread.
+  std::vector<char> raw_;
+  size_t raw_begin_, raw_end_;
+  size_t file_offset_;
+  // The number of writes that precede the next request (writes are assigned
+  // values in trace order, as in `Trace::ProcessRawTrace()`).
+  size_t value_index_;
+  std::vector<Request> staged_;
+  size_t staged_index_;
+  size_t next_v3_block_;
+
+  // Protected by `mutex_`. `blocks_[i % 2]` holds the `i`-th block.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Request> blocks_[2];
+  size_t blocks_written_;
+  size_t blocks_released_;
+  bool acquired_;
+  bool stop_;
+  std::exception_ptr error_;
+
+  std::thread thread_;
+};
+
+inline StreamingTraceWorkload::StreamingTraceWorkload(
+    std::string file, const Trace::Options& options,
+    const size_t requests_per_block)
+    : file_(std::move(file)),
+      options_(options),
+      requests_per_block_(requests_per_block),
+      num_requests_(0),
+      is_v3_(false) {
+  if (options_.value_size < 4) {
+    throw std::invalid_argument("Options::value_size must be at least 4.");
+  }
+  if (options_.sort_requests) {
+    throw std::invalid_argument(
+        "StreamingTraceWorkload does not support sorting requests.");
+  }
+  if (requests_per_block_ == 0) {
+    throw std::invalid_argument("The block size must be positive.");
+  }
+  {
+    const impl::MappedFile mapped(file_);
+    if (impl::IsTraceV3(mapped.data(), mapped.size())) {
+      // Only the header and block index need to be read.
+      is_v3_ = true;
+      v3_index_ = impl::ReadTraceV3Index(mapped.data(), mapped.size());
+      num_requests_ = v3_index_.header.num_requests;
+    } else {
+      mapped.AdviseSequential();
+      num_requests_ =
+          impl::FindChunkOffsets(mapped.data(), mapped.size(), &checkpoints_,
+                                 &checkpoint_writes_);
+    }
+  }
+  std::mt19937 rng(options_.rng_seed);
+  values_ = impl::GetRandomBytes(kNumUniqueValues * options_.value_size, rng);
+}
+
+inline std::vector<StreamingTraceWorkload::Producer>
+StreamingTraceWorkload::GetProducers(const size_t num_producers) const {
+  std::vector<Producer> producers;
+  producers.reserve(num_producers);
+
+  // Split up the requests.
+  const size_t min_requests_per_producer = num_requests_ / num_producers;
+  size_t leftover_requests = num_requests_ % num_producers;
+  size_t next_offset = 0;
+  for (size_t producer_id = 0; producer_id < num_producers; ++producer_id) {
+    size_t num_requests = min_requests_per_producer;
+    if (leftover_requests > 0) {
+      ++num_requests;
+      --leftover_requests;
+    }
+    producers.push_back(Producer(this, next_offset, num_requests));
+    next_offset += num_requests;
+  }
+
+  return producers;
+}
+
+inline StreamingTraceWorkload::Producer::Producer(
+    const StreamingTraceWorkload* workload, const size_t start_index,
+    const size_t num_requests)
+    : workload_(workload),
+      start_index_(start_index),
+      num_requests_(num_requests),
+      remaining_(num_requests),
+      block_(nullptr),
+      block_size_(0),
+      block_index_(0) {}
+
+inline StreamingTraceWorkload::Producer::Producer(Producer&&) noexcept =
+    default;
+
+inline StreamingTraceWorkload::Producer&
+StreamingTraceWorkload::Producer::operator=(Producer&&) noexcept = default;
+
+inline StreamingTraceWorkload::Producer::~Producer() = default;
+
+inline void StreamingTraceWorkload::Producer::Prepare() {
+  if (num_requests_ == 0) return;
+  reader_ = std::make_unique<Reader>(workload_, start_index_, num_requests_);
+  // Waiting for the first block keeps the reader's startup (e.g., counting
+  // the writes that precede this producer's slice) out of the measured run.
+  NextBlock();
+}
+
+inline Request StreamingTraceWorkload::Producer::Next() {
+  if (block_index_ == block_size_) {
+    NextBlock();
+  }
+  --remaining_;
+  return block_[block_index_++];
+}
+
+inline void StreamingTraceWorkload::Producer::NextBlock() {
+  const std::vector<Request>& block = reader_->Acquire();
+  block_ = block.data();
+  block_size_ = block.size();
+  block_index_ = 0;
+}
+
+inline StreamingTraceWorkload::Reader::Reader(
+    const StreamingTraceWorkload* workload, const size_t start_index,
+    const size_t num_requests)
+    : workload_(workload),
+      start_index_(start_index),
+      num_requests_(num_requests),
+      fd_(-1),
+      raw_(kReadSize),
+      raw_begin_(0),
+      raw_end_(0),
+      file_offset_(0),
+      value_index_(0),
+      staged_index_(0),
+      next_v3_block_(0),
+      blocks_written_(0),
+      blocks_released_(0),
+      acquired_(false),
+      stop_(false) {
+  fd_ = open(workload_->file_.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to open file: " + workload_->file_ +
+                             " (" + std::strerror(errno) + ")");
+  }
+  for (auto& block : blocks_) {
+    block.reserve(workload_->requests_per_block_);
+  }
+  thread_ = std::thread(&Reader::ReaderMain, this);
+}
+
+inline StreamingTraceWorkload::Reader::~Reader() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  close(fd_);
+}
+
+inline const std::vector<Request>& StreamingTraceWorkload::Reader::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (acquired_) {
+    ++blocks_released_;
+    acquired_ = false;
+    cv_.notify_all();
+  }
+  cv_.wait(lock, [this]() {
+    return blocks_written_ > blocks_released_ || error_ != nullptr;
+  });
+  if (blocks_written_ == blocks_released_) {
+    std::rethrow_exception(error_);
+  }
+  acquired_ = true;
+  return blocks_[blocks_released_ % 2];
+}
+
+inline void StreamingTraceWorkload::Reader::ReaderMain() {
+  try {
+    if (workload_->is_v3_) {
+      SkipToStartV3();
+    } else {
+      SkipToStartLegacy();
+    }
+
+    size_t left = num_requests_;
+    while (left > 0) {
+      std::vector<Request>* block = nullptr;
+      {
+        // Wait until a block is free. The consumer holds at most one block.
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() {
+          return stop_ || blocks_written_ - blocks_released_ < 2;
+        });
+        if (stop_) return;
+        block = &blocks_[blocks_written_ % 2];
+      }
+      block->clear();
+      const size_t to_decode =
+          std::min(left, workload_->requests_per_block_);
+      if (workload_->is_v3_) {
+        DecodeV3(block, to_decode);
+      } else {
+        while (block->size() < to_decode) {
+          DecodeLegacy(block, to_decode);
+          if (block->size() < to_decode) Refill();
+        }
+      }
+      AssignValues(block);
+      left -= to_decode;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++blocks_written_;
+      }
+      cv_.notify_all();
+    }
+  } catch (...) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+    cv_.notify_all();
+  }
+}
+
+inline size_t StreamingTraceWorkload::Reader::CountWrites(
+    const std::vector<Request>& block, const size_t end) {
+  size_t num_writes = 0;
+  for (size_t i = 0; i < end; ++i) {
+    num_writes += impl::IsTraceWrite(block[i].op);
+  }
+  return num_writes;
+}
+
+inline void StreamingTraceWorkload::Reader::SkipToStartV3() {
+  // Start reading from the block that holds the first request. The block
+  // index records the number of writes that precede each block, so the
+  // preceding blocks are not read.
+  const impl::TraceV3Index& index = workload_->v3_index_;
+  const size_t requests_per_block = index.header.requests_per_block;
+  next_v3_block_ = start_index_ / requests_per_block;
+  value_index_ = index.block_writes[next_v3_block_];
+  LoadV3Block();
+  staged_index_ = start_index_ % requests_per_block;
+  value_index_ += CountWrites(staged_, staged_index_);
+}
+
+inline void StreamingTraceWorkload::Reader::SkipToStartLegacy() {
+  // Start reading from the closest preceding checkpoint.
+  const size_t chunk = start_index_ / impl::kTraceRecordsPerChunk;
+  file_offset_ = workload_->checkpoints_[chunk];
+  value_index_ = workload_->checkpoint_writes_[chunk];
+  size_t to_skip = start_index_ % impl::kTraceRecordsPerChunk;
+  while (to_skip > 0) {
+    if (raw_end_ - raw_begin_ < sizeof(Request::Encoded)) {
+      Refill();
+      continue;
+    }
+    const size_t request_size = impl::EncodedRequestSize(&raw_[raw_begin_]);
+    if (raw_end_ - raw_begin_ < request_size) {
+      Refill();
+      continue;
+    }
+    Request::Operation op;
+    memcpy(&op, &raw_[raw_begin_], sizeof(op));
+    value_index_ += impl::IsTraceWrite(op);
+    raw_begin_ += request_size;
+    --to_skip;
+  }
+}
+
+inline void StreamingTraceWorkload::Reader::DecodeLegacy(
+    std::vector<Request>* block, const size_t limit) {
+  const Trace::Options& options = workload_->options_;
+  const bool swap_key_bytes =
+      options.use_v1_semantics && options.swap_key_bytes;
+  while (block->size() < limit &&
+         raw_end_ - raw_begin_ >= sizeof(Request::Encoded)) {
+    const char* data = &raw_[raw_begin_];
+    const size_t request_size = impl::EncodedRequestSize(data);
+    if (raw_end_ - raw_begin_ < request_size) break;
+    Request req;
+    impl::DecodeRequests(data, 1, swap_key_bytes, &req);
+    block->push_back(req);
+    raw_begin_ += request_size;
+  }
+}
+
+inline void StreamingTraceWorkload::Reader::DecodeV3(
+    std::vector<Request>* block, const size_t limit) {
+  while (block->size() < limit) {
+    if (staged_index_ == staged_.size()) {
+      LoadV3Block();
+    }
+    const size_t count =
+        std::min(limit - block->size(), staged_.size() - staged_index_);
+    block->insert(block->end(), staged_.begin() + staged_index_,
+                  staged_.begin() + staged_index_ + count);
+    staged_index_ += count;
+  }
+}
+
+inline void StreamingTraceWorkload::Reader::LoadV3Block() {
+  const impl::TraceV3Index& index = workload_->v3_index_;
+  const size_t block = next_v3_block_++;
+  if (block >= index.block_offsets.size()) {
+    throw std::runtime_error("Trace file ended unexpectedly: " +
+                             workload_->file_);
+  }
+  const size_t begin = index.BlockBegin(block);
+  const size_t size = index.BlockEnd(block) - begin;
+  if (raw_.size() < size) {
+    raw_.resize(size);
+  }
+  size_t bytes_read = 0;
+  while (bytes_read < size) {
+    const size_t read =
+        ReadAt(begin + bytes_read, raw_.data() + bytes_read, size - bytes_read);
+    if (read == 0) {
+      throw std::runtime_error("Trace file ended unexpectedly: " +
+                               workload_->file_);
+    }
+    bytes_read += read;
+  }
+  const Trace::Options& options = workload_->options_;
+  staged_.resize(index.BlockSize(block));
+  impl::DecodeTraceV3Block(raw_.data(), raw_.data() + size, staged_.size(),
+                           options.use_v1_semantics && options.swap_key_bytes,
+                           staged_.data());
+  staged_index_ = 0;
+}
+
+inline void StreamingTraceWorkload::Reader::AssignValues(
+    std::vector<Request>* block) {
+  const size_t value_size = workload_->options_.value_size;
+  for (auto& req : *block) {
+    if (impl::IsTraceWrite(req.op)) {
+      req.value =
+          &workload_->values_[(value_index_ % kNumUniqueValues) * value_size];
+      req.value_size = value_size;
+      ++value_index_;
+    }
+  }
+}
+
+inline void StreamingTraceWorkload::Reader::Refill() {
+  // Move any partial request to the front of the buffer.
+  const size_t leftover = raw_end_ - raw_begin_;
+  memmove(raw_.data(), raw_.data() + raw_begin_, leftover);
+  raw_begin_ = 0;
+  raw_end_ = leftover;
+
+  const size_t bytes_read =
+      ReadAt(file_offset_, raw_.data() + raw_end_, raw_.size() - raw_end_);
+  if (bytes_read == 0) {
+    throw std::runtime_error("Trace file ended unexpectedly: " +
+                             workload_->file_);
+  }
+  raw_end_ += bytes_read;
+  file_offset_ += bytes_read;
+}
+
+inline size_t StreamingTraceWorkload::Reader::ReadAt(const size_t offset,
+                                                     char* dest,
+                                                     const size_t size) {
+  ssize_t bytes_read = 0;
+  do {
+    bytes_read = pread(fd_, dest, size, offset);
+  } while (bytes_read < 0 && errno == EINTR);
+  if (bytes_read < 0) {
+    throw std::runtime_error("Failed to read file: " + workload_->file_ +
+                             " (" + std::strerror(errno) + ")");
+  }
+  return static_cast<size_t>(bytes_read);
+}
+
+}  // namespace ycsbr
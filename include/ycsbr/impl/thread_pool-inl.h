@@ -9,10 +9,16 @@ inline ThreadPool::ThreadPool(size_t num_threads,
                               std::function<void()> on_start,
                               std::function<void()> on_shutdown)
     : shutdown_(false),
+      injection_queue_size_(0),
+      pending_(0),
+      sleepers_(0),
       on_start_(std::move(on_start)),
       on_shutdown_(std::move(on_shutdown)) {
   for (size_t i = 0; i < num_threads; ++i) {
-    threads_.emplace_back(&ThreadPool::ThreadMain, this);
+    workers_.push_back(std::make_unique<Worker>(this, i));
+  }
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::ThreadMain, this, workers_[i].get());
   }
 }
 
@@ -21,12 +27,18 @@ inline ThreadPool::ThreadPool(size_t num_threads,
                               std::function<void()> on_start,
                               std::function<void()> on_shutdown)
     : shutdown_(false),
+      injection_queue_size_(0),
+      pending_(0),
+      sleepers_(0),
       on_start_(std::move(on_start)),
       on_shutdown_(std::move(on_shutdown)) {
   assert(num_threads == thread_to_core.size());
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this, i));
+  }
   for (size_t i = 0; i < num_threads; ++i) {
     threads_.emplace_back(&ThreadPool::ThreadMainOnCore, this,
-                          thread_to_core[i]);
+                          workers_[i].get(), thread_to_core[i]);
   }
 }
 
@@ -41,30 +53,170 @@ inline ThreadPool::~ThreadPool() {
   }
 }
 
-inline void ThreadPool::ThreadMainOnCore(size_t core_id) {
+inline ThreadPool::Worker*& ThreadPool::CurrentWorker() {
+  thread_local Worker* worker = nullptr;
+  return worker;
+}
+
+inline void ThreadPool::Schedule(Task task) {
+  Worker* worker = CurrentWorker();
+  if (worker == nullptr || worker->pool != this ||
+      !worker->deque.Push(task)) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    injection_queue_.push_back(std::move(task));
+    injection_queue_size_.store(injection_queue_.size());
+  }
+  pending_.fetch_add(1);
+  // A sleeping worker increments `sleepers_` before checking `pending_` (both
+  // sequentially consistent), so either it sees this task or we see it.
+  if (sleepers_.load() > 0) {
+    // Acquiring the mutex ensures the worker is actually waiting on `cv_`.
+    { std::unique_lock<std::mutex> lock(mutex_); }
+    cv_.notify_one();
+  }
+}
+
+inline bool ThreadPool::TryGetTask(Worker* worker, Task* task_out) {
+  // 1. Our own deque (most recently pushed task first).
+  if (worker->deque.Pop(task_out)) return true;
+
+  // 2. Tasks submitted from outside the pool (in submission order). The size
+  // is updated before `pending_`, so a worker that sees a pending injected
+  // task also sees a non-zero size.
+  if (injection_queue_size_.load() > 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!injection_queue_.empty()) {
+      *task_out = std::move(injection_queue_.front());
+      injection_queue_.pop_front();
+      injection_queue_size_.store(injection_queue_.size());
+      return true;
+    }
+  }
+
+  // 3. Steal from the other workers.
+  const size_t num_workers = workers_.size();
+  for (size_t i = 1; i < num_workers; ++i) {
+    Worker* victim = workers_[(worker->id + i) % num_workers].get();
+    if (victim->deque.Steal(task_out)) return true;
+  }
+  return false;
+}
+
+inline void ThreadPool::ThreadMainOnCore(Worker* worker, size_t core_id) {
   PinToCore(core_id);
-  ThreadMain();
+  ThreadMain(worker);
 }
 
-inline void ThreadPool::ThreadMain() {
+inline void ThreadPool::ThreadMain(Worker* worker) {
   on_start_();
-  std::unique_ptr<Task> next_job = nullptr;
+  CurrentWorker() = worker;
+  Task next_job;
   while (true) {
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      // Need a loop here to handle spurious wakeup
-      while (!shutdown_ && work_queue_.empty()) {
-        cv_.wait(lock);
-      }
-      if (shutdown_ && work_queue_.empty()) break;
-      next_job.reset(work_queue_.front().release());
-      work_queue_.pop();
+    if (TryGetTask(worker, &next_job)) {
+      pending_.fetch_sub(1);
+      next_job();
+      next_job = Task();
+      continue;
+    }
+
+    if (pending_.load() > 0) {
+      // A task is scheduled but we could not get it (e.g., we lost a race
+      // with another thief). Try again.
+      std::this_thread::yield();
+      continue;
     }
-    (*next_job)();
-    next_job.reset(nullptr);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Tasks may have been scheduled since we checked `pending_`. If so, the
+    // wait below returns immediately.
+    if (shutdown_ && pending_.load() == 0) break;
+    sleepers_.fetch_add(1);
+    // Need a predicate here to handle spurious wakeup
+    cv_.wait(lock, [this]() { return shutdown_ || pending_.load() > 0; });
+    sleepers_.fetch_sub(1);
   }
+  CurrentWorker() = nullptr;
   on_shutdown_();
 }
 
+inline ThreadPool::Task::Task(Task&& other) noexcept
+    : invoke_(other.invoke_), manage_(other.manage_) {
+  if (manage_ != nullptr) {
+    other.manage_(Op::kMoveTo, &other.storage_, &storage_);
+    other.invoke_ = nullptr;
+    other.manage_ = nullptr;
+  }
+}
+
+inline ThreadPool::Task& ThreadPool::Task::operator=(Task&& other) noexcept {
+  if (this == &other) return *this;
+  Reset();
+  if (other.manage_ != nullptr) {
+    other.manage_(Op::kMoveTo, &other.storage_, &storage_);
+    invoke_ = other.invoke_;
+    manage_ = other.manage_;
+    other.invoke_ = nullptr;
+    other.manage_ = nullptr;
+  }
+  return *this;
+}
+
+inline void ThreadPool::Task::Reset() {
+  if (manage_ != nullptr) {
+    manage_(Op::kDestroy, &storage_, nullptr);
+    invoke_ = nullptr;
+    manage_ = nullptr;
+  }
+}
+
+// All deque operations use sequentially consistent atomics. This is slightly
+// more conservative than necessary, but keeps the reasoning simple.
+
+inline bool ThreadPool::Deque::Push(Task& task) {
+  const int64_t bottom = bottom_.load();
+  const int64_t top = top_.load();
+  if (bottom - top >= kCapacity) return false;
+  Slot& slot = slots_[bottom & kMask];
+  // A thief may have claimed this slot but not yet moved its task out.
+  if (slot.full.load()) return false;
+  slot.task = std::move(task);
+  slot.full.store(true);
+  bottom_.store(bottom + 1);
+  return true;
+}
+
+inline bool ThreadPool::Deque::Pop(Task* task_out) {
+  const int64_t bottom = bottom_.load() - 1;
+  bottom_.store(bottom);
+  int64_t top = top_.load();
+  if (top > bottom) {
+    // Empty.
+    bottom_.store(bottom + 1);
+    return false;
+  }
+  if (top == bottom) {
+    // Last task; race against thieves for it.
+    const bool won = top_.compare_exchange_strong(top, top + 1);
+    bottom_.store(bottom + 1);
+    if (!won) return false;
+  }
+  Slot& slot = slots_[bottom & kMask];
+  *task_out = std::move(slot.task);
+  slot.full.store(false);
+  return true;
+}
+
+inline bool ThreadPool::Deque::Steal(Task* task_out) {
+  int64_t top = top_.load();
+  const int64_t bottom = bottom_.load();
+  if (top >= bottom) return false;
+  Slot& slot = slots_[top & kMask];
+  if (!top_.compare_exchange_strong(top, top + 1)) return false;
+  // We now own the slot's task. The owner will not overwrite the slot until
+  // `full` is cleared.
+  *task_out = std::move(slot.task);
+  slot.full.store(false);
+  return true;
+}
+
 }  // namespace impl
 }  // namespace ycsbr
@@ -1,23 +1,43 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ycsbr {
 namespace impl {
 
-// A thread pool that supports thread-to-core pinning.
+// A work-stealing thread pool that supports thread-to-core pinning.
+//
+// Each worker thread owns a bounded Chase-Lev deque. Functions submitted by a
+// worker thread (e.g., when splitting up work into smaller tasks) are pushed
+// onto that worker's deque. Functions submitted from outside the pool are
+// placed in a shared "injection" queue. Idle workers first check their own
+// deque, then the injection queue, and then try to steal from other workers.
+// Submitted functions are stored inline in the task slots when they are small
+// enough, so submitting a function usually does not allocate.
 //
 // Acknowledgements: This implementation is based on other existing thread pools
 //   - https://github.com/fbastos1/thread_pool_cpp17
 //   - https://github.com/progschj/ThreadPool
 //   - https://github.com/vit-vit/CTPL
+// The deque follows "Dynamic Circular Work-Stealing Deque" (Chase and Lev,
+// SPAA'05) and "Correct and Efficient Work-Stealing for Weak Memory Models"
+// (Le et al., PPoPP'13), but uses a fixed capacity.
 class ThreadPool {
  public:
   // Create a thread pool with `num_threads` threads.
@@ -52,34 +72,121 @@ class ThreadPool {
                              bool> = true>
   void SubmitNoWait(Function&& f, Args&&... args);
 
+  size_t NumThreads() const { return workers_.size(); }
+
+  // Runs `f(i)` for each `0 <= i < num_tasks` on this pool's threads and
+  // waits for the calls to finish. Exceptions thrown by `f` are propagated to
+  // the caller. If called from one of this pool's threads, the calls run on
+  // the calling thread (waiting on the pool could otherwise deadlock).
+  template <typename Function>
+  void ParallelFor(size_t num_tasks, const Function& f);
+
  private:
+  // A type-erased, move-only function. Functions that are small enough are
+  // stored inline (avoiding a heap allocation).
   class Task {
    public:
-    virtual ~Task() = default;
-    virtual void operator()() = 0;
+    static constexpr size_t kInlineSize = 48;
+
+    Task() noexcept : invoke_(nullptr), manage_(nullptr) {}
+    template <typename Function>
+    explicit Task(Function&& f);
+    Task(Task&& other) noexcept;
+    Task& operator=(Task&& other) noexcept;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { Reset(); }
+
+    void operator()() { invoke_(&storage_); }
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+   private:
+    enum class Op { kMoveTo, kDestroy };
+    using Invoke = void (*)(void* storage);
+    using Manage = void (*)(Op op, void* storage, void* dest);
+
+    template <typename Function>
+    static constexpr bool kStoredInline =
+        sizeof(Function) <= kInlineSize &&
+        alignof(Function) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<Function>::value;
+
+    void Reset();
+
+    std::aligned_storage_t<kInlineSize, alignof(std::max_align_t)> storage_;
+    Invoke invoke_;
+    Manage manage_;
   };
 
-  template <typename Function>
-  class TaskContainer : public Task {
+  // A bounded Chase-Lev deque. Only the owning worker calls `Push()` and
+  // `Pop()`; any thread can call `Steal()`.
+  //
+  // Since tasks are stored by value, a thief first claims a slot (by advancing
+  // `top_`) and then moves the task out. Each slot has a flag that records
+  // whether it still holds a task, so the owner never overwrites a slot that a
+  // thief is still reading from (it treats the deque as full instead).
+  class Deque {
    public:
-    TaskContainer(Function&& f) : f_(std::forward<Function>(f)) {}
-    void operator()() override { f_(); }
+    static constexpr int64_t kCapacity = 256;
+
+    Deque() : top_(0), bottom_(0) {}
+
+    // Moves from `task` only if the push succeeds (i.e., returns true).
+    bool Push(Task& task);
+    bool Pop(Task* task_out);
+    bool Steal(Task* task_out);
 
    private:
-    Function f_;
+    struct Slot {
+      Slot() : full(false) {}
+      std::atomic<bool> full;
+      Task task;
+    };
+    static constexpr int64_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "Capacity must be a power of 2.");
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    Slot slots_[kCapacity];
+  };
+
+  struct Worker {
+    Worker(ThreadPool* pool, size_t id) : pool(pool), id(id) {}
+    ThreadPool* const pool;
+    const size_t id;
+    Deque deque;
   };
 
+  // The worker that the calling thread runs (if any).
+  static Worker*& CurrentWorker();
+
+  void Schedule(Task task);
+  bool TryGetTask(Worker* worker, Task* task_out);
+
   // Worker threads run this code.
-  void ThreadMain();
+  void ThreadMain(Worker* worker);
 
   // Ensures the worker thread runs `ThreadMain()` on core `core_id`.
-  void ThreadMainOnCore(size_t core_id);
+  void ThreadMainOnCore(Worker* worker, size_t core_id);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
 
+  // Protects `injection_queue_` and `shutdown_`. Also used when workers sleep.
   std::mutex mutex_;
   std::condition_variable cv_;
   bool shutdown_;
-  std::queue<std::unique_ptr<Task>> work_queue_;
-  std::vector<std::thread> threads_;
+  std::deque<Task> injection_queue_;
+  // The size of `injection_queue_` (only modified while holding `mutex_`).
+  // Idle workers check it so that they only acquire `mutex_` when the queue
+  // has a task.
+  std::atomic<size_t> injection_queue_size_;
+
+  // The number of tasks that have been scheduled but not yet taken by a
+  // worker, and the number of sleeping workers. Submitters only need to wake a
+  // worker (which requires acquiring `mutex_`) if a worker is sleeping.
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> sleepers_;
 
   // Called by each thread when it starts.
   std::function<void()> on_start_;
@@ -97,11 +204,7 @@ inline auto ThreadPool::Submit(Function&& f, Args&&... args) {
         return std::apply(std::move(runnable), std::move(task_args));
       });
   auto future = task.get_future();
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
-    work_queue_.emplace(new TaskContainer(std::move(task)));
-  }
-  cv_.notify_one();
+  Schedule(Task(std::move(task)));
   return future;
 }
 
@@ -114,11 +217,76 @@ inline void ThreadPool::SubmitNoWait(Function&& f, Args&&... args) {
                    std::make_tuple(std::forward<Args>(args)...)]() mutable {
     std::apply(std::move(runnable), std::move(task_args));
   };
-  {
-    std::unique_lock<std::mutex> lock(mutex_);
-    work_queue_.emplace(new TaskContainer(std::move(task)));
+  Schedule(Task(std::move(task)));
+}
+
+// Runs `f(i)` for each `0 <= i < num_tasks` using up to one thread per core.
+// The calls run on a process-wide pool that is created on first use, so
+// repeated calls do not start new threads. Exceptions thrown by `f` are
+// propagated to the caller.
+template <typename Function>
+inline void ParallelFor(const size_t num_tasks, const Function& f) {
+  static ThreadPool pool(std::max(1U, std::thread::hardware_concurrency()),
+                         []() {}, []() {});
+  pool.ParallelFor(num_tasks, f);
+}
+
+template <typename Function>
+inline void ThreadPool::ParallelFor(const size_t num_tasks,
+                                    const Function& f) {
+  const Worker* worker = CurrentWorker();
+  if (num_tasks <= 1 || workers_.size() <= 1 ||
+      (worker != nullptr && worker->pool == this)) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      f(i);
+    }
+    return;
+  }
+  std::vector<std::future<void>> results;
+  results.reserve(num_tasks);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    results.push_back(Submit([&f, i]() { f(i); }));
+  }
+  // Wait for every call (even if one fails), since they refer to `f`.
+  std::exception_ptr error;
+  for (auto& result : results) {
+    try {
+      result.get();
+    } catch (...) {
+      if (error == nullptr) error = std::current_exception();
+    }
+  }
+  if (error != nullptr) std::rethrow_exception(error);
+}
+
+template <typename Function>
+inline ThreadPool::Task::Task(Function&& f) {
+  using F = std::decay_t<Function>;
+  if constexpr (kStoredInline<F>) {
+    new (&storage_) F(std::forward<Function>(f));
+    invoke_ = [](void* storage) {
+      (*std::launder(static_cast<F*>(storage)))();
+    };
+    manage_ = [](Op op, void* storage, void* dest) {
+      F* fn = std::launder(static_cast<F*>(storage));
+      if (op == Op::kMoveTo) {
+        new (dest) F(std::move(*fn));
+      }
+      fn->~F();
+    };
+  } else {
+    // Too large to store inline; the storage holds a pointer instead.
+    new (&storage_) F*(new F(std::forward<Function>(f)));
+    invoke_ = [](void* storage) { (**static_cast<F**>(storage))(); };
+    manage_ = [](Op op, void* storage, void* dest) {
+      F** fn = static_cast<F**>(storage);
+      if (op == Op::kMoveTo) {
+        new (dest) F*(*fn);
+      } else {
+        delete *fn;
+      }
+    };
   }
-  cv_.notify_one();
 }
 
 }  // namespace impl
@@ -1,10 +1,12 @@
 // Implementation of declarations in ycsbr/trace.h. Do not include this header!
 #include <algorithm>
 #include <cstring>
-#include <fstream>
 #include <random>
 #include <stdexcept>
 
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "trace_format.h"
 #include "util.h"
 
 namespace ycsbr {
@@ -13,42 +15,113 @@ namespace ycsbr {
 // much memory for very large bulk loads.
 constexpr size_t kNumUniqueValues = 1024;
 
+namespace impl {
+
+// Trace files are parsed in parallel in chunks of this many requests.
+constexpr size_t kTraceRecordsPerChunk = 1ULL << 16;
+
+// Returns the size of the encoded request starting at `data`.
+inline size_t EncodedRequestSize(const char* data) {
+  Request::Operation op;
+  memcpy(&op, data, sizeof(op));
+  return sizeof(Request::Encoded) +
+         (op == Request::Operation::kScan ? sizeof(uint32_t) : 0);
+}
+
+// Decodes `count` requests starting at `data` into `out`.
+inline void DecodeRequests(const char* data, const size_t count,
+                           const bool swap_key_bytes, Request* out) {
+  for (size_t i = 0; i < count; ++i, ++out) {
+    Request::Operation op;
+    Request::Key key;
+    uint32_t scan_amount = 0;
+    memcpy(&op, data, sizeof(op));
+    memcpy(&key, data + sizeof(op), sizeof(key));
+    data += sizeof(Request::Encoded);
+    if (op == Request::Operation::kScan) {
+      memcpy(&scan_amount, data, sizeof(scan_amount));
+      data += sizeof(scan_amount);
+    }
+    *out = Request(op, swap_key_bytes ? __builtin_bswap64(key) : key,
+                   scan_amount, nullptr, 0);
+  }
+}
+
+// Finds the byte offset of every `kTraceRecordsPerChunk`-th request in an
+// encoded trace and returns the total number of requests. A truncated request
+// at the end of the trace is ignored. If `chunk_writes` is not null, it is set
+// to the number of writes (see `IsTraceWrite()`) that precede each chunk.
+inline size_t FindChunkOffsets(const char* data, const size_t size,
+                               std::vector<size_t>* chunk_offsets,
+                               std::vector<size_t>* chunk_writes = nullptr) {
+  size_t num_requests = 0;
+  size_t num_writes = 0;
+  size_t offset = 0;
+  while (offset + sizeof(Request::Encoded) <= size) {
+    const size_t request_size = EncodedRequestSize(data + offset);
+    if (offset + request_size > size) break;
+    if (num_requests % kTraceRecordsPerChunk == 0) {
+      chunk_offsets->push_back(offset);
+      if (chunk_writes != nullptr) {
+        chunk_writes->push_back(num_writes);
+      }
+    }
+    if (chunk_writes != nullptr) {
+      Request::Operation op;
+      memcpy(&op, data + offset, sizeof(op));
+      num_writes += IsTraceWrite(op);
+    }
+    offset += request_size;
+    ++num_requests;
+  }
+  return num_requests;
+}
+
+}  // namespace impl
+
 inline Trace Trace::LoadFromFile(const std::string& file,
                                  const Options& options) {
   if (options.value_size < 4) {
     throw std::invalid_argument("Options::value_size must be at least 4.");
   }
-  std::ifstream input(file, std::ios::in | std::ios::binary);
-  if (!input) {
-    throw std::runtime_error(
-        "Failed to load workload from file. Error opening: " + file);
-  }
-  input.exceptions(std::ifstream::badbit);
+  const impl::MappedFile mapped(file);
+  mapped.AdviseSequential();
+  const char* const data = mapped.data();
+  const size_t size = mapped.size();
 
-  size_t num_writes = 0;
+  const bool swap_key_bytes =
+      options.use_v1_semantics && options.swap_key_bytes;
   std::vector<Request> trace_raw;
-  Request::Encoded encoded;
-  while (true) {
-    uint32_t scan_amount = 0;
-    input.read(reinterpret_cast<char*>(&encoded), sizeof(encoded));
-    if (input.eof()) {
-      break;
-    }
 
-    if (encoded.op == Request::Operation::kScan) {
-      input.read(reinterpret_cast<char*>(&scan_amount), sizeof(scan_amount));
-    }
-    if (encoded.op == Request::Operation::kInsert ||
-        encoded.op == Request::Operation::kUpdate) {
-      num_writes += 1;
-    }
-    trace_raw.emplace_back(encoded.op,
-                           options.use_v1_semantics && options.swap_key_bytes
-                               ? __builtin_bswap64(encoded.key)
-                               : encoded.key,
-                           scan_amount, nullptr, 0);
+  if (impl::IsTraceV3(data, size)) {
+    // Decode the blocks directly into their final positions.
+    const impl::TraceV3Index index = impl::ReadTraceV3Index(data, size);
+    trace_raw.resize(index.header.num_requests);
+    impl::ParallelFor(index.block_offsets.size(), [&](const size_t block) {
+      impl::DecodeTraceV3Block(
+          data + index.BlockBegin(block), data + index.BlockEnd(block),
+          index.BlockSize(block), swap_key_bytes,
+          &trace_raw[block * index.header.requests_per_block]);
+    });
+    return ProcessRawTrace(std::move(trace_raw), options);
   }
 
+  // The requests in legacy traces have variable sizes (scans are followed by
+  // their scan amount), so we first find where each chunk starts.
+  std::vector<size_t> chunk_offsets;
+  const size_t num_requests =
+      impl::FindChunkOffsets(data, size, &chunk_offsets);
+
+  // Decode the chunks directly into their final positions.
+  trace_raw.resize(num_requests);
+  impl::ParallelFor(chunk_offsets.size(), [&](const size_t chunk) {
+    const size_t first = chunk * impl::kTraceRecordsPerChunk;
+    const size_t count =
+        std::min(impl::kTraceRecordsPerChunk, num_requests - first);
+    impl::DecodeRequests(data + chunk_offsets[chunk], count, swap_key_bytes,
+                         &trace_raw[first]);
+  });
+
   return ProcessRawTrace(std::move(trace_raw), options);
 }
 
@@ -70,24 +143,20 @@ inline Trace Trace::ProcessRawTrace(std::vector<Request> raw_trace,
   std::mt19937 rng(options.rng_seed);
   std::unique_ptr<char[]> values = impl::GetRandomBytes(total_value_size, rng);
 
-  std::vector<Request> trace;
-  trace.reserve(raw_trace.size());
+  // Assign values to the writes in place (avoids keeping a second copy of the
+  // trace).
   size_t value_index = 0;
-  for (size_t i = 0; i < raw_trace.size(); ++i) {
-    const auto& raw = raw_trace[i];
-    if (raw.op == Request::Operation::kInsert ||
-        raw.op == Request::Operation::kUpdate) {
-      trace.emplace_back(
-          raw.op, raw.key, raw.scan_amount,
-          &values[(value_index % kNumUniqueValues) * options.value_size],
-          options.value_size);
+  for (auto& req : raw_trace) {
+    if (impl::IsTraceWrite(req.op)) {
+      req.value =
+          &values[(value_index % kNumUniqueValues) * options.value_size];
+      req.value_size = options.value_size;
       value_index += 1;
-    } else {
-      trace.emplace_back(raw);
     }
   }
 
-  return Trace(std::move(trace), std::move(values), options.use_v1_semantics);
+  return Trace(std::move(raw_trace), std::move(values),
+               options.use_v1_semantics);
 }
 
 inline Trace::MinMaxKeys Trace::GetKeyRange() const {
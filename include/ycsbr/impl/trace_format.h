@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../request.h"
+
+namespace ycsbr {
+namespace impl {
+
+// Helpers for reading and writing the block-based (v3) trace format.
+//
+// A v3 trace file has three parts:
+//   1. A fixed-size header (`TraceV3Header`).
+//   2. A sequence of blocks. Each block holds `requests_per_block` requests
+//      (the last block may hold fewer). Within a block, each request is
+//      encoded as its operation (1 byte), the zigzag varint-encoded difference
+//      between its key and the previous request's key (the first request in a
+//      block is encoded relative to 0), and, for scans, the varint-encoded scan
+//      amount.
+//   3. A block index footer, stored at `TraceV3Header::index_offset`: the file
+//      offset of each block (`uint64_t`), followed by the number of writes
+//      (see `IsTraceWrite()`) that precede each block (`uint64_t`).
+//
+// Since blocks have a fixed number of requests, the block containing request
+// `i` can be found without decoding the preceding blocks. The write counts
+// let readers that start in the middle of the trace assign values without
+// decoding the preceding blocks either. All integers are stored in the host's
+// byte order (as in the legacy format).
+
+constexpr char kTraceV3Magic[8] = {'Y', 'C', 'S', 'B', 'R', 'T', 'R', '3'};
+constexpr uint32_t kTraceV3Version = 4;
+
+struct TraceV3Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t requests_per_block;
+  uint64_t num_requests;
+  uint64_t num_blocks;
+  uint64_t index_offset;
+  uint64_t min_key;
+  uint64_t max_key;
+  // Number of requests of each `Request::Operation` (adding an operation
+  // changes the header's layout, so it requires a new format version).
+  uint64_t op_counts[Request::kNumOperations];
+};
+
+// The header and block index of a v3 trace.
+struct TraceV3Index {
+  TraceV3Header header;
+  std::vector<uint64_t> block_offsets;
+  // The number of writes that precede each block.
+  std::vector<uint64_t> block_writes;
+
+  size_t BlockBegin(size_t block) const { return block_offsets[block]; }
+  size_t BlockEnd(size_t block) const {
+    return block + 1 < block_offsets.size() ? block_offsets[block + 1]
+                                            : header.index_offset;
+  }
+  size_t BlockSize(size_t block) const {
+    const size_t first = block * header.requests_per_block;
+    return std::min<size_t>(header.requests_per_block,
+                            header.num_requests - first);
+  }
+};
+
+// Returns true iff trace requests of type `op` are assigned a value (see
+// `Trace::ProcessRawTrace()`).
+inline bool IsTraceWrite(const Request::Operation op) {
+  return op == Request::Operation::kInsert ||
+         op == Request::Operation::kUpdate;
+}
+
+// Returns true iff `data` starts with a v3 trace header. Legacy traces start
+// with an operation byte, so the two formats cannot be confused.
+inline bool IsTraceV3(const char* data, const size_t size) {
+  return size >= sizeof(kTraceV3Magic) &&
+         memcmp(data, kTraceV3Magic, sizeof(kTraceV3Magic)) == 0;
+}
+
+inline void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+inline const char* ReadVarint(const char* data, const char* end,
+                              uint64_t* value) {
+  uint64_t result = 0;
+  for (unsigned shift = 0; shift < 64 && data < end; shift += 7) {
+    const uint8_t byte = static_cast<uint8_t>(*data++);
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return data;
+    }
+  }
+  throw std::runtime_error("Corrupt trace file (invalid varint).");
+}
+
+inline uint64_t ZigZagEncode(const int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t ZigZagDecode(const uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Appends the encoding of `requests[0..count)` (one block) to `out`.
+inline void EncodeTraceV3Block(const Request* requests, const size_t count,
+                               std::string* out) {
+  Request::Key prev_key = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Request& req = requests[i];
+    out->push_back(static_cast<char>(req.op));
+    AppendVarint(ZigZagEncode(static_cast<int64_t>(req.key - prev_key)), out);
+    if (req.op == Request::Operation::kScan) {
+      AppendVarint(req.scan_amount, out);
+    }
+    prev_key = req.key;
+  }
+}
+
+// Decodes one block of `count` requests stored in `[data, end)` into `out`.
+inline void DecodeTraceV3Block(const char* data, const char* end,
+                               const size_t count, const bool swap_key_bytes,
+                               Request* out) {
+  Request::Key key = 0;
+  for (size_t i = 0; i < count; ++i, ++out) {
+    if (data >= end) {
+      throw std::runtime_error("Corrupt trace file (truncated block).");
+    }
+    const uint8_t op_byte = static_cast<uint8_t>(*data++);
+    if (op_byte >= Request::kNumOperations) {
+      throw std::runtime_error("Corrupt trace file (invalid operation).");
+    }
+    const auto op = static_cast<Request::Operation>(op_byte);
+    uint64_t delta = 0;
+    data = ReadVarint(data, end, &delta);
+    key += static_cast<Request::Key>(ZigZagDecode(delta));
+    uint64_t scan_amount = 0;
+    if (op == Request::Operation::kScan) {
+      data = ReadVarint(data, end, &scan_amount);
+    }
+    *out = Request(op, swap_key_bytes ? __builtin_bswap64(key) : key,
+                   static_cast<uint32_t>(scan_amount), nullptr, 0);
+  }
+}
+
+// Reads the header and block index of the v3 trace stored in `[data, data +
+// size)`. Throws `std::runtime_error` if they are invalid.
+inline TraceV3Index ReadTraceV3Index(const char* data, const size_t size) {
+  TraceV3Index index;
+  if (size < sizeof(TraceV3Header)) {
+    throw std::runtime_error("Corrupt trace file (truncated header).");
+  }
+  memcpy(&index.header, data, sizeof(TraceV3Header));
+  const TraceV3Header& header = index.header;
+  if (header.version != kTraceV3Version) {
+    throw std::runtime_error("Unsupported trace file version: " +
+                             std::to_string(header.version));
+  }
+  if (header.requests_per_block == 0 ||
+      header.num_blocks != (header.num_requests + header.requests_per_block -
+                            1) / header.requests_per_block ||
+      header.index_offset > size ||
+      (size - header.index_offset) / sizeof(uint64_t) / 2 <
+          header.num_blocks) {
+    throw std::runtime_error("Corrupt trace file (invalid header).");
+  }
+  const size_t index_size = header.num_blocks * sizeof(uint64_t);
+  index.block_offsets.resize(header.num_blocks);
+  memcpy(index.block_offsets.data(), data + header.index_offset, index_size);
+  index.block_writes.resize(header.num_blocks);
+  memcpy(index.block_writes.data(), data + header.index_offset + index_size,
+         index_size);
+  uint64_t prev = sizeof(TraceV3Header);
+  for (const uint64_t offset : index.block_offsets) {
+    if (offset < prev || offset > header.index_offset) {
+      throw std::runtime_error("Corrupt trace file (invalid block index).");
+    }
+    prev = offset;
+  }
+  // No writes precede the first block, and each block holds at most
+  // `requests_per_block` writes.
+  const std::vector<uint64_t>& writes = index.block_writes;
+  for (size_t block = 0; block < writes.size(); ++block) {
+    const uint64_t prev_writes = block == 0 ? 0 : writes[block - 1];
+    if (writes[block] < prev_writes ||
+        writes[block] - prev_writes >
+            (block == 0 ? 0 : header.requests_per_block)) {
+      throw std::runtime_error("Corrupt trace file (invalid block index).");
+    }
+  }
+  return index;
+}
+
+// A persisted workload file (see `PersistedWorkload`) stores the request
+// streams generated by a fixed number of producers. It reuses the v3 block
+// encoding and has three parts:
+//   1. A fixed-size header (`PersistedWorkloadHeader`).
+//   2. Each producer's requests, encoded in v3 blocks. Each producer's requests
+//      start in a new block.
+//   3. A footer, stored at `PersistedWorkloadHeader::index_offset`: one
+//      `PersistedProducerInfo` per producer, followed by the file offset of
+//      each block (`uint64_t`), followed by each producer's
+//      `PersistedPhaseChange`s (in producer order).
+
+constexpr char kPersistedWorkloadMagic[8] = {'Y', 'C', 'S', 'B', 'R', 'P',
+                                             'W', '1'};
+constexpr uint32_t kPersistedWorkloadVersion = 2;
+
+struct PersistedWorkloadHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t requests_per_block;
+  uint64_t num_producers;
+  uint64_t num_blocks;
+  uint64_t index_offset;
+  // The size of the values written by the workload (values are not stored).
+  uint64_t value_size;
+};
+
+struct PersistedProducerInfo {
+  uint64_t num_requests;
+  uint64_t first_block;
+  // The number of times the phase of the producer's requests changes (see
+  // `PersistedPhaseChange`).
+  uint64_t num_phase_changes;
+};
+
+// Records that the producer's requests are in phase `phase`, starting from its
+// `first_request`-th request. A producer's first request always starts a
+// phase. Producers that do not report phases have no phase changes.
+struct PersistedPhaseChange {
+  uint64_t first_request;
+  uint64_t phase;
+};
+
+}  // namespace impl
+}  // namespace ycsbr
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdlib>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "../benchmark_result.h"
 #include "../meter.h"
+#include "../request.h"
+#include "../run_options.h"
+#include "live_metrics.h"
 
 namespace ycsbr {
 namespace impl {
@@ -31,43 +37,214 @@ class ThroughputSample {
   std::chrono::nanoseconds elapsed_;
 };
 
+// Tracks the metrics recorded by one executor. If the executor's producer
+// reports the phase of each request (see `ReportsPhase`), the metrics are kept
+// separately for each phase (see `EnterPhase()`).
 class MetricsTracker {
  public:
   MetricsTracker(size_t num_reads_hint = 100000,
                  size_t num_writes_hint = 100000, size_t num_scans_hint = 1000)
-      : reads_(num_reads_hint),
-        writes_(num_writes_hint),
-        scans_(num_scans_hint),
-        failed_reads_(0),
-        failed_writes_(0),
-        failed_scans_(0),
-        read_xor_(0) {}
-
-  void RecordRead(std::optional<std::chrono::nanoseconds> run_time,
-                  size_t read_bytes, bool succeeded) {
-    if (succeeded) {
-      reads_.Record(run_time, read_bytes);
+      : config_{/*histogram_precision_bits=*/0,
+                num_reads_hint,
+                num_writes_hint,
+                num_scans_hint,
+                /*num_batches_hint=*/0,
+                /*nanos_per_tick=*/1.0},
+        current_phase_(0),
+        has_phases_(false),
+        measuring_(true),
+        read_xor_(0),
+        live_(nullptr) {
+    phases_.emplace_back();
+  }
+
+  // Uses the latency storage configured in `options`. Recorded latencies are
+  // converted into nanoseconds using `nanos_per_tick` when finalized.
+  explicit MetricsTracker(const RunOptions& options,
+                          double nanos_per_tick = 1.0)
+      : config_{options.latency_histogram_precision_bits,
+                /*num_reads_hint=*/100000,
+                /*num_writes_hint=*/100000,
+                /*num_scans_hint=*/1000,
+                /*num_batches_hint=*/options.batch_size > 1 ? size_t{10000}
+                                                         : size_t{0},
+                nanos_per_tick},
+        current_phase_(0),
+        has_phases_(false),
+        measuring_(true),
+        read_xor_(0),
+        live_(nullptr) {
+    phases_.emplace_back();
+  }
+
+  // If set, recorded requests are also counted in `live` (see
+  // `LiveMetricsMonitor`).
+  void SetLiveCounters(LiveCounters* live) { live_ = live; }
+
+  // Marks the start and end of the executor's run (used to compute the
+  // executor's own throughput). If the run has a warm-up or a cool-down (see
+  // `SetMeasuring()`), the executor's run time only spans the measured part.
+  void MarkStart() {
+    run_start_ = run_end_ = std::chrono::steady_clock::now();
+    if (has_phases_) {
+      StartPhase(run_start_);
+    }
+  }
+  void MarkEnd() {
+    if (!measuring_) return;
+    run_end_ = std::chrono::steady_clock::now();
+    if (has_phases_) {
+      phases_[current_phase_].end = run_end_;
+    }
+  }
+
+  // While not measuring (i.e., during a warm-up or a cool-down), recorded
+  // requests are only counted in the live counters (if any). The executor's
+  // run time starts when measuring starts and ends when measuring stops.
+  void SetMeasuring(const bool measuring) {
+    if (measuring == measuring_) return;
+    if (measuring) {
+      measuring_ = true;
+      MarkStart();
     } else {
-      ++failed_reads_;
+      MarkEnd();
+      measuring_ = false;
     }
   }
 
-  void RecordWrite(std::optional<std::chrono::nanoseconds> run_time,
+  // Records subsequent requests as part of phase `phase`. A phase's run time
+  // spans from when it is first entered to when it is last left (while
+  // measuring).
+  void EnterPhase(const size_t phase) {
+    if (phase == current_phase_ && has_phases_) return;
+    const auto now = std::chrono::steady_clock::now();
+    if (has_phases_ && measuring_) {
+      phases_[current_phase_].end = now;
+    }
+    while (phases_.size() <= phase) {
+      phases_.emplace_back();
+    }
+    current_phase_ = phase;
+    has_phases_ = true;
+    if (measuring_) {
+      StartPhase(now);
+    }
+  }
+
+  // Each request is recorded once, in a meter for its operation type. The
+  // aggregate meters (e.g., `BenchmarkResult::Reads()`) and the per-operation
+  // meters (see `BenchmarkResult::ForOperation()`) are derived from these
+  // meters when the metrics are finalized.
+
+  // Records a read (`op` is `kRead` or `kNegativeRead`).
+  void RecordRead(Request::Operation op,
+                  std::optional<std::chrono::nanoseconds> run_time,
+                  size_t read_bytes, bool succeeded) {
+    if (live_ != nullptr) {
+      live_->reads.Record(run_time, succeeded, !succeeded);
+    }
+    if (!measuring_) return;
+    RecordRequest(op, run_time, read_bytes, /*record_count=*/1, succeeded);
+  }
+
+  // Records a write (`op` is `kInsert` or `kUpdate`).
+  void RecordWrite(Request::Operation op,
+                   std::optional<std::chrono::nanoseconds> run_time,
                    size_t write_bytes, bool succeeded) {
-    if (succeeded) {
-      writes_.Record(run_time, write_bytes);
-    } else {
-      ++failed_writes_;
+    if (live_ != nullptr) {
+      live_->writes.Record(run_time, succeeded, !succeeded);
     }
+    if (!measuring_) return;
+    RecordRequest(op, run_time, write_bytes, /*record_count=*/1, succeeded);
   }
 
   void RecordScan(std::optional<std::chrono::nanoseconds> run_time,
                   size_t scanned_bytes, size_t scanned_amount, bool succeeded) {
+    if (live_ != nullptr) {
+      live_->scans.Record(run_time, succeeded, !succeeded);
+    }
+    if (!measuring_) return;
+    RecordRequest(Request::Operation::kScan, run_time, scanned_bytes,
+                  scanned_amount, succeeded);
+  }
+
+  // Records the read of a read-modify-write. If the read failed, the
+  // read-modify-write failed too (its write is skipped).
+  void RecordReadModifyWriteRead(
+      std::optional<std::chrono::nanoseconds> run_time, size_t read_bytes,
+      bool succeeded) {
+    if (live_ != nullptr) {
+      live_->reads.Record(run_time, succeeded, !succeeded);
+    }
+    if (!measuring_) return;
+    PhaseMetrics& current = phases_[current_phase_];
+    if (succeeded) {
+      GetMeter(&current.rmw_reads, config_.num_reads_hint)
+          .Record(run_time, read_bytes);
+    } else {
+      ++current.failed_rmw_reads;
+      RecordRequest(Request::Operation::kReadModifyWrite, run_time,
+                    /*bytes=*/0, /*record_count=*/1, /*succeeded=*/false);
+    }
+  }
+
+  // Records the write of a read-modify-write whose read succeeded.
+  // `request_run_time` spans both the read and the write.
+  void RecordReadModifyWriteWrite(
+      std::optional<std::chrono::nanoseconds> run_time,
+      std::optional<std::chrono::nanoseconds> request_run_time,
+      size_t write_bytes, bool succeeded) {
+    if (live_ != nullptr) {
+      live_->writes.Record(run_time, succeeded, !succeeded);
+    }
+    if (!measuring_) return;
+    PhaseMetrics& current = phases_[current_phase_];
     if (succeeded) {
-      scans_.RecordMultipleRecords(run_time, scanned_bytes, scanned_amount);
+      GetMeter(&current.rmw_writes, config_.num_writes_hint)
+          .Record(run_time, write_bytes);
     } else {
-      ++failed_scans_;
+      ++current.failed_rmw_writes;
+    }
+    // The read-modify-write's bytes are only counted in its read and write.
+    RecordRequest(Request::Operation::kReadModifyWrite, request_run_time,
+                  /*bytes=*/0, /*record_count=*/1, succeeded);
+  }
+
+  // Records a batch of `batch_size` reads of type `op` that were dispatched
+  // together, of which `num_succeeded` succeeded. The batch's latency is
+  // amortized across its requests.
+  void RecordReadBatch(Request::Operation op,
+                       std::optional<std::chrono::nanoseconds> run_time,
+                       size_t batch_size, size_t num_succeeded,
+                       size_t read_bytes) {
+    if (live_ != nullptr) {
+      live_->reads.Record(AmortizedRunTime(run_time, batch_size),
+                          num_succeeded, batch_size - num_succeeded);
+    }
+    if (!measuring_) return;
+    RecordBatch(op, run_time, batch_size, num_succeeded, read_bytes);
+  }
+
+  // Records a batch of `batch_size` writes of type `op` that were dispatched
+  // together, of which `num_succeeded` succeeded. The batch's latency is
+  // amortized across its requests.
+  void RecordWriteBatch(Request::Operation op,
+                        std::optional<std::chrono::nanoseconds> run_time,
+                        size_t batch_size, size_t num_succeeded,
+                        size_t write_bytes) {
+    if (live_ != nullptr) {
+      live_->writes.Record(AmortizedRunTime(run_time, batch_size),
+                           num_succeeded, batch_size - num_succeeded);
     }
+    if (!measuring_) return;
+    RecordBatch(op, run_time, batch_size, num_succeeded, write_bytes);
+  }
+
+  // Returns a batch's latency amortized across its `batch_size` requests.
+  static std::optional<std::chrono::nanoseconds> AmortizedRunTime(
+      std::optional<std::chrono::nanoseconds> run_time, size_t batch_size) {
+    if (!run_time.has_value()) return std::nullopt;
+    return *run_time / batch_size;
   }
 
   void SetReadXOR(uint32_t value) { read_xor_ = value; }
@@ -87,48 +264,300 @@ class MetricsTracker {
   }
 
   BenchmarkResult Finalize(std::chrono::nanoseconds total_run_time) {
-    return BenchmarkResult(
-        total_run_time, read_xor_, std::move(reads_).Freeze(),
-        std::move(writes_).Freeze(), std::move(scans_).Freeze(), failed_reads_,
-        failed_writes_, failed_scans_);
+    std::vector<MetricsTracker> trackers;
+    trackers.push_back(std::move(*this));
+    return FinalizeGroup(total_run_time, std::move(trackers));
   }
 
+  // Merges the metrics recorded by a group of executors. The result also
+  // holds a breakdown of the metrics by executor and by phase (see
+  // `BenchmarkResult::PerExecutor()` and `BenchmarkResult::PerPhase()`).
   static BenchmarkResult FinalizeGroup(std::chrono::nanoseconds total_run_time,
                                        std::vector<MetricsTracker> trackers) {
-    std::vector<Meter> reads, writes, scans;
-    size_t failed_reads = 0, failed_writes = 0, failed_scans = 0;
-    uint32_t read_xor = 0;
-    reads.reserve(trackers.size());
-    writes.reserve(trackers.size());
-    scans.reserve(trackers.size());
+    // The breakdowns summarize the recorded latencies without copying them,
+    // so they are computed before the totals (which move them).
+    std::vector<BenchmarkResult> per_executor;
+    per_executor.reserve(trackers.size());
+    size_t num_phases = 0;
+    for (const auto& tracker : trackers) {
+      std::vector<const PhaseMetrics*> phases;
+      for (const auto& phase : tracker.phases_) {
+        phases.push_back(&phase);
+      }
+      per_executor.push_back(Merge(tracker.run_end_ - tracker.run_start_,
+                                   tracker.read_xor_, phases));
+      if (tracker.has_phases_) {
+        num_phases = std::max(num_phases, tracker.phases_.size());
+      }
+    }
 
+    std::vector<BenchmarkResult> per_phase;
+    per_phase.reserve(num_phases);
+    for (size_t phase_id = 0; phase_id < num_phases; ++phase_id) {
+      // A phase runs from when the first executor starts it until the last
+      // executor finishes it.
+      std::vector<const PhaseMetrics*> phases;
+      std::optional<std::chrono::steady_clock::time_point> start, end;
+      for (const auto& tracker : trackers) {
+        if (tracker.phases_.size() <= phase_id) continue;
+        const PhaseMetrics& phase = tracker.phases_[phase_id];
+        phases.push_back(&phase);
+        if (!phase.started) continue;
+        if (!start.has_value() || phase.start < *start) start = phase.start;
+        if (!end.has_value() || phase.end > *end) end = phase.end;
+      }
+      const std::chrono::nanoseconds run_time =
+          start.has_value() ? *end - *start : std::chrono::nanoseconds(0);
+      per_phase.push_back(Merge(run_time, /*read_xor=*/0, phases));
+    }
+
+    std::vector<PhaseMetrics*> all_phases;
+    uint32_t read_xor = 0;
     for (auto& tracker : trackers) {
-      reads.emplace_back(std::move(tracker.reads_));
-      writes.emplace_back(std::move(tracker.writes_));
-      scans.emplace_back(std::move(tracker.scans_));
+      for (auto& phase : tracker.phases_) {
+        all_phases.push_back(&phase);
+      }
       read_xor ^= tracker.read_xor_;
-      failed_reads += tracker.failed_reads_;
-      failed_writes += tracker.failed_writes_;
-      failed_scans += tracker.failed_scans_;
     }
-
-    return BenchmarkResult(total_run_time, read_xor,
-                           Meter::FreezeGroup(std::move(reads)),
-                           Meter::FreezeGroup(std::move(writes)),
-                           Meter::FreezeGroup(std::move(scans)), failed_reads,
-                           failed_writes, failed_scans);
+    BenchmarkResult result = Merge(total_run_time, read_xor, all_phases);
+    result.per_executor_ = std::move(per_executor);
+    result.per_phase_ = std::move(per_phase);
+    return result;
   }
 
  private:
+  // How to create the meters for each phase.
+  struct MeterConfig {
+    int histogram_precision_bits;
+    size_t num_reads_hint, num_writes_hint, num_scans_hint, num_batches_hint;
+    double nanos_per_tick;
+
+    Meter CreateMeter(size_t num_entries_hint) const {
+      Meter meter = histogram_precision_bits > 0
+                        ? Meter::UsingHistogram(histogram_precision_bits)
+                        : Meter(num_entries_hint);
+      meter.SetNanosPerTick(nanos_per_tick);
+      return meter;
+    }
+  };
+
+  // The metrics recorded while running the requests of one phase.
+  static constexpr size_t kNumOperations = Request::kNumOperations;
+
+  // The precision of the histograms that summarize the latencies in the
+  // per-executor and per-phase breakdowns (unless the run already records
+  // latencies in histograms).
+  static constexpr int kBreakdownPrecisionBits = 8;
+
+  struct PhaseMetrics {
+    PhaseMetrics()
+        : failed_rmw_reads(0), failed_rmw_writes(0), started(false) {}
+
+    size_t TotalRequestCount() const {
+      size_t count = failed_rmw_reads + failed_rmw_writes;
+      for (size_t i = 0; i < kNumOperations; ++i) {
+        // A read-modify-write counts as two requests (its read and its write).
+        if (i == static_cast<size_t>(Request::Operation::kReadModifyWrite)) {
+          continue;
+        }
+        count += RequestCount(succeeded[i]) + RequestCount(failed[i]);
+      }
+      return count + RequestCount(rmw_reads) + RequestCount(rmw_writes);
+    }
+
+    static size_t RequestCount(const std::optional<Meter>& meter) {
+      return meter.has_value() ? meter->RequestCount() : 0;
+    }
+
+    // Indexed by `Request::Operation`. The meters are only created once a
+    // request of their type is recorded. For read-modify-writes, these meters
+    // track the latency of both the read and the write.
+    std::array<std::optional<Meter>, kNumOperations> succeeded, failed;
+    // The successful reads and writes of read-modify-writes.
+    std::optional<Meter> rmw_reads, rmw_writes;
+    size_t failed_rmw_reads, failed_rmw_writes;
+    // Tracks batches dispatched together (see `RunOptions::batch_size`). The
+    // requests in each batch are also recorded in the meters above.
+    std::optional<Meter> batches;
+    // Whether the executor has entered this phase (see `EnterPhase()`).
+    bool started;
+    std::chrono::steady_clock::time_point start, end;
+  };
+
+  // Merges the metrics of `phases` into one result. If `PhasePtr` is a
+  // non-const pointer, the meters' latencies are moved into the result.
+  // Otherwise the phases are left unchanged and the latencies are summarized
+  // in histograms (see `Meter::SummarizeGroup()`).
+  template <typename PhasePtr>
+  static BenchmarkResult Merge(std::chrono::nanoseconds run_time,
+                               uint32_t read_xor,
+                               const std::vector<PhasePtr>& phases) {
+    using MeterPtr = decltype(&*std::declval<PhasePtr>()->batches);
+    std::vector<MeterPtr> reads, writes, scans, batches;
+    std::array<std::vector<const Meter*>, kNumOperations> operations;
+    std::array<size_t, kNumOperations> failed_operations = {};
+    size_t failed_rmw_reads = 0, failed_rmw_writes = 0;
+    const auto add = [](auto& meter, auto* group) {
+      if (meter.has_value()) group->push_back(&*meter);
+    };
+
+    for (const PhasePtr phase : phases) {
+      for (size_t i = 0; i < kNumOperations; ++i) {
+        add(phase->succeeded[i], &operations[i]);
+        add(phase->failed[i], &operations[i]);
+        failed_operations[i] += PhaseMetrics::RequestCount(phase->failed[i]);
+      }
+      add(phase->succeeded[Index(Request::Operation::kRead)], &reads);
+      add(phase->succeeded[Index(Request::Operation::kNegativeRead)], &reads);
+      add(phase->rmw_reads, &reads);
+      add(phase->succeeded[Index(Request::Operation::kInsert)], &writes);
+      add(phase->succeeded[Index(Request::Operation::kUpdate)], &writes);
+      add(phase->rmw_writes, &writes);
+      add(phase->succeeded[Index(Request::Operation::kScan)], &scans);
+      add(phase->batches, &batches);
+      failed_rmw_reads += phase->failed_rmw_reads;
+      failed_rmw_writes += phase->failed_rmw_writes;
+    }
+
+    const size_t failed_reads =
+        failed_operations[Index(Request::Operation::kRead)] +
+        failed_operations[Index(Request::Operation::kNegativeRead)] +
+        failed_rmw_reads;
+    const size_t failed_writes =
+        failed_operations[Index(Request::Operation::kInsert)] +
+        failed_operations[Index(Request::Operation::kUpdate)] +
+        failed_rmw_writes;
+    const size_t failed_scans =
+        failed_operations[Index(Request::Operation::kScan)];
+
+    // The per-operation meters share their latencies with the aggregate
+    // meters, so they are summarized before those latencies are moved.
+    std::array<FrozenMeter, kNumOperations> frozen_operations =
+        FreezeOperations(operations,
+                         std::make_index_sequence<kNumOperations>());
+    return BenchmarkResult(run_time, read_xor, FreezeMeters(reads),
+                           FreezeMeters(writes), FreezeMeters(scans),
+                           failed_reads, failed_writes, failed_scans,
+                           FreezeMeters(batches), std::move(frozen_operations),
+                           failed_operations);
+  }
+
+  static constexpr size_t Index(Request::Operation op) {
+    return static_cast<size_t>(op);
+  }
+
+  // Moves the meters' latencies into the frozen meter.
+  static FrozenMeter FreezeMeters(const std::vector<Meter*>& meters) {
+    std::vector<Meter> moved;
+    moved.reserve(meters.size());
+    for (Meter* meter : meters) {
+      moved.emplace_back(std::move(*meter));
+    }
+    return Meter::FreezeGroup(std::move(moved));
+  }
+
+  // Summarizes the meters' latencies (used for the breakdowns and for the
+  // per-operation meters).
+  static FrozenMeter FreezeMeters(const std::vector<const Meter*>& meters) {
+    return Meter::SummarizeGroup(meters, kBreakdownPrecisionBits);
+  }
+
+  // Returns `meter`, creating it first if needed.
+  Meter& GetMeter(std::optional<Meter>* meter, size_t num_entries_hint) const {
+    if (!meter->has_value()) {
+      meter->emplace(config_.CreateMeter(num_entries_hint));
+    }
+    return **meter;
+  }
+
+  size_t NumEntriesHint(Request::Operation op) const {
+    switch (op) {
+      case Request::Operation::kInsert:
+      case Request::Operation::kUpdate:
+        return config_.num_writes_hint;
+      case Request::Operation::kScan:
+        return config_.num_scans_hint;
+      default:
+        return config_.num_reads_hint;
+    }
+  }
+
+  // Records one request in the meters of the current phase. Failed requests
+  // are recorded without their bytes.
+  void RecordRequest(Request::Operation op,
+                     std::optional<std::chrono::nanoseconds> run_time,
+                     size_t bytes, size_t record_count, bool succeeded) {
+    PhaseMetrics& current = phases_[current_phase_];
+    if (succeeded) {
+      GetMeter(&current.succeeded[Index(op)], NumEntriesHint(op))
+          .RecordMultipleRecords(run_time, bytes, record_count);
+    } else {
+      GetMeter(&current.failed[Index(op)], NumEntriesHint(op))
+          .Record(run_time, /*bytes=*/0);
+    }
+  }
+
+  void RecordBatch(Request::Operation op,
+                   std::optional<std::chrono::nanoseconds> run_time,
+                   size_t batch_size, size_t num_succeeded, size_t bytes) {
+    PhaseMetrics& current = phases_[current_phase_];
+    const std::optional<std::chrono::nanoseconds> amortized_run_time =
+        AmortizedRunTime(run_time, batch_size);
+    if (num_succeeded > 0) {
+      Meter& meter =
+          GetMeter(&current.succeeded[Index(op)], NumEntriesHint(op));
+      for (size_t i = 0; i < num_succeeded; ++i) {
+        meter.Record(amortized_run_time, i == 0 ? bytes : 0);
+      }
+    }
+    if (num_succeeded < batch_size) {
+      Meter& meter = GetMeter(&current.failed[Index(op)], NumEntriesHint(op));
+      for (size_t i = num_succeeded; i < batch_size; ++i) {
+        meter.Record(amortized_run_time, /*bytes=*/0);
+      }
+    }
+    GetMeter(&current.batches, config_.num_batches_hint)
+        .RecordMultipleRecords(run_time, /*bytes=*/0, batch_size);
+  }
+
+  // Freezes each operation's group of meters (one per phase).
+  template <size_t... Operation>
+  static std::array<FrozenMeter, sizeof...(Operation)> FreezeOperations(
+      const std::array<std::vector<const Meter*>, sizeof...(Operation)>&
+          operations,
+      std::index_sequence<Operation...>) {
+    return {FreezeMeters(operations[Operation])...};
+  }
+
+  void StartPhase(const std::chrono::steady_clock::time_point now) {
+    PhaseMetrics& current = phases_[current_phase_];
+    if (!current.started) {
+      current.started = true;
+      current.start = now;
+    }
+  }
+
   size_t TotalRequestCount() const {
-    return reads_.RequestCount() + writes_.RequestCount() +
-           scans_.RequestCount() + failed_reads_ + failed_writes_ +
-           failed_scans_;
+    size_t count = 0;
+    for (const auto& phase : phases_) {
+      count += phase.TotalRequestCount();
+    }
+    return count;
   }
 
-  Meter reads_, writes_, scans_;
-  size_t failed_reads_, failed_writes_, failed_scans_;
+  MeterConfig config_;
+  // Indexed by phase ID. If the producer does not report phases, all metrics
+  // are recorded in `phases_[0]`.
+  std::vector<PhaseMetrics> phases_;
+  size_t current_phase_;
+  // Set when `EnterPhase()` is first called.
+  bool has_phases_;
+  bool measuring_;
   uint32_t read_xor_;
+  // Not owned. May be null.
+  LiveCounters* live_;
+
+  std::chrono::steady_clock::time_point run_start_, run_end_;
 
   size_t last_count_;
   std::chrono::steady_clock::time_point last_sample_time_;
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace ycsbr {
+
+// A fixed-size log-linear histogram of latencies (similar to an HDR
+// histogram). Latencies smaller than `2^precision_bits` nanoseconds are stored
+// exactly. Larger latencies are stored in buckets whose width is proportional
+// to their magnitude, which bounds the relative error of any reported latency
+// to `2^-(precision_bits - 1)`. Histograms with the same precision can be
+// merged in O(number of buckets).
+class LatencyHistogram {
+ public:
+  static constexpr int kMinPrecisionBits = 1;
+  static constexpr int kMaxPrecisionBits = 16;
+
+  explicit LatencyHistogram(int precision_bits = 8);
+
+  void Record(std::chrono::nanoseconds latency);
+
+  // REQUIRES: `other` was created with the same precision.
+  void Merge(const LatencyHistogram& other);
+
+  int PrecisionBits() const { return precision_bits_; }
+  uint64_t Count() const { return count_; }
+  bool Empty() const { return count_ == 0; }
+
+  // The minimum, maximum, and mean are tracked exactly.
+  std::chrono::nanoseconds Min() const;
+  std::chrono::nanoseconds Max() const;
+  std::chrono::nanoseconds Mean() const;
+
+  // Returns the latency at the given percentile, where `percentile` is a value
+  // between 0.0 and 1.0 inclusive. The returned latency is the upper bound of
+  // the bucket that holds the percentile (clamped to `Max()`).
+  std::chrono::nanoseconds Percentile(double percentile) const;
+
+  // The bucket layout only depends on the precision. These are exposed so that
+  // other latency stores (e.g., the live metrics counters) can use the same
+  // buckets.
+  static size_t NumBuckets(int precision_bits);
+  static size_t BucketIndex(uint64_t value, int precision_bits);
+  static uint64_t BucketUpperBound(size_t index, int precision_bits);
+
+ private:
+  int precision_bits_;
+  std::vector<uint64_t> counts_;
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t sum_;
+};
+
+// Implementation details follow.
+
+inline LatencyHistogram::LatencyHistogram(const int precision_bits)
+    : precision_bits_(precision_bits),
+      count_(0),
+      min_(std::numeric_limits<uint64_t>::max()),
+      max_(0),
+      sum_(0) {
+  if (precision_bits < kMinPrecisionBits ||
+      precision_bits > kMaxPrecisionBits) {
+    throw std::invalid_argument(
+        "Histogram precision must be between 1 and 16 bits (inclusive).");
+  }
+  counts_.resize(NumBuckets(precision_bits_), 0);
+}
+
+inline size_t LatencyHistogram::NumBuckets(const int precision_bits) {
+  // Values less than 2^p are stored exactly. Each subsequent power of two
+  // range is split into 2^(p-1) buckets.
+  const size_t half = 1ULL << (precision_bits - 1);
+  return (66 - precision_bits) * half;
+}
+
+inline size_t LatencyHistogram::BucketIndex(const uint64_t value,
+                                             const int precision_bits) {
+  if (value < (1ULL << precision_bits)) {
+    return value;
+  }
+  const int msb = 63 - __builtin_clzll(value);
+  const int shift = msb - precision_bits + 1;
+  // `value >> shift` is in [2^(p-1), 2^p).
+  return (static_cast<size_t>(shift) << (precision_bits - 1)) +
+         (value >> shift);
+}
+
+inline uint64_t LatencyHistogram::BucketUpperBound(const size_t index,
+                                                   const int precision_bits) {
+  if (index < (1ULL << precision_bits)) {
+    return index;
+  }
+  const int shift = (index >> (precision_bits - 1)) - 1;
+  const uint64_t mantissa =
+      index - (static_cast<uint64_t>(shift) << (precision_bits - 1));
+  const uint64_t lower = mantissa << shift;
+  return lower + ((1ULL << shift) - 1);
+}
+
+inline void LatencyHistogram::Record(const std::chrono::nanoseconds latency) {
+  const uint64_t value = latency.count() < 0 ? 0 : latency.count();
+  ++counts_[BucketIndex(value, precision_bits_)];
+  ++count_;
+  sum_ += value;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+inline void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  if (other.precision_bits_ != precision_bits_) {
+    throw std::invalid_argument(
+        "Cannot merge histograms with different precisions.");
+  }
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+inline std::chrono::nanoseconds LatencyHistogram::Min() const {
+  return std::chrono::nanoseconds(Empty() ? 0 : min_);
+}
+
+inline std::chrono::nanoseconds LatencyHistogram::Max() const {
+  return std::chrono::nanoseconds(max_);
+}
+
+inline std::chrono::nanoseconds LatencyHistogram::Mean() const {
+  return std::chrono::nanoseconds(Empty() ? 0 : sum_ / count_);
+}
+
+inline std::chrono::nanoseconds LatencyHistogram::Percentile(
+    const double percentile) const {
+  if (percentile > 1.0 || percentile < 0.0) {
+    throw std::invalid_argument(
+        "Percentile out of range (must be between 0.0 and 1.0 inclusive).");
+  }
+  if (Empty()) {
+    return std::chrono::nanoseconds(0);
+  }
+  // Uses the same rank definition as the sorted sample storage in `Meter`.
+  uint64_t rank = percentile * count_;
+  if (rank == count_) {
+    --rank;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen > rank) {
+      return std::chrono::nanoseconds(
+          std::clamp(BucketUpperBound(i, precision_bits_), min_, max_));
+    }
+  }
+  return Max();
+}
+
+}  // namespace ycsbr
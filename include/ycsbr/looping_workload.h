@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "request.h"
+
+namespace ycsbr {
+
+// This class wraps an existing workload and repeats each of its producers'
+// requests once they run out. It is meant for runs with a fixed duration (see
+// `RunOptions::run_duration`), which stop at their deadline regardless of how
+// many requests are left.
+//
+// Each repetition uses a new producer from the wrapped workload (with the same
+// producer ID), so it issues the same requests as the first repetition. Note
+// that repeated inserts insert keys that already exist. The wrapped workload's
+// `GetProducers()` is called once per repetition (by whichever producer
+// finishes the previous repetition first) and its producers are shared among
+// this workload's producers. Each new producer is prepared on its executor's
+// thread while the workload runs. This restart time is not included in the
+// requests' latencies, but it is included in the run's throughput (it is
+// part of the run time), so the wrapped producers should be cheap to create
+// and prepare relative to the length of a repetition.
+template <class Workload>
+class LoopingWorkload {
+ public:
+  struct Options {
+    // The number of times to run the wrapped workload. If set to 0, the
+    // workload repeats until the run is stopped (the run must then have a
+    // `RunOptions::run_duration`, or it never ends).
+    size_t max_loops = 0;
+  };
+
+  LoopingWorkload(const Workload& workload, Options options = Options());
+
+  // Get a reference to the wrapped workload.
+  const Workload& workload() const { return workload_; }
+
+  class Producer;
+  std::vector<Producer> GetProducers(size_t num_producers) const;
+
+ private:
+  class ProducerPool;
+
+  const Workload& workload_;
+  Options options_;
+};
+
+template <class Workload>
+class LoopingWorkload<Workload>::Producer {
+ public:
+  void Prepare();
+  bool HasNext() const;
+  Request Next();
+
+  // Only available if the wrapped workload's producers report their phases
+  // (see `workload_example.h`).
+  template <typename WrappedProducer = typename Workload::Producer>
+  auto CurrentPhase() const
+      -> decltype(std::declval<const WrappedProducer&>().CurrentPhase()) {
+    return producer_->CurrentPhase();
+  }
+
+ private:
+  friend class LoopingWorkload;
+  Producer(const LoopingWorkload* workload, std::shared_ptr<ProducerPool> pool,
+           size_t id, typename Workload::Producer producer);
+
+  // Replaces `producer_` with a new (prepared) producer.
+  void Restart();
+
+  const LoopingWorkload* workload_;
+  // Shared by the producers returned by the same `GetProducers()` call.
+  std::shared_ptr<ProducerPool> pool_;
+  size_t id_;
+  // The number of times the wrapped producer was started.
+  size_t loops_;
+  // Set if the wrapped producer has no requests (so it is not repeated).
+  bool empty_;
+  std::optional<typename Workload::Producer> producer_;
+};
+
+}  // namespace ycsbr
+
+#include "impl/looping_workload-inl.h"
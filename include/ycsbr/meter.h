@@ -4,8 +4,11 @@
 #include <chrono>
 #include <numeric>
 #include <optional>
+#include <stdexcept>
 #include <vector>
 
+#include "latency_histogram.h"
+
 namespace ycsbr {
 
 class FrozenMeter;
@@ -13,10 +16,19 @@ class FrozenMeter;
 class Meter {
  public:
   Meter(size_t num_entries_hint = 100000)
-      : bytes_(0), request_count_(0), record_count_(0) {
+      : bytes_(0), request_count_(0), record_count_(0), nanos_per_tick_(1.0) {
     latencies_.reserve(num_entries_hint);
   }
 
+  // Creates a meter that stores its latencies in a fixed-size
+  // `LatencyHistogram` instead of keeping every latency sample. This uses
+  // constant memory but reports approximate percentiles.
+  static Meter UsingHistogram(int precision_bits) {
+    Meter meter(/*num_entries_hint=*/0);
+    meter.histogram_.emplace(precision_bits);
+    return meter;
+  }
+
   void Record(std::optional<std::chrono::nanoseconds> run_time, size_t bytes) {
     RecordMultipleRecords(run_time, bytes, /*record_count=*/1);
   }
@@ -24,7 +36,11 @@ class Meter {
   void RecordMultipleRecords(std::optional<std::chrono::nanoseconds> run_time,
                              size_t bytes, size_t record_count) {
     if (run_time.has_value()) {
-      latencies_.push_back(*run_time);
+      if (histogram_.has_value()) {
+        histogram_->Record(*run_time);
+      } else {
+        latencies_.push_back(*run_time);
+      }
     }
     ++request_count_;
     bytes_ += bytes;
@@ -34,11 +50,36 @@ class Meter {
   size_t RecordCount() const { return record_count_; }
   size_t RequestCount() const { return request_count_; }
 
+  // Recorded latencies can be measured in clock ticks instead of nanoseconds.
+  // They are converted into nanoseconds using this factor when the meter is
+  // frozen (the default is 1.0, i.e., latencies are already in nanoseconds).
+  void SetNanosPerTick(double nanos_per_tick) {
+    nanos_per_tick_ = nanos_per_tick;
+  }
+
   FrozenMeter Freeze() &&;
   static FrozenMeter FreezeGroup(std::vector<Meter> meters);
 
+  // Like `FreezeGroup()`, but leaves the meters unchanged and does not copy
+  // their latency samples. The latencies are instead summarized in a
+  // `LatencyHistogram` with `precision_bits` bits of precision (or, if the
+  // meters use histograms, their histograms are merged), so the percentiles
+  // are approximate.
+  static FrozenMeter SummarizeGroup(const std::vector<const Meter*>& meters,
+                                    int precision_bits);
+
  private:
   friend class FrozenMeter;
+
+  // Adds `meter`'s latencies to `histogram`, which stores ticks that are
+  // converted into nanoseconds using `histogram_nanos_per_tick`.
+  static void AddToHistogram(const Meter& meter, LatencyHistogram* histogram,
+                             double histogram_nanos_per_tick);
+
+  // Converts a latency measured in ticks into nanoseconds.
+  static std::chrono::nanoseconds TicksToNanos(std::chrono::nanoseconds ticks,
+                                               double nanos_per_tick);
+
   size_t bytes_;
   // Number of requests processed.
   size_t request_count_;
@@ -47,17 +88,24 @@ class Meter {
   // per scan and bulk load request).
   size_t record_count_;
   std::vector<std::chrono::nanoseconds> latencies_;
+  // Used instead of `latencies_` if present.
+  std::optional<LatencyHistogram> histogram_;
+  double nanos_per_tick_;
 };
 
 class FrozenMeter {
  public:
-  FrozenMeter() : bytes_(0), request_count_(0), record_count_(0) {}
+  FrozenMeter()
+      : bytes_(0), request_count_(0), record_count_(0), nanos_per_tick_(1.0) {}
   size_t TotalBytes() const { return bytes_; }
   size_t NumRequests() const { return request_count_; }
   size_t NumRecords() const { return record_count_; }
 
   template <typename Units>
   Units LatencyMin() const {
+    if (histogram_.has_value()) {
+      return ScaleHistogramValue<Units>(histogram_->Min());
+    }
     return latencies_.empty()
                ? Units(0)
                : std::chrono::duration_cast<Units>(latencies_.front());
@@ -65,6 +113,9 @@ class FrozenMeter {
 
   template <typename Units>
   Units LatencyMean() const {
+    if (histogram_.has_value()) {
+      return ScaleHistogramValue<Units>(histogram_->Mean());
+    }
     if (latencies_.empty()) {
       return Units(0);
     }
@@ -75,6 +126,9 @@ class FrozenMeter {
 
   template <typename Units>
   Units LatencyMax() const {
+    if (histogram_.has_value()) {
+      return ScaleHistogramValue<Units>(histogram_->Max());
+    }
     return latencies_.empty()
                ? Units(0)
                : std::chrono::duration_cast<Units>(latencies_.back());
@@ -82,8 +136,13 @@ class FrozenMeter {
 
   // Returns percentile latency, where `percentile` is a value between 0.0 and
   // 1.0 inclusive (i.e., `percentile = 0.99` represents the 99th percentile).
+  // If the meter used a histogram, the result is an upper bound of the
+  // percentile latency (see `LatencyHistogram::Percentile()`).
   template <typename Units>
   Units LatencyPercentile(double percentile) const {
+    if (histogram_.has_value()) {
+      return ScaleHistogramValue<Units>(histogram_->Percentile(percentile));
+    }
     if (percentile > 1.0 || percentile < 0.0) {
       throw std::invalid_argument(
           "Percentile out of range (must be between 0.0 and 1.0 inclusive).");
@@ -101,26 +160,54 @@ class FrozenMeter {
  private:
   friend class Meter;
 
-  // REQUIRES: `meter.latencies_` is in ascending order.
+  // REQUIRES: `meter.latencies_` is in ascending order and in nanoseconds.
   FrozenMeter(Meter meter)
       : FrozenMeter(meter.bytes_, meter.request_count_, meter.record_count_,
-                    std::move(meter.latencies_)) {}
+                    std::move(meter.latencies_), std::move(meter.histogram_),
+                    meter.nanos_per_tick_) {}
 
-  // REQUIRES: `latencies` is in ascending order.
+  // REQUIRES: `latencies` is in ascending order and in nanoseconds. The
+  // `histogram` (if present) may store ticks; they are converted into
+  // nanoseconds using `nanos_per_tick` when queried.
   FrozenMeter(size_t bytes, size_t request_count, size_t record_count,
-              std::vector<std::chrono::nanoseconds> latencies)
+              std::vector<std::chrono::nanoseconds> latencies,
+              std::optional<LatencyHistogram> histogram = std::nullopt,
+              double nanos_per_tick = 1.0)
       : bytes_(bytes),
         request_count_(request_count),
         record_count_(record_count),
-        latencies_(std::move(latencies)) {}
+        latencies_(std::move(latencies)),
+        histogram_(std::move(histogram)),
+        nanos_per_tick_(nanos_per_tick) {}
+
+  template <typename Units>
+  Units ScaleHistogramValue(std::chrono::nanoseconds ticks) const {
+    return std::chrono::duration_cast<Units>(
+        std::chrono::duration<double, std::nano>(ticks.count() *
+                                                 nanos_per_tick_));
+  }
 
   const size_t bytes_;
   const size_t request_count_;
   const size_t record_count_;
   const std::vector<std::chrono::nanoseconds> latencies_;
+  const std::optional<LatencyHistogram> histogram_;
+  const double nanos_per_tick_;
 };
 
+inline std::chrono::nanoseconds Meter::TicksToNanos(
+    std::chrono::nanoseconds ticks, double nanos_per_tick) {
+  if (nanos_per_tick == 1.0) return ticks;
+  return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(
+      ticks.count() * nanos_per_tick));
+}
+
 inline FrozenMeter Meter::Freeze() && {
+  if (nanos_per_tick_ != 1.0) {
+    for (auto& latency : latencies_) {
+      latency = TicksToNanos(latency, nanos_per_tick_);
+    }
+  }
   std::sort(latencies_.begin(), latencies_.end());
   return FrozenMeter(std::move(*this));
 }
@@ -132,17 +219,40 @@ inline FrozenMeter Meter::FreezeGroup(std::vector<Meter> meters) {
   size_t bytes = 0;
 
   size_t total_size = 0;
+  std::optional<LatencyHistogram> histogram;
+  double histogram_nanos_per_tick = 1.0;
   for (const auto& meter : meters) {
     total_size += meter.latencies_.size();
     request_count += meter.request_count_;
     record_count += meter.record_count_;
     bytes += meter.bytes_;
+    if (meter.histogram_.has_value() && !histogram.has_value()) {
+      histogram.emplace(meter.histogram_->PrecisionBits());
+      histogram_nanos_per_tick = meter.nanos_per_tick_;
+    }
   }
+
+  if (histogram.has_value()) {
+    // Histograms are merged bucket-wise. Any meters that stored individual
+    // samples are added to the merged histogram.
+    for (const auto& meter : meters) {
+      AddToHistogram(meter, &*histogram, histogram_nanos_per_tick);
+    }
+    return FrozenMeter(bytes, request_count, record_count, {},
+                       std::move(histogram), histogram_nanos_per_tick);
+  }
+
   all_latencies.reserve(total_size);
 
   for (const auto& meter : meters) {
-    all_latencies.insert(all_latencies.end(), meter.latencies_.begin(),
-                         meter.latencies_.end());
+    if (meter.nanos_per_tick_ == 1.0) {
+      all_latencies.insert(all_latencies.end(), meter.latencies_.begin(),
+                           meter.latencies_.end());
+      continue;
+    }
+    for (const auto& latency : meter.latencies_) {
+      all_latencies.push_back(TicksToNanos(latency, meter.nanos_per_tick_));
+    }
   }
   std::sort(all_latencies.begin(), all_latencies.end());
 
@@ -150,4 +260,52 @@ inline FrozenMeter Meter::FreezeGroup(std::vector<Meter> meters) {
                      std::move(all_latencies));
 }
 
+inline FrozenMeter Meter::SummarizeGroup(
+    const std::vector<const Meter*>& meters, const int precision_bits) {
+  size_t request_count = 0;
+  size_t record_count = 0;
+  size_t bytes = 0;
+  bool has_latencies = false;
+  std::optional<LatencyHistogram> histogram;
+  double histogram_nanos_per_tick = 1.0;
+  for (const Meter* meter : meters) {
+    request_count += meter->request_count_;
+    record_count += meter->record_count_;
+    bytes += meter->bytes_;
+    has_latencies = has_latencies || !meter->latencies_.empty();
+    if (meter->histogram_.has_value() && !histogram.has_value()) {
+      histogram.emplace(meter->histogram_->PrecisionBits());
+      histogram_nanos_per_tick = meter->nanos_per_tick_;
+    }
+  }
+  if (!histogram.has_value()) {
+    // Avoids allocating a histogram for meters without latencies.
+    if (!has_latencies) {
+      return FrozenMeter(bytes, request_count, record_count, {});
+    }
+    histogram.emplace(precision_bits);
+  }
+  for (const Meter* meter : meters) {
+    AddToHistogram(*meter, &*histogram, histogram_nanos_per_tick);
+  }
+  return FrozenMeter(bytes, request_count, record_count, {},
+                     std::move(histogram), histogram_nanos_per_tick);
+}
+
+inline void Meter::AddToHistogram(const Meter& meter,
+                                  LatencyHistogram* histogram,
+                                  const double histogram_nanos_per_tick) {
+  if (meter.histogram_.has_value()) {
+    if (meter.nanos_per_tick_ != histogram_nanos_per_tick) {
+      throw std::invalid_argument(
+          "Cannot merge histograms recorded using different clocks.");
+    }
+    histogram->Merge(*meter.histogram_);
+  }
+  for (const auto& latency : meter.latencies_) {
+    histogram->Record(
+        TicksToNanos(latency, meter.nanos_per_tick_ / histogram_nanos_per_tick));
+  }
+}
+
 }  // namespace ycsbr
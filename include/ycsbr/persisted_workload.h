@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "impl/mapped_file.h"
+#include "impl/trace_format.h"
+#include "request.h"
+
+namespace ycsbr {
+
+// Replays request streams that were generated ahead of time and saved to a
+// file.
+//
+// `PersistedWorkload::Write()` runs each of a workload's producers (e.g., the
+// producers of a `gen::PhasedWorkload` with a given seed) and saves the
+// requests each producer generates to a file. A later run can construct a
+// `PersistedWorkload` from the file to replay exactly the same requests,
+// without repeating the work needed to generate them. The file is memory
+// mapped and each producer decodes its requests one block at a time, so
+// memory usage does not depend on the workload's size.
+//
+// The request streams are tied to the number of producers the workload was
+// written with: `GetProducers()` must be called with the same number of
+// producers (i.e., the same number of threads).
+//
+// If the workload's producers report the phase of their requests (see
+// `workload_example.h`), the phases are saved too, so the replayed results
+// can be broken down by phase (see `BenchmarkResult::PerPhase()`). Otherwise
+// all requests are replayed as part of phase 0.
+//
+// The values written by the workload's requests are not saved. When replaying
+// the workload, inserts, updates, and read-modify-writes are assigned
+// (recycled) random values of the same size as the values used by the
+// original workload. A workload's initial load is also not saved; use
+// `TraceWriter` to save it if needed.
+class PersistedWorkload {
+ public:
+  static constexpr size_t kDefaultRequestsPerBlock = 4096;
+
+  // Generates the requests of `workload` using `num_producers` producers and
+  // writes them to `file`. Throws `std::invalid_argument` if the workload's
+  // values do not all have the same size and `std::runtime_error` if the file
+  // cannot be written.
+  template <class Workload>
+  static void Write(const Workload& workload, size_t num_producers,
+                    const std::string& file,
+                    size_t requests_per_block = kDefaultRequestsPerBlock);
+
+  // Throws `std::runtime_error` if the file cannot be read or is not a valid
+  // persisted workload.
+  explicit PersistedWorkload(const std::string& file, uint32_t rng_seed = 42);
+
+  // The number of producers the workload was written with.
+  size_t num_producers() const { return producers_.size(); }
+  // The total number of requests in the workload.
+  size_t size() const { return num_requests_; }
+
+  class Producer;
+  // Throws `std::invalid_argument` if `num_producers` is not equal to
+  // `num_producers()`.
+  std::vector<Producer> GetProducers(size_t num_producers) const;
+
+ private:
+  impl::MappedFile file_;
+  impl::PersistedWorkloadHeader header_;
+  std::vector<impl::PersistedProducerInfo> producers_;
+  std::vector<uint64_t> block_offsets_;
+  // Each producer's phase changes, in producer order.
+  std::vector<impl::PersistedPhaseChange> phase_changes_;
+  size_t num_requests_;
+  // Recycled values for writes (shared by all producers).
+  std::unique_ptr<char[]> values_;
+};
+
+class PersistedWorkload::Producer {
+ public:
+  void Prepare();
+  bool HasNext() const { return remaining_ > 0; }
+  Request Next();
+
+  // The phase of the request most recently returned by `Next()`.
+  size_t CurrentPhase() const { return current_phase_; }
+
+ private:
+  friend class PersistedWorkload;
+  Producer(const PersistedWorkload* workload, size_t producer_id,
+           size_t first_phase_change);
+
+  // Decodes the next block of requests.
+  void NextBlock();
+
+  const PersistedWorkload* workload_;
+  size_t remaining_;
+  size_t next_block_;
+  size_t value_index_;
+
+  std::vector<Request> block_;
+  size_t block_index_;
+
+  // The index of the next request (within this producer's requests).
+  size_t next_request_;
+  // This producer's phase changes are in `[next_phase_change_,
+  // end_phase_change_)` of `workload_->phase_changes_`.
+  size_t next_phase_change_;
+  size_t end_phase_change_;
+  size_t current_phase_;
+};
+
+}  // namespace ycsbr
+
+#include "impl/persisted_workload-inl.h"
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "request.h"
+
+namespace ycsbr {
+
+// This class wraps an existing workload and generates the workload's requests
+// on a background thread while the workload runs.
+//
+// Each producer starts a generator thread during its prepare phase. The
+// generator thread runs the wrapped producer and pushes the requests it
+// generates into a bounded lock-free single-producer single-consumer ring
+// buffer, which the executor consumes. This keeps the cost of generating the
+// requests off of the executor's thread (like `BufferedWorkload`), but only
+// uses a fixed amount of memory per producer (unlike `BufferedWorkload`, which
+// stores all of the workload's requests).
+//
+// When the ring buffer is full, the generator thread spins briefly and then
+// blocks until the executor has consumed half of the buffer. Similarly, the
+// executor blocks if it runs out of requests, so neither thread uses a whole
+// core while it waits for the other.
+//
+// The generator threads can optionally be pinned to specific cores (e.g., the
+// SMT siblings of the cores that the executors run on).
+template <class Workload>
+class PipelinedWorkload {
+ public:
+  struct Options {
+    // The number of requests each producer's ring buffer can hold (rounded up
+    // to a power of two).
+    size_t queue_capacity = 4096;
+
+    // If not empty, the generator thread of the `i`-th producer is pinned to
+    // core `generator_cores[i % generator_cores.size()]`.
+    std::vector<size_t> generator_cores;
+  };
+
+  PipelinedWorkload(const Workload& workload, Options options = Options());
+
+  // Get a reference to the wrapped workload.
+  const Workload& workload() const;
+
+  class Producer;
+  std::vector<Producer> GetProducers(size_t num_producers) const;
+
+ private:
+  const Workload& workload_;
+  Options options_;
+};
+
+template <class Workload>
+class PipelinedWorkload<Workload>::Producer {
+ public:
+  Producer(typename Workload::Producer producer, size_t queue_capacity,
+           std::optional<size_t> generator_core = std::nullopt);
+  Producer(Producer&&) noexcept = default;
+  Producer& operator=(Producer&&) noexcept = default;
+  // Stops the generator thread (if it is still running).
+  ~Producer() = default;
+
+  void Prepare();
+  bool HasNext() const;
+  Request Next();
+
+  // Only available if the wrapped workload's producers report their phases
+  // (see `workload_example.h`). The phase is passed through the ring buffer
+  // along with each request.
+  template <typename WrappedProducer = typename Workload::Producer>
+  auto CurrentPhase() const -> decltype(static_cast<size_t>(
+      std::declval<const WrappedProducer&>().CurrentPhase())) {
+    return pipeline_->CurrentPhase();
+  }
+
+ private:
+  class Pipeline;
+  std::unique_ptr<Pipeline> pipeline_;
+};
+
+}  // namespace ycsbr
+
+#include "impl/pipelined_workload-inl.h"
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "request.h"
+
+namespace ycsbr {
+
+// A reusable buffer of records that the optional `ReadInto()` and `ScanInto()`
+// `DatabaseInterface` methods fill (see `db_example.h`). The keys are stored in
+// an array and the values are stored back to back in one contiguous byte
+// array. Each worker keeps one buffer and clears it before each request.
+// Clearing keeps the buffer's memory, so once the buffer has grown to fit the
+// largest request, filling it does not allocate.
+class RecordBuffer {
+ public:
+  RecordBuffer() : offsets_(1, 0), values_size_(0), values_capacity_(0) {}
+
+  RecordBuffer(const RecordBuffer&) = delete;
+  RecordBuffer& operator=(const RecordBuffer&) = delete;
+
+  // Removes all records (the buffer keeps its memory).
+  void Clear() {
+    keys_.clear();
+    offsets_.resize(1);
+    values_size_ = 0;
+  }
+
+  // Reserves space for `num_records` records whose values take up a total of
+  // `value_bytes` bytes.
+  void Reserve(size_t num_records, size_t value_bytes);
+
+  // Appends a record (its value is copied into the buffer).
+  void Append(Request::Key key, const char* value, size_t value_size) {
+    std::memcpy(AppendUninitialized(key, value_size), value, value_size);
+  }
+
+  // Appends a record with a `value_size` byte value and returns a pointer to
+  // where the value must be written. The pointer is only valid until the next
+  // record is appended.
+  char* AppendUninitialized(Request::Key key, size_t value_size);
+
+  size_t size() const { return keys_.size(); }
+  bool empty() const { return keys_.empty(); }
+
+  Request::Key key(size_t index) const { return keys_[index]; }
+  // The view is only valid until the buffer is modified.
+  std::string_view value(size_t index) const {
+    return std::string_view(values_.get() + offsets_[index],
+                            offsets_[index + 1] - offsets_[index]);
+  }
+
+  // The total size of the records' values, in bytes.
+  size_t ValueBytes() const { return values_size_; }
+
+ private:
+  void GrowValues(size_t min_capacity);
+
+  std::vector<Request::Key> keys_;
+  // The value of record `i` is stored in `values_[offsets_[i], offsets_[i+1])`.
+  std::vector<size_t> offsets_;
+  std::unique_ptr<char[]> values_;
+  size_t values_size_, values_capacity_;
+};
+
+// Implementation details follow.
+
+inline void RecordBuffer::Reserve(const size_t num_records,
+                                  const size_t value_bytes) {
+  keys_.reserve(num_records);
+  offsets_.reserve(num_records + 1);
+  if (value_bytes > values_capacity_) {
+    GrowValues(value_bytes);
+  }
+}
+
+inline char* RecordBuffer::AppendUninitialized(const Request::Key key,
+                                               const size_t value_size) {
+  if (values_size_ + value_size > values_capacity_) {
+    GrowValues(values_size_ + value_size);
+  }
+  char* const value = values_.get() + values_size_;
+  values_size_ += value_size;
+  keys_.push_back(key);
+  offsets_.push_back(values_size_);
+  return value;
+}
+
+inline void RecordBuffer::GrowValues(const size_t min_capacity) {
+  const size_t capacity = std::max(min_capacity, 2 * values_capacity_);
+  std::unique_ptr<char[]> values(new char[capacity]);
+  if (values_size_ > 0) {
+    std::memcpy(values.get(), values_.get(), values_size_);
+  }
+  values_ = std::move(values);
+  values_capacity_ = capacity;
+}
+
+}  // namespace ycsbr
@@ -14,6 +14,8 @@ struct Request {
     kReadModifyWrite = 4,
     kNegativeRead = 5
   };
+  // The number of `Operation` types.
+  static constexpr size_t kNumOperations = 6;
   using Key = uint64_t;
 
   struct Encoded {
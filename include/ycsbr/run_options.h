@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <string>
@@ -14,6 +16,50 @@ struct RunOptions {
   // some value `n`, a worker will measure every `n`-th request's latency.
   size_t latency_sample_period = 10;
 
+  // If non-zero, workers record latencies in a fixed-size log-linear histogram
+  // with this many bits of precision (see `LatencyHistogram`) instead of
+  // storing every sampled latency. Percentiles are then reported with a
+  // relative error of at most `2^-(latency_histogram_precision_bits - 1)`.
+  // Consider using this option for long runs with a small
+  // `latency_sample_period`.
+  int latency_histogram_precision_bits = 0;
+
+  // If greater than 1 and the `DatabaseInterface` implements `ReadBatch()`
+  // and/or `WriteBatch()` (see `db_example.h`), workers will gather up to
+  // `batch_size` consecutive requests of the same type and dispatch them to
+  // the database as one batch. Batching is not used in open-loop mode.
+  size_t batch_size = 1;
+
+  // The maximum number of in-flight requests each worker keeps when the
+  // `DatabaseInterface` implements the asynchronous interface (see
+  // `db_example.h`). Open-loop mode and batching are not supported with
+  // asynchronous databases.
+  size_t async_queue_depth = 16;
+
+  // If non-zero, the run stops once `run_duration` has elapsed, even if the
+  // producers have more requests. Each worker finishes its in-flight request(s)
+  // and then stops. The run also ends if the producers run out of requests
+  // first; wrap the workload in a `LoopingWorkload` to run it for the whole
+  // duration.
+  std::chrono::milliseconds run_duration{0};
+
+  // The metrics of the requests run during the first `warmup` and (for runs
+  // with a `run_duration`) during the last `cooldown` of the run are not
+  // reported. The reported run time (used to compute the throughput) only
+  // spans the measured part of the run. Workers observe the start and end of
+  // the measured part between requests (asynchronous workers observe them
+  // when requests complete). `cooldown` requires a `run_duration` and
+  // `warmup + cooldown` must be less than `run_duration`.
+  std::chrono::milliseconds warmup{0};
+  std::chrono::milliseconds cooldown{0};
+
+  // If set to true, workers measure latencies using the processor's time stamp
+  // counter instead of `std::chrono::steady_clock`, which is cheaper to read.
+  // Latencies are converted into nanoseconds using a calibrated tick period.
+  // This option is ignored (i.e., the steady clock is used) if the processor
+  // does not have an invariant time stamp counter.
+  bool use_cycle_counter = false;
+
   // If set to true, the benchmark will fail if any request fails. This should
   // only be used if you expect all requests to succeed (e.g., there are no
   // negative lookups and no updates of non-existent keys).
@@ -34,6 +80,34 @@ struct RunOptions {
 
   // An optional prefix for throughput sample output files.
   std::string throughput_output_file_prefix;
+
+  // If non-zero, a monitor thread reports metrics for the whole run (i.e., for
+  // all workers combined) every `live_metrics_period`: the throughput and, for
+  // each type of request, the number of successful and failed requests and the
+  // p50 and p99 latencies during the period. The workers only update in-memory
+  // counters; the monitor thread writes the metrics to
+  // `output_dir / live_metrics_file` (with a ".csv" or ".jsonl" extension, see
+  // `live_metrics_format`). Live latencies are approximate (within about 3%).
+  std::chrono::milliseconds live_metrics_period{0};
+  std::string live_metrics_file = "live_metrics";
+  enum class LiveMetricsFormat { kCSV, kJSONLines };
+  LiveMetricsFormat live_metrics_format = LiveMetricsFormat::kCSV;
+
+  // If positive, each worker runs "open-loop": it sends its requests following
+  // an arrival schedule with this rate (requests per second, per worker)
+  // instead of sending its next request as soon as the previous one completes.
+  // Latencies are then measured from each request's *intended* send time, so
+  // any queueing delay caused by a slow request is counted against the requests
+  // scheduled behind it (i.e., this avoids "coordinated omission").
+  double target_requests_per_second_per_worker = 0.0;
+
+  // The inter-arrival time distribution used when running open-loop.
+  enum class ArrivalProcess { kConstant, kPoisson };
+  ArrivalProcess arrival_process = ArrivalProcess::kConstant;
+
+  // Used to seed the Poisson arrival schedule. Each worker adds its ID to this
+  // seed, so workers do not share the same schedule.
+  uint32_t arrival_seed = 42;
 };
 
 }  // namespace ycsbr
@@ -4,12 +4,25 @@
 #include <vector>
 
 #include "benchmark_result.h"
+#include "impl/flag.h"
 #include "impl/thread_pool.h"
 #include "run_options.h"
 #include "trace.h"
 
 namespace ycsbr {
 
+// Controls how a `Session` places its worker threads.
+enum class ThreadPlacement {
+  // The worker threads are not pinned to cores.
+  kUnpinned,
+  // The worker threads are pinned to cores round-robin across the machine's
+  // NUMA nodes (worker `i` runs on node `i % num_nodes`). Each worker also
+  // constructs its executor (which holds the worker's request producer and
+  // metrics buffers), so that the memory the executor allocates is first
+  // touched by (and placed on) the worker's NUMA node.
+  kNumaAware,
+};
+
 template <class DatabaseInterface>
 class Session {
  public:
@@ -22,6 +35,10 @@ class Session {
   Session(size_t num_threads,
           const std::vector<size_t>& core_map = std::vector<size_t>());
 
+  // Starts a benchmark session that places its `num_threads` threads as
+  // specified by `placement`.
+  Session(size_t num_threads, ThreadPlacement placement);
+
   // Calls `DatabaseInterface::InitializeDatabase()` on a single worker thread.
   // This must be called before any of the Replay/Run methods. This method
   // should also only be called at most once.
@@ -57,10 +74,29 @@ class Session {
                               const RunOptions& options = RunOptions());
 
  private:
+  template <class CustomWorkload, typename Clock>
+  BenchmarkResult RunWorkloadImpl(const CustomWorkload& workload,
+                                  const RunOptions& options);
+
+  // Constructs each executor on the worker thread that runs it.
+  template <class Runner, class Producer>
+  void StartExecutorsOnWorkers(
+      std::vector<Producer> producers, impl::Flag* can_start,
+      const RunOptions& options,
+      std::vector<std::unique_ptr<Runner>>* executors);
+
+  // Used when an executor fails to start. Makes the executors that did start
+  // exit before they issue their first request and waits for them to finish.
+  template <class Runner>
+  static void AbortExecutors(
+      const std::vector<std::unique_ptr<Runner>>& executors,
+      impl::Flag* can_start);
+
   DatabaseInterface db_;
   std::unique_ptr<impl::ThreadPool> threads_;
   size_t num_threads_;
   bool initialized_;
+  bool numa_aware_;
 };
 
 }  // namespace ycsbr
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "impl/trace_format.h"
+#include "request.h"
+#include "trace.h"
+
+namespace ycsbr {
+
+// Replays a trace file without loading the whole trace into memory (e.g., for
+// traces that are larger than the available memory).
+//
+// Each producer replays a contiguous slice of the trace. During `Prepare()`,
+// each producer starts a background thread that reads and decodes its slice of
+// the file one block at a time. The producer consumes one block while the
+// background thread fills the next one (double buffering), so disk I/O is not
+// on the request path. Memory usage is bounded by the block size (per
+// producer), not the trace's size.
+//
+// For traces in the v3 format (see `TraceWriter`), the constructor only reads
+// the trace's header and block index, and each producer only reads the blocks
+// that hold its slice. For legacy traces, the constructor reads through the
+// trace file once to count its requests and to build a sparse index of request
+// offsets (requests have variable sizes).
+//
+// Sorting the requests (`Trace::Options::sort_requests`) is not supported.
+class StreamingTraceWorkload {
+ public:
+  static constexpr size_t kDefaultRequestsPerBlock = 1ULL << 16;
+
+  StreamingTraceWorkload(std::string file, const Trace::Options& options,
+                         size_t requests_per_block = kDefaultRequestsPerBlock);
+
+  // The total number of requests in the trace.
+  size_t size() const { return num_requests_; }
+
+  class Producer;
+  std::vector<Producer> GetProducers(size_t num_producers) const;
+
+ private:
+  class Reader;
+
+  std::string file_;
+  Trace::Options options_;
+  size_t requests_per_block_;
+  size_t num_requests_;
+  // Whether the trace uses the v3 (block-based) format.
+  bool is_v3_;
+  // Used for v3 traces.
+  impl::TraceV3Index v3_index_;
+  // Used for legacy traces: the byte offset of every
+  // `impl::kTraceRecordsPerChunk`-th request, and the number of writes that
+  // precede it.
+  std::vector<size_t> checkpoints_;
+  std::vector<size_t> checkpoint_writes_;
+  // All values stored contiguously (shared by all producers).
+  std::unique_ptr<char[]> values_;
+};
+
+class StreamingTraceWorkload::Producer {
+ public:
+  Producer(Producer&&) noexcept;
+  Producer& operator=(Producer&&) noexcept;
+  ~Producer();
+
+  void Prepare();
+  bool HasNext() const { return remaining_ > 0; }
+  Request Next();
+
+ private:
+  friend class StreamingTraceWorkload;
+  Producer(const StreamingTraceWorkload* workload, size_t start_index,
+           size_t num_requests);
+
+  // Waits for the next block of requests to be decoded.
+  void NextBlock();
+
+  const StreamingTraceWorkload* workload_;
+  size_t start_index_;
+  size_t num_requests_;
+  size_t remaining_;
+
+  std::unique_ptr<Reader> reader_;
+  const Request* block_;
+  size_t block_size_;
+  size_t block_index_;
+};
+
+}  // namespace ycsbr
+
+#include "impl/streaming_trace_workload-inl.h"
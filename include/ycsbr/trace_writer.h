@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "impl/trace_format.h"
+#include "request.h"
+
+namespace ycsbr {
+
+// Writes a trace file that can be loaded using `Trace::LoadFromFile()` or
+// replayed using `StreamingTraceWorkload`.
+//
+// Two formats are supported. The legacy format stores the requests as a packed
+// stream of `Request::Encoded` records. The v3 format stores the requests in
+// compressed fixed-size blocks and includes a block index, which allows
+// readers to split the trace among threads without scanning it (see
+// `impl/trace_format.h`).
+class TraceWriter {
+ public:
+  enum class Format { kLegacy, kV3 };
+  static constexpr size_t kDefaultRequestsPerBlock = 4096;
+
+  // Throws `std::runtime_error` if the file cannot be opened for writing.
+  TraceWriter(const std::string& file, Format format = Format::kV3,
+              size_t requests_per_block = kDefaultRequestsPerBlock);
+
+  // Calls `Close()` if it has not already been called.
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  // Only the request's operation, key, and scan amount are written.
+  void Write(const Request& request);
+
+  // Writes out any buffered requests (and the v3 index and header).
+  void Close();
+
+  size_t NumRequests() const { return num_requests_; }
+
+ private:
+  // Legacy requests are buffered and written out in large writes.
+  static constexpr size_t kWriteBufferSize = 1ULL << 20;
+
+  void FlushBlock();
+
+  std::ofstream output_;
+  const Format format_;
+  const size_t requests_per_block_;
+  bool closed_;
+  size_t num_requests_;
+
+  // Encoded requests that have not been written yet.
+  std::string encoded_;
+
+  // Used by the v3 format.
+  impl::TraceV3Header header_;
+  std::vector<Request> block_;
+  std::vector<uint64_t> block_offsets_;
+  // The number of writes that precede each block.
+  std::vector<uint64_t> block_writes_;
+  uint64_t offset_;
+  // The number of writes in the flushed blocks.
+  uint64_t num_writes_;
+};
+
+// Implementation details follow.
+
+inline TraceWriter::TraceWriter(const std::string& file, const Format format,
+                                const size_t requests_per_block)
+    : output_(file, std::ios::out | std::ios::binary | std::ios::trunc),
+      format_(format),
+      requests_per_block_(requests_per_block),
+      closed_(false),
+      num_requests_(0),
+      header_(),
+      offset_(0),
+      num_writes_(0) {
+  if (!output_) {
+    throw std::runtime_error("Failed to open trace file for writing: " + file);
+  }
+  if (requests_per_block_ == 0 ||
+      requests_per_block_ > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Invalid number of requests per block.");
+  }
+  output_.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+  if (format_ == Format::kV3) {
+    // The header is rewritten with the final counts in `Close()`.
+    std::copy(std::begin(impl::kTraceV3Magic), std::end(impl::kTraceV3Magic),
+              header_.magic);
+    header_.version = impl::kTraceV3Version;
+    header_.requests_per_block = static_cast<uint32_t>(requests_per_block_);
+    header_.min_key = std::numeric_limits<uint64_t>::max();
+    header_.max_key = 0;
+    output_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    offset_ = sizeof(header_);
+    block_.reserve(requests_per_block_);
+  } else {
+    encoded_.reserve(kWriteBufferSize + sizeof(Request::Encoded) +
+                     sizeof(uint32_t));
+  }
+}
+
+inline TraceWriter::~TraceWriter() {
+  if (closed_) return;
+  try {
+    Close();
+  } catch (...) {
+    // Destructors must not throw. Call `Close()` directly to observe errors.
+  }
+}
+
+inline void TraceWriter::Write(const Request& request) {
+  if (closed_) {
+    throw std::logic_error("Cannot write to a closed TraceWriter.");
+  }
+  ++num_requests_;
+  if (format_ == Format::kLegacy) {
+    const Request::Encoded encoded(request.op, request.key);
+    encoded_.append(reinterpret_cast<const char*>(&encoded), sizeof(encoded));
+    if (request.op == Request::Operation::kScan) {
+      encoded_.append(reinterpret_cast<const char*>(&request.scan_amount),
+                      sizeof(request.scan_amount));
+    }
+    if (encoded_.size() >= kWriteBufferSize) {
+      output_.write(encoded_.data(), encoded_.size());
+      encoded_.clear();
+    }
+    return;
+  }
+
+  const size_t op_index = static_cast<size_t>(request.op);
+  if (op_index >= Request::kNumOperations) {
+    throw std::invalid_argument("Invalid request operation.");
+  }
+  header_.op_counts[op_index] += 1;
+  header_.min_key = std::min(header_.min_key, request.key);
+  header_.max_key = std::max(header_.max_key, request.key);
+  block_.push_back(request);
+  if (block_.size() == requests_per_block_) {
+    FlushBlock();
+  }
+}
+
+inline void TraceWriter::FlushBlock() {
+  if (block_.empty()) return;
+  encoded_.clear();
+  impl::EncodeTraceV3Block(block_.data(), block_.size(), &encoded_);
+  output_.write(encoded_.data(), encoded_.size());
+  block_offsets_.push_back(offset_);
+  offset_ += encoded_.size();
+  block_writes_.push_back(num_writes_);
+  for (const Request& req : block_) {
+    num_writes_ += impl::IsTraceWrite(req.op);
+  }
+  block_.clear();
+}
+
+inline void TraceWriter::Close() {
+  if (closed_) return;
+  closed_ = true;
+  if (format_ == Format::kLegacy) {
+    output_.write(encoded_.data(), encoded_.size());
+    encoded_.clear();
+  } else {
+    FlushBlock();
+    output_.write(reinterpret_cast<const char*>(block_offsets_.data()),
+                  block_offsets_.size() * sizeof(uint64_t));
+    output_.write(reinterpret_cast<const char*>(block_writes_.data()),
+                  block_writes_.size() * sizeof(uint64_t));
+    header_.num_requests = num_requests_;
+    header_.num_blocks = block_offsets_.size();
+    header_.index_offset = offset_;
+    if (num_requests_ == 0) {
+      header_.min_key = 0;
+    }
+    output_.seekp(0);
+    output_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+  }
+  output_.close();
+}
+
+}  // namespace ycsbr
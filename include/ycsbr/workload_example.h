@@ -31,6 +31,12 @@ class ExampleCustomWorkload::Producer final {
 
   // This method may also return a `const Request&`.
   virtual Request Next() = 0;
+
+  // Optional. Returns the ID of the phase that the request most recently
+  // returned by `Next()` belongs to (phase IDs start at 0). If implemented,
+  // the benchmark's results are also broken down by phase (see
+  // `BenchmarkResult::PerPhase()`).
+  virtual size_t CurrentPhase() const = 0;
 };
 
 }  // namespace ycsbr
@@ -11,14 +11,22 @@
 // to the `ycsbr-gen` CMake library target. Note that the `ycsbr-gen` library is
 // not a header-only library.
 
+#include "async_callback.h"
 #include "benchmark_result.h"
 #include "benchmark.h"
 #include "buffered_workload.h"
 #include "db_example.h"
+#include "latency_histogram.h"
+#include "looping_workload.h"
 #include "meter.h"
+#include "persisted_workload.h"
+#include "pipelined_workload.h"
+#include "record_buffer.h"
 #include "request.h"
 #include "run_options.h"
 #include "session.h"
+#include "streaming_trace_workload.h"
 #include "trace_workload.h"
 #include "trace.h"
+#include "trace_writer.h"
 #include "workload_example.h"
@@ -149,7 +149,64 @@ PYBIND11_MODULE(ycsbr_py, m) {
       .def_property_readonly("num_failed_writes",
                              [](const ycsbr::BenchmarkResult& result) {
                                return result.NumFailedWrites();
-                             });
+                             })
+      .def(
+          "read_latency_percentile_ns",
+          [](const ycsbr::BenchmarkResult& result, const double percentile) {
+            return result.Reads()
+                .LatencyPercentile<std::chrono::nanoseconds>(percentile)
+                .count();
+          },
+          py::arg("percentile"))
+      .def(
+          "write_latency_percentile_ns",
+          [](const ycsbr::BenchmarkResult& result, const double percentile) {
+            return result.Writes()
+                .LatencyPercentile<std::chrono::nanoseconds>(percentile)
+                .count();
+          },
+          py::arg("percentile"))
+      .def(
+          "scan_latency_percentile_ns",
+          [](const ycsbr::BenchmarkResult& result, const double percentile) {
+            return result.Scans()
+                .LatencyPercentile<std::chrono::nanoseconds>(percentile)
+                .count();
+          },
+          py::arg("percentile"))
+      .def_property_readonly(
+          "num_rmws",
+          [](const ycsbr::BenchmarkResult& result) {
+            return result
+                .ForOperation(ycsbr::Request::Operation::kReadModifyWrite)
+                .NumRequests();
+          })
+      .def_property_readonly(
+          "num_negative_reads",
+          [](const ycsbr::BenchmarkResult& result) {
+            return result.ForOperation(ycsbr::Request::Operation::kNegativeRead)
+                .NumRequests();
+          })
+      .def(
+          "rmw_latency_percentile_ns",
+          [](const ycsbr::BenchmarkResult& result, const double percentile) {
+            return result
+                .ForOperation(ycsbr::Request::Operation::kReadModifyWrite)
+                .LatencyPercentile<std::chrono::nanoseconds>(percentile)
+                .count();
+          },
+          py::arg("percentile"))
+      .def(
+          "negative_read_latency_percentile_ns",
+          [](const ycsbr::BenchmarkResult& result, const double percentile) {
+            return result.ForOperation(ycsbr::Request::Operation::kNegativeRead)
+                .LatencyPercentile<std::chrono::nanoseconds>(percentile)
+                .count();
+          },
+          py::arg("percentile"))
+      .def_property_readonly("per_executor",
+                             &ycsbr::BenchmarkResult::PerExecutor)
+      .def_property_readonly("per_phase", &ycsbr::BenchmarkResult::PerPhase);
 
   // yscbr::Session binding for a delegating database
   py::class_<Session>(m, "Session")
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "ycsbr/async_callback.h"
+#include "ycsbr/record_buffer.h"
 #include "ycsbr/request.h"
 #include "ycsbr/trace.h"
 
@@ -154,4 +159,132 @@ class InsertTraceInterface {
   std::vector<Request::Key> insert_trace;
 };
 
+// Supports batched reads and writes. Keeps track of the batches it receives.
+class BatchingInterface : public TestDatabaseInterface {
+ public:
+  size_t ReadBatch(const std::vector<Request::Key>& keys,
+                   std::vector<std::string>* values_out) {
+    read_batch_sizes.push_back(keys.size());
+    for (auto& value : *values_out) {
+      value = "batched!";
+    }
+    return keys.size();
+  }
+  size_t WriteBatch(const std::vector<Request>& requests) {
+    write_batch_sizes.push_back(requests.size());
+    for (const auto& req : requests) {
+      if (req.op != requests.front().op) {
+        mixed_write_batches = true;
+      }
+    }
+    return requests.size();
+  }
+
+  std::vector<size_t> read_batch_sizes;
+  std::vector<size_t> write_batch_sizes;
+  bool mixed_write_batches = false;
+};
+
+// Implements `ReadInto()` and `ScanInto()`. Every record's value is "buffer!".
+class RecordBufferInterface : public TestDatabaseInterface {
+ public:
+  bool ReadInto(Request::Key key, RecordBuffer* value_out) {
+    ++read_into_calls;
+    non_empty_buffers += !value_out->empty();
+    value_out->Append(key, "buffer!", 7);
+    return true;
+  }
+  bool ScanInto(Request::Key key, size_t amount, RecordBuffer* scan_out) {
+    ++scan_into_calls;
+    non_empty_buffers += !scan_out->empty();
+    for (size_t i = 0; i < amount; ++i) {
+      scan_out->Append(key + i, "buffer!", 7);
+    }
+    return true;
+  }
+
+  size_t read_into_calls = 0;
+  size_t scan_into_calls = 0;
+  size_t non_empty_buffers = 0;
+};
+
+// Implements the asynchronous interface. Requests complete when the worker
+// calls `PollAsync()`. Meant to be used by one worker thread.
+class AsyncInterface : public TestDatabaseInterface {
+ public:
+  void ReadAsync(Request::Key key, std::string* value_out,
+                 AsyncCallback callback) {
+    ++read_calls;
+    value_out->assign("async!!!");
+    Enqueue(callback);
+  }
+  void InsertAsync(Request::Key key, const char* value, size_t value_size,
+                   AsyncCallback callback) {
+    ++insert_calls;
+    Enqueue(callback);
+  }
+  void UpdateAsync(Request::Key key, const char* value, size_t value_size,
+                   AsyncCallback callback) {
+    ++update_calls;
+    Enqueue(callback);
+  }
+  void ScanAsync(Request::Key key, size_t amount,
+                 std::vector<std::pair<Request::Key, std::string>>* scan_out,
+                 AsyncCallback callback) {
+    ++scan_calls;
+    for (size_t i = 0; i < amount; ++i) {
+      scan_out->emplace_back(key, "async!!!");
+    }
+    Enqueue(callback);
+  }
+  void PollAsync() {
+    ++poll_calls;
+    std::vector<AsyncCallback> completed;
+    completed.swap(in_flight);
+    for (const auto& callback : completed) {
+      callback(true);
+    }
+  }
+
+  std::vector<AsyncCallback> in_flight;
+  size_t max_in_flight = 0;
+  size_t poll_calls = 0;
+
+ private:
+  void Enqueue(AsyncCallback callback) {
+    in_flight.push_back(callback);
+    max_in_flight = std::max(max_in_flight, in_flight.size());
+  }
+};
+
+// The first read stalls for `kStallTime`; all other operations are no-ops.
+class StallOnFirstReadInterface {
+ public:
+  static constexpr std::chrono::milliseconds kStallTime{5};
+
+  void InitializeWorker(const std::thread::id& worker_id) {}
+  void ShutdownWorker(const std::thread::id& worker_id) {}
+  void InitializeDatabase() {}
+  void ShutdownDatabase() {}
+  void BulkLoad(const BulkLoadTrace& load) {}
+  bool Update(Request::Key key, const char* value, size_t value_size) {
+    return true;
+  }
+  bool Insert(Request::Key key, const char* value, size_t value_size) {
+    return true;
+  }
+  bool Read(Request::Key key, std::string* value_out) {
+    if (!stalled.exchange(true)) {
+      std::this_thread::sleep_for(kStallTime);
+    }
+    return true;
+  }
+  bool Scan(Request::Key key, size_t amount,
+            std::vector<std::pair<Request::Key, std::string>>* scan_out) {
+    return true;
+  }
+
+  std::atomic<bool> stalled = false;
+};
+
 }  // namespace ycsbr
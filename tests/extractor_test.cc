@@ -0,0 +1,165 @@
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../extractors/ycsb_extractor.h"
+#include "gtest/gtest.h"
+#include "ycsbr/ycsbr.h"
+
+namespace {
+
+using namespace ycsbr;
+using namespace ycsbr::extractor;
+
+class ExtractorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    input_file_ = std::filesystem::temp_directory_path() / "ycsb_output.txt";
+    trace_file_ = std::filesystem::temp_directory_path() / "ycsb_trace.ycsb";
+    std::filesystem::remove(trace_file_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(input_file_);
+    std::filesystem::remove(trace_file_);
+  }
+
+  // Extracts the trace from `output` (the benchmark driver's output) and
+  // returns the number of skipped requests.
+  size_t Extract(const std::string& output, const ExtractorOptions& options) {
+    FILE* input = fopen(input_file_.c_str(), "wb");
+    fwrite(output.data(), 1, output.size(), input);
+    fclose(input);
+    input = fopen(input_file_.c_str(), "rb");
+    try {
+      const size_t num_skipped = ExtractYCSBTrace(input, trace_file_, options);
+      fclose(input);
+      return num_skipped;
+    } catch (...) {
+      fclose(input);
+      throw;
+    }
+  }
+
+  Trace LoadTrace() const {
+    return Trace::LoadFromFile(trace_file_, Trace::Options());
+  }
+
+  std::filesystem::path input_file_, trace_file_;
+};
+
+TEST_F(ExtractorTest, SplitsLinesAcrossChunksAndPieces) {
+  constexpr size_t kNumRequests = 1000;
+  std::string output = "Loading workload...\nStarting test.\n";
+  std::vector<Request> expected;
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    const Request::Key key = i * 7919;
+    switch (i % 5) {
+      case 0:
+        output += "READ usertable user" + std::to_string(key) +
+                  " [ <all fields>]\n";
+        expected.emplace_back(Request::Operation::kRead, key, 0, nullptr, 0);
+        break;
+      case 1:
+        output += "UPDATE usertable user" + std::to_string(key) +
+                  " [ field0=abc ]\n";
+        expected.emplace_back(Request::Operation::kUpdate, key, 0, nullptr, 0);
+        break;
+      case 2:
+        output += "INSERT usertable user" + std::to_string(key) +
+                  " [ field0=abc ]\n";
+        expected.emplace_back(Request::Operation::kInsert, key, 0, nullptr, 0);
+        break;
+      case 3:
+        output += "SCAN usertable user" + std::to_string(key) + " " +
+                  std::to_string(i % 100 + 1) + " [ <all fields>]\n";
+        expected.emplace_back(Request::Operation::kScan, key, i % 100 + 1,
+                              nullptr, 0);
+        break;
+      case 4:
+        output += "READMODIFYWRITE usertable user" + std::to_string(key) +
+                  " [ <all fields>] [ field0=abc ]\n";
+        expected.emplace_back(Request::Operation::kReadModifyWrite, key, 0,
+                              nullptr, 0);
+        break;
+    }
+  }
+  // The last line does not end with a newline.
+  output += "READ usertable user42 [ <all fields>]";
+  expected.emplace_back(Request::Operation::kRead, 42, 0, nullptr, 0);
+
+  // Small chunks (smaller than some lines) and many threads make most lines
+  // span a chunk or a piece boundary.
+  for (const size_t chunk_size : {size_t{16}, size_t{1000}, size_t{64} << 20}) {
+    for (const auto format :
+         {TraceWriter::Format::kLegacy, TraceWriter::Format::kV3}) {
+      ExtractorOptions options;
+      options.chunk_size = chunk_size;
+      options.num_threads = 4;
+      options.format = format;
+      std::filesystem::remove(trace_file_);
+      ASSERT_EQ(Extract(output, options), 0);
+
+      const Trace trace = LoadTrace();
+      ASSERT_EQ(trace.size(), expected.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(trace[i].op, expected[i].op);
+        ASSERT_EQ(trace[i].key, expected[i].key);
+        ASSERT_EQ(trace[i].scan_amount, expected[i].scan_amount);
+      }
+    }
+  }
+}
+
+TEST_F(ExtractorTest, KeyPrefix) {
+  ExtractorOptions options;
+  options.key_prefix = "key";
+  options.chunk_size = 32;
+  ASSERT_EQ(Extract("READ usertable key123 [ <all fields>]\n"
+                    "UPDATE usertable key7 [ field0=abc ]\n",
+                    options),
+            0);
+  const Trace trace = LoadTrace();
+  ASSERT_EQ(trace.size(), 2);
+  ASSERT_EQ(trace[0].key, 123);
+  ASSERT_EQ(trace[1].key, 7);
+}
+
+TEST_F(ExtractorTest, MalformedKeys) {
+  const ExtractorOptions options;
+  // The key does not start with the prefix.
+  ASSERT_THROW(Extract("READ usertable key123 [ <all fields>]\n", options),
+               std::runtime_error);
+  // The key is not a number.
+  std::filesystem::remove(trace_file_);
+  ASSERT_THROW(Extract("READ usertable user12x [ <all fields>]\n", options),
+               std::runtime_error);
+  // The key is out of range.
+  std::filesystem::remove(trace_file_);
+  ASSERT_THROW(
+      Extract("READ usertable user99999999999999999999 [ <all fields>]\n",
+              options),
+      std::runtime_error);
+  // The scan amount is missing.
+  std::filesystem::remove(trace_file_);
+  ASSERT_THROW(Extract("SCAN usertable user1\n", options),
+               std::runtime_error);
+}
+
+TEST_F(ExtractorTest, SkipsDeletes) {
+  ExtractorOptions options;
+  options.chunk_size = 16;
+  ASSERT_EQ(Extract("DELETE usertable user1\n"
+                    "READ usertable user2 [ <all fields>]\n"
+                    "DELETE usertable user3\n",
+                    options),
+            2);
+  const Trace trace = LoadTrace();
+  ASSERT_EQ(trace.size(), 1);
+  ASSERT_EQ(trace[0].op, Request::Operation::kRead);
+  ASSERT_EQ(trace[0].key, 2);
+}
+
+}  // namespace
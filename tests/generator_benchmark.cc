@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../generator/hash.h"
+#include "../generator/rejection_inversion_zipfian_chooser.h"
 #include "../generator/sampling.h"
 #include "../generator/zipfian_chooser.h"
 #include "benchmark/benchmark.h"
@@ -105,6 +106,60 @@ void BM_ZipfianGen(benchmark::State& state) {
   }
 }
 
+void BM_ScatteredZipfianGenBatch(benchmark::State& state) {
+  const size_t batch_size = state.range(0);
+  PRNG prng(42);
+  ScatteredZipfianChooser zipf(10000000, 0.99);
+  std::vector<size_t> choices(batch_size);
+  for (auto _ : state) {
+    if (batch_size == 1) {
+      benchmark::DoNotOptimize(choices[0] = zipf.Next(prng));
+    } else {
+      zipf.NextBatch(prng, choices.data(), batch_size);
+      benchmark::DoNotOptimize(choices.data());
+    }
+  }
+  state.SetItemsProcessed(batch_size * state.iterations());
+}
+
+void BM_RejectionInversionZipfianGen(benchmark::State& state) {
+  const size_t item_count = state.range(0);
+  PRNG prng(42);
+  RejectionInversionZipfianChooser zipf(item_count, 0.99);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(zipf.Next(prng));
+  }
+}
+
+template <PRNG::Type type>
+void BM_PRNG(benchmark::State& state) {
+  std::vector<PRNG::result_type> values;
+  values.reserve(state.range(0));
+
+  PRNG prng(42, type);
+  for (auto _ : state) {
+    values.clear();
+    for (uint64_t i = 0; i < state.range(0); ++i) {
+      values.push_back(prng());
+    }
+  }
+
+  const size_t num_values = state.range(0) * state.iterations();
+  state.SetItemsProcessed(num_values);
+  state.counters["PerNumLatency"] = benchmark::Counter(
+      num_values, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+template <PRNG::Type type>
+void BM_ZipfianGenWithPRNG(benchmark::State& state) {
+  const size_t item_count = state.range(0);
+  PRNG prng(42, type);
+  ZipfianChooser zipf(item_count, 0.99);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(zipf.Next(prng));
+  }
+}
+
 void BM_FloydSample(benchmark::State& state) {
   const size_t sample_size = state.range(0);
   const size_t range_size = state.range(1);
@@ -137,6 +192,22 @@ void BM_FisherYatesSample(benchmark::State& state) {
                                                 benchmark::Counter::kInvert);
 }
 
+void BM_VitterSample(benchmark::State& state) {
+  const size_t sample_size = state.range(0);
+  const size_t range_size = state.range(1);
+  PRNG rng(42);
+  std::vector<uint64_t> samples(sample_size, 0);
+  for (auto _ : state) {
+    VitterSample<uint64_t, PRNG>(
+        sample_size, Range<uint64_t>(0, range_size - 1), &samples, 0, rng);
+  }
+  const size_t num_samples_taken = state.range(0) * state.iterations();
+  state.SetItemsProcessed(num_samples_taken);
+  state.counters["PerSampleLatency"] =
+      benchmark::Counter(num_samples_taken, benchmark::Counter::kIsRate |
+                                                benchmark::Counter::kInvert);
+}
+
 void BM_SelectionSample(benchmark::State& state) {
   const size_t sample_size = state.range(0);
   const size_t range_size = state.range(1);
@@ -274,6 +345,20 @@ BENCHMARK(BM_MersenneTwister)->Arg(10000);
 BENCHMARK(BM_UniformDist)->Arg(10000);
 BENCHMARK(BM_MathPow)->Arg(10000);
 BENCHMARK(BM_ZipfianGen)->Arg(10000000);
+BENCHMARK(BM_RejectionInversionZipfianGen)->Arg(10000000);
+BENCHMARK(BM_ScatteredZipfianGenBatch)->Arg(1)->Arg(64);
+
+// Compares the PRNGs that can be selected for the workload generator.
+BENCHMARK_TEMPLATE(BM_PRNG, PRNG::Type::kMT19937)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_PRNG, PRNG::Type::kXoshiro256StarStar)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_PRNG, PRNG::Type::kPCG64)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_PRNG, PRNG::Type::kWyRand)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_ZipfianGenWithPRNG, PRNG::Type::kMT19937)
+    ->Arg(10000000);
+BENCHMARK_TEMPLATE(BM_ZipfianGenWithPRNG, PRNG::Type::kXoshiro256StarStar)
+    ->Arg(10000000);
+BENCHMARK_TEMPLATE(BM_ZipfianGenWithPRNG, PRNG::Type::kPCG64)->Arg(10000000);
+BENCHMARK_TEMPLATE(BM_ZipfianGenWithPRNG, PRNG::Type::kWyRand)->Arg(10000000);
 BENCHMARK(BM_PhasedWorkloadOverheadUniform)->UseManualTime();
 BENCHMARK(BM_MultiphaseWorkloadOverhead)->UseManualTime();
 
@@ -304,6 +389,19 @@ BENCHMARK(BM_FisherYatesSample)
     ->Args({100000000, 500000000})
     ->Unit(benchmark::kMillisecond);
 
+// Vitter's Method D produces sorted samples without extra memory (all the other
+// algorithms above need either a hash table or O(N) time).
+BENCHMARK(BM_VitterSample)
+    ->Args({100, 500000000})
+    ->Args({1000, 500000000})
+    ->Args({10000, 500000000})
+    ->Args({100000, 500000000})
+    ->Args({1000000, 500000000})
+    ->Args({10000000, 500000000})
+    ->Args({100000000, 500000000})
+    ->Args({100000000, 1LL << 48})
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK(BM_SelectionSample)
     ->Args({100, 500000000})
     ->Args({1000, 500000000})
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -7,7 +9,9 @@
 #include "../generator/hotspot_keygen.h"
 #include "../generator/latest_chooser.h"
 #include "../generator/linspace_keygen.h"
+#include "../generator/rejection_inversion_zipfian_chooser.h"
 #include "../generator/sampling.h"
+#include "../generator/uniform_chooser.h"
 #include "../generator/uniform_keygen.h"
 #include "../generator/zipfian_chooser.h"
 #include "db_interface.h"
@@ -19,6 +23,91 @@ namespace {
 using namespace ycsbr;
 using namespace ycsbr::gen;
 
+TEST(GeneratorTest, PRNGTypes) {
+  // The default generator must produce the same sequences as `std::mt19937`.
+  PRNG default_prng(42);
+  std::mt19937 mt(42);
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(default_prng(), mt());
+  }
+
+  for (const auto type :
+       {PRNG::Type::kMT19937, PRNG::Type::kXoshiro256StarStar,
+        PRNG::Type::kPCG64, PRNG::Type::kWyRand}) {
+    ASSERT_EQ(PRNG::TypeFromString(PRNG::TypeName(type)), type);
+    // The same seed should produce the same sequence.
+    PRNG prng1(1337, type), prng2(1337, type);
+    for (size_t i = 0; i < 1000; ++i) {
+      ASSERT_EQ(prng1(), prng2());
+    }
+    // Copies should continue the sequence independently.
+    PRNG copy(prng1);
+    ASSERT_EQ(copy(), prng1());
+
+    // Make sure the values are roughly uniform.
+    constexpr size_t num_samples = 100000;
+    std::uniform_int_distribution<uint64_t> dist(0, 9);
+    std::vector<size_t> counts(10, 0);
+    for (size_t i = 0; i < num_samples; ++i) {
+      ++counts[dist(prng1)];
+    }
+    for (const size_t count : counts) {
+      ASSERT_GT(count, num_samples / 10 * 0.95);
+      ASSERT_LT(count, num_samples / 10 * 1.05);
+    }
+
+    // The 64-bit draws should be roughly uniform too.
+    std::fill(counts.begin(), counts.end(), 0);
+    for (size_t i = 0; i < num_samples; ++i) {
+      const double value = prng1.NextDouble();
+      ASSERT_GE(value, 0.0);
+      ASSERT_LT(value, 1.0);
+      ++counts[static_cast<size_t>(value * 10)];
+    }
+    for (const size_t count : counts) {
+      ASSERT_GT(count, num_samples / 10 * 0.95);
+      ASSERT_LT(count, num_samples / 10 * 1.05);
+    }
+  }
+  ASSERT_THROW(PRNG::TypeFromString("lcg"), std::invalid_argument);
+
+  // The default generator's uniform doubles must also stay the same.
+  std::uniform_real_distribution<double> real_dist(0.0, 1.0);
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(default_prng.NextDouble(), real_dist(mt));
+  }
+  // The other generators use one 64-bit output per double.
+  PRNG xoshiro1(7, PRNG::Type::kXoshiro256StarStar),
+      xoshiro2(7, PRNG::Type::kXoshiro256StarStar);
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(xoshiro1.NextDouble(), (xoshiro2.NextUint64() >> 11) * 0x1.0p-53);
+  }
+
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "prng: wyrand\n"
+      "load:\n"
+      "  num_records: 100\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 1\n"
+      "    range_max: 100000\n"
+      "run:\n"
+      "- num_requests: 10\n"
+      "  read:\n"
+      "    proportion_pct: 100\n"
+      "    distribution:\n"
+      "      type: uniform\n";
+  std::unique_ptr<PhasedWorkload> workload =
+      PhasedWorkload::LoadFromString(config);
+  ASSERT_EQ(workload->GetLoadTrace().size(), 100);
+
+  std::string invalid_config = config;
+  invalid_config.replace(invalid_config.find("wyrand"), 6, "lcg");
+  ASSERT_THROW(PhasedWorkload::LoadFromString(invalid_config),
+               std::invalid_argument);
+}
+
 TEST(GeneratorTest, FloydSample) {
   constexpr size_t num_samples = 100;
   constexpr size_t start_index = 10;
@@ -104,6 +193,123 @@ TEST(GeneratorTest, SelectionSample) {
   }
 }
 
+TEST(GeneratorTest, VitterSample) {
+  constexpr size_t start_index = 10;
+  PRNG prng(42);
+  for (const auto& [num_samples, max] : std::vector<std::pair<size_t, uint64_t>>{
+           {100, 500000000}, {1000, 1000}, {1, 1}, {5000, 10000}}) {
+    constexpr uint64_t min = 1;
+    std::vector<uint64_t> samples(num_samples + 20, 0);
+    VitterSample<uint64_t, PRNG>(num_samples, Range<uint64_t>(min, max),
+                                 &samples, start_index, prng);
+    ASSERT_EQ(samples.size(), num_samples + 20);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      if (i >= start_index && i < start_index + num_samples) {
+        const uint64_t val = samples.at(i);
+        ASSERT_TRUE(val >= min);
+        ASSERT_TRUE(val <= max);
+        // The samples should be unique and in ascending order.
+        if (i > start_index) {
+          ASSERT_LT(samples.at(i - 1), val);
+        }
+      } else {
+        // Should be unchanged.
+        ASSERT_EQ(samples.at(i), 0);
+      }
+    }
+  }
+
+  // Each value should be selected with the same probability.
+  constexpr size_t num_samples = 5;
+  constexpr size_t range_size = 20;
+  constexpr size_t repetitions = 100000;
+  std::vector<uint64_t> samples(num_samples);
+  std::vector<size_t> counts(range_size, 0);
+  for (size_t i = 0; i < repetitions; ++i) {
+    VitterSample<uint64_t, PRNG>(num_samples, Range<uint64_t>(0, range_size - 1),
+                                 &samples, 0, prng);
+    for (const uint64_t val : samples) {
+      ++counts[val];
+    }
+  }
+  const double expected = repetitions * num_samples / range_size;
+  for (const size_t count : counts) {
+    ASSERT_NEAR(count, expected, expected * 0.03);
+  }
+}
+
+// Counts the number of values drawn from the wrapped generator.
+class CountingPRNG {
+ public:
+  using result_type = PRNG::result_type;
+  static constexpr result_type min() { return PRNG::min(); }
+  static constexpr result_type max() { return PRNG::max(); }
+
+  explicit CountingPRNG(uint32_t seed) : prng_(seed), num_draws_(0) {}
+  result_type operator()() {
+    ++num_draws_;
+    return prng_();
+  }
+  size_t num_draws() const { return num_draws_; }
+
+ private:
+  PRNG prng_;
+  size_t num_draws_;
+};
+
+TEST(GeneratorTest, VitterSampleDense) {
+  CountingPRNG prng(42);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  dist(prng);
+  const size_t draws_per_double = prng.num_draws();
+
+  // Dense samples are selected using Method A, which draws one value per
+  // sample (Method D draws at least two).
+  constexpr size_t num_samples = 100000;
+  constexpr uint64_t max = 120000;
+  std::vector<uint64_t> samples(num_samples);
+  const size_t draws_before = prng.num_draws();
+  VitterSample<uint64_t, CountingPRNG>(num_samples, Range<uint64_t>(1, max),
+                                       &samples, 0, prng);
+  ASSERT_LE(prng.num_draws() - draws_before,
+            (num_samples + 1) * draws_per_double);
+  for (size_t i = 0; i < num_samples; ++i) {
+    ASSERT_GE(samples[i], 1);
+    ASSERT_LE(samples[i], max);
+    if (i > 0) {
+      ASSERT_LT(samples[i - 1], samples[i]);
+    }
+  }
+
+  // Selecting every record.
+  VitterSample<uint64_t, CountingPRNG>(num_samples,
+                                       Range<uint64_t>(1, num_samples),
+                                       &samples, 0, prng);
+  for (size_t i = 0; i < num_samples; ++i) {
+    ASSERT_EQ(samples[i], i + 1);
+  }
+
+  // These samples switch from Method D to Method A part way through. Each
+  // value should still be selected with the same probability.
+  constexpr size_t num_sparse_samples = 20;
+  constexpr size_t range_size = 400;
+  constexpr size_t repetitions = 100000;
+  std::vector<uint64_t> sparse_samples(num_sparse_samples);
+  std::vector<size_t> counts(range_size, 0);
+  for (size_t i = 0; i < repetitions; ++i) {
+    VitterSample<uint64_t, CountingPRNG>(
+        num_sparse_samples, Range<uint64_t>(0, range_size - 1),
+        &sparse_samples, 0, prng);
+    for (const uint64_t val : sparse_samples) {
+      ++counts[val];
+    }
+  }
+  const double expected = repetitions * num_sparse_samples / range_size;
+  for (const size_t count : counts) {
+    ASSERT_NEAR(count, expected, expected * 0.08);
+  }
+}
+
 TEST(GeneratorTest, UniformGenerator) {
   constexpr size_t num_samples = 1000;
   constexpr Request::Key min = 10;
@@ -159,6 +365,163 @@ TEST(GeneratorTest, HotspotGenerator) {
   }
 }
 
+TEST(GeneratorTest, NextBatch) {
+  constexpr size_t kItemCount = 100000;
+  std::vector<std::unique_ptr<Chooser>> choosers;
+  choosers.push_back(std::make_unique<UniformChooser>(kItemCount));
+  choosers.push_back(std::make_unique<ZipfianChooser>(kItemCount, 0.99));
+  choosers.push_back(
+      std::make_unique<ScatteredZipfianChooser>(kItemCount, 0.99, 123));
+  choosers.push_back(std::make_unique<LatestChooser>(kItemCount, 0.99));
+  choosers.push_back(
+      std::make_unique<RejectionInversionZipfianChooser>(kItemCount, 1.2));
+  choosers.push_back(std::make_unique<ScatteredRejectionInversionZipfianChooser>(
+      kItemCount, 0.99, 123));
+
+  // A batch should contain the same values as repeated calls to `Next()`.
+  for (const auto& chooser : choosers) {
+    PRNG prng1(42), prng2(42);
+    std::vector<size_t> batch(1000);
+    chooser->NextBatch(prng1, batch.data(), batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      ASSERT_EQ(batch[i], chooser->Next(prng2));
+    }
+    ASSERT_EQ(prng1(), prng2());
+  }
+}
+
+TEST(GeneratorTest, ParallelLoadKeys) {
+  // Enough keys to be generated in several parts.
+  const std::string uniform_config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 1500000\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 1\n"
+      "    range_max: 100000000\n"
+      "run:\n"
+      "- num_requests: 10\n"
+      "  read:\n"
+      "    proportion_pct: 100\n"
+      "    distribution:\n"
+      "      type: uniform\n";
+  std::string hotspot_config = uniform_config;
+  hotspot_config.replace(hotspot_config.find("    type: uniform"), 17,
+                         "    type: hotspot\n"
+                         "    hot_proportion_pct: 90\n"
+                         "    hot_range_min: 40000000\n"
+                         "    hot_range_max: 50000000");
+  std::string linspace_config = uniform_config;
+  linspace_config.replace(linspace_config.find("    type: uniform"), 17,
+                          "    type: linspace\n"
+                          "    start_key: 7\n"
+                          "    step_size: 3");
+
+  for (const auto& config : {uniform_config, hotspot_config, linspace_config}) {
+    const BulkLoadTrace load1 =
+        PhasedWorkload::LoadFromString(config)->GetLoadTrace();
+    const BulkLoadTrace load2 =
+        PhasedWorkload::LoadFromString(config)->GetLoadTrace();
+    const BulkLoadTrace other_seed =
+        PhasedWorkload::LoadFromString(config, /*prng_seed=*/1)->GetLoadTrace();
+    ASSERT_EQ(load1.size(), 1500000);
+    ASSERT_EQ(load2.size(), load1.size());
+
+    // The keys should be unique, in range, and reproducible.
+    std::vector<Request::Key> keys;
+    keys.reserve(load1.size());
+    size_t num_hot = 0;
+    for (size_t i = 0; i < load1.size(); ++i) {
+      ASSERT_EQ(load1[i].key, load2[i].key);
+      keys.push_back(load1[i].key >> 16);
+      ASSERT_GE(keys.back(), 1);
+      if (keys.back() >= 40000000 && keys.back() <= 50000000) ++num_hot;
+    }
+    std::sort(keys.begin(), keys.end());
+    ASSERT_TRUE(std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+    if (config == hotspot_config) {
+      ASSERT_EQ(num_hot, 1350000);
+      ASSERT_LE(keys.back(), 100000000);
+    } else if (config == uniform_config) {
+      ASSERT_LE(keys.back(), 100000000);
+    } else {
+      ASSERT_EQ(keys.front(), 7);
+      ASSERT_EQ(keys.back(), 7 + 3 * (1500000 - 1));
+    }
+    if (config != linspace_config) {
+      bool same = true;
+      for (size_t i = 0; i < load1.size() && same; ++i) {
+        same = load1[i].key == other_seed[i].key;
+      }
+      ASSERT_FALSE(same);
+    }
+  }
+}
+
+TEST(GeneratorTest, KeySpace) {
+  const KeySpace empty;
+  ASSERT_TRUE(empty.empty());
+
+  const KeySpace computed = KeySpace::Arithmetic(100, 7, 5);
+  ASSERT_FALSE(computed.IsMaterialized());
+  ASSERT_EQ(computed.size(), 5);
+  ASSERT_EQ(computed[0], 100);
+  ASSERT_EQ(computed[4], 128);
+
+  const KeySpace stored = KeySpace::Materialized(
+      std::make_shared<const std::vector<Request::Key>>(computed.ToVector()));
+  ASSERT_TRUE(stored.IsMaterialized());
+  ASSERT_EQ(stored.size(), computed.size());
+  for (size_t i = 0; i < stored.size(); ++i) {
+    ASSERT_EQ(stored[i], computed[i]);
+  }
+}
+
+TEST(GeneratorTest, LinspaceKeysNotStored) {
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 1000\n"
+      "  distribution:\n"
+      "    type: linspace\n"
+      "    start_key: 10\n"
+      "    step_size: 5\n"
+      "run:\n"
+      "- num_requests: 1000\n"
+      "  read:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: zipfian\n"
+      "      theta: 0.99\n"
+      "  update:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: uniform\n";
+  std::unique_ptr<PhasedWorkload> workload =
+      PhasedWorkload::LoadFromString(config);
+  const BulkLoadTrace load = workload->GetLoadTrace(/*sort_requests=*/true);
+  ASSERT_EQ(load.size(), 1000);
+  std::unordered_set<Request::Key> load_keys;
+  for (size_t i = 0; i < load.size(); ++i) {
+    // The generator reserves the lower 16 bits for phase/thread IDs.
+    ASSERT_EQ(load[i].key, (10 + 5 * i) << 16);
+    load_keys.insert(load[i].key);
+  }
+
+  // All requests should be for loaded keys.
+  Session<KeyFrequencyInterface> session(1);
+  session.Initialize();
+  session.RunWorkload(*workload);
+  session.Terminate();
+  size_t num_requests = 0;
+  for (const auto& [key, count] : session.db().key_freqs) {
+    ASSERT_EQ(load_keys.count(key), 1);
+    num_requests += count;
+  }
+  ASSERT_EQ(num_requests, 1000);
+}
+
 TEST(GeneratorTest, RequestProportions) {
   const std::string config =
       "record_size_bytes: 16\n"
@@ -219,7 +582,7 @@ TEST(GeneratorTest, RequestProportions) {
 }
 
 TEST(GeneratorTest, Linspace) {
-  std::mt19937 prng(42);
+  PRNG prng(42);
   std::vector<Request::Key> dest(100, 0);
 
   // Simple case: generate dense keys from 0 to 9 inclusive.
@@ -393,7 +756,7 @@ TEST(GeneratorTest, NegativeLookups) {
 TEST(GeneratorTest, ZipfianSalt) {
   constexpr size_t kItemCount = 100;
   constexpr double kTheta = 0.99;
-  std::mt19937 prng(42);
+  PRNG prng(42);
 
   ScatteredZipfianChooser zipf1(kItemCount, kTheta, 0);
   ScatteredZipfianChooser zipf2(kItemCount, kTheta, 12345);
@@ -431,7 +794,7 @@ TEST(GeneratorTest, ZipfianSalt) {
 TEST(GeneratorTest, LatestChooser) {
   constexpr size_t kItemCount = 100;
   constexpr double kTheta = 0.99;
-  std::mt19937 prng(42);
+  PRNG prng(42);
 
   LatestChooser latest(kItemCount, kTheta);
 
@@ -497,6 +860,76 @@ TEST(GeneratorTest, InsertOnly) {
   ASSERT_EQ(session.db().insert_calls, 100);
 }
 
+TEST(GeneratorTest, PerPhaseResults) {
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 100\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 100\n"
+      "    range_max: 100000\n"
+      "run:\n"
+      "- num_requests: 200\n"
+      "  read:\n"
+      "    proportion_pct: 100\n"
+      "    distribution:\n"
+      "      type: uniform\n"
+      "- num_requests: 100\n"
+      "  insert:\n"
+      "    proportion_pct: 100\n"
+      "    distribution:\n"
+      "      type: uniform\n"
+      "      range_min: 100\n"
+      "      range_max: 100000\n";
+  std::unique_ptr<PhasedWorkload> workload =
+      PhasedWorkload::LoadFromString(config);
+
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  session.ReplayBulkLoadTrace(workload->GetLoadTrace());
+  const BenchmarkResult result = session.RunWorkload(*workload);
+
+  ASSERT_EQ(result.PerExecutor().size(), 2);
+  ASSERT_EQ(result.PerPhase().size(), 2);
+  static_assert(impl::ReportsPhase<PhasedWorkload::Producer>::value);
+  static_assert(impl::ReportsPhase<
+                LoopingWorkload<PhasedWorkload>::Producer>::value);
+  const auto check_phases = [](const BenchmarkResult& result) {
+    ASSERT_EQ(result.PerPhase().size(), 2);
+    const BenchmarkResult& reads = result.PerPhase()[0];
+    const BenchmarkResult& inserts = result.PerPhase()[1];
+    ASSERT_EQ(reads.Reads().NumRequests(), 200);
+    ASSERT_EQ(reads.Writes().NumRequests(), 0);
+    ASSERT_EQ(inserts.Reads().NumRequests(), 0);
+    ASSERT_EQ(inserts.Writes().NumRequests(), 100);
+    ASSERT_LE(reads.RunTime<std::chrono::nanoseconds>(),
+              result.RunTime<std::chrono::nanoseconds>());
+    ASSERT_LE(inserts.RunTime<std::chrono::nanoseconds>(),
+              result.RunTime<std::chrono::nanoseconds>());
+  };
+  check_phases(result);
+
+  size_t num_reads = 0;
+  for (const auto& executor : result.PerExecutor()) {
+    num_reads += executor.Reads().NumRequests();
+  }
+  ASSERT_EQ(num_reads, 200);
+
+  // The workload wrappers keep track of the phases.
+  check_phases(
+      session.RunWorkload(BufferedWorkload<PhasedWorkload>(*workload)));
+  check_phases(
+      session.RunWorkload(PipelinedWorkload<PhasedWorkload>(*workload)));
+  const auto file =
+      std::filesystem::temp_directory_path() / "per_phase_results.ycsbr";
+  PersistedWorkload::Write(*workload, /*num_producers=*/2, file,
+                           /*requests_per_block=*/64);
+  check_phases(session.RunWorkload(PersistedWorkload(file)));
+  std::filesystem::remove(file);
+  session.Terminate();
+}
+
 TEST(GeneratorTest, BufferedWorkload) {
   const std::string config =
       "record_size_bytes: 16\n"
@@ -541,6 +974,175 @@ TEST(GeneratorTest, BufferedWorkload) {
   ASSERT_EQ(session.db().update_calls, 0);
 }
 
+TEST(GeneratorTest, PipelinedWorkload) {
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 100\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 100\n"
+      "    range_max: 100000\n"
+      "run:\n"
+      "- num_requests: 1000\n"
+      "  insert:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: uniform\n"
+      "      range_min: 100\n"
+      "      range_max: 100000\n"
+      "  read:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: uniform\n";
+  std::unique_ptr<PhasedWorkload> workload =
+      PhasedWorkload::LoadFromString(config);
+
+  // The pipelined producers should generate the same requests as the wrapped
+  // producers.
+  PipelinedWorkload<PhasedWorkload>::Options options;
+  options.queue_capacity = 32;
+  PipelinedWorkload<PhasedWorkload> pworkload(*workload, options);
+  auto expected = PhasedWorkload::LoadFromString(config)->GetProducers(2);
+  auto producers = pworkload.GetProducers(2);
+  ASSERT_EQ(producers.size(), expected.size());
+  for (size_t i = 0; i < producers.size(); ++i) {
+    expected[i].Prepare();
+    producers[i].Prepare();
+    while (expected[i].HasNext()) {
+      ASSERT_TRUE(producers[i].HasNext());
+      const Request expected_req = expected[i].Next();
+      const Request req = producers[i].Next();
+      ASSERT_EQ(req.op, expected_req.op);
+      ASSERT_EQ(req.key, expected_req.key);
+      ASSERT_EQ(req.value_size, expected_req.value_size);
+    }
+    ASSERT_FALSE(producers[i].HasNext());
+  }
+
+  constexpr size_t num_workers = 2;
+  Session<TestDatabaseInterface> session(num_workers);
+  session.Initialize();
+  session.ReplayBulkLoadTrace(pworkload.workload().GetLoadTrace());
+  session.RunWorkload(pworkload);
+  session.Terminate();
+
+  ASSERT_EQ(session.db().read_calls, 500);
+  ASSERT_EQ(session.db().insert_calls, 500);
+}
+
+TEST(GeneratorTest, PersistedWorkload) {
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 1000\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 100\n"
+      "    range_max: 100000\n"
+      "run:\n"
+      "- num_requests: 10000\n"
+      "  insert:\n"
+      "    proportion_pct: 20\n"
+      "    distribution:\n"
+      "      type: uniform\n"
+      "      range_min: 100000\n"
+      "      range_max: 200000\n"
+      "  update:\n"
+      "    proportion_pct: 20\n"
+      "    distribution:\n"
+      "      type: zipfian\n"
+      "      theta: 0.99\n"
+      "  scan:\n"
+      "    proportion_pct: 10\n"
+      "    max_length: 100\n"
+      "    distribution:\n"
+      "      type: uniform\n"
+      "  read:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: uniform\n";
+  const auto file =
+      std::filesystem::temp_directory_path() / "persisted_workload.ycsbr";
+  constexpr size_t num_producers = 3;
+  PersistedWorkload::Write(*PhasedWorkload::LoadFromString(config),
+                           num_producers, file, /*requests_per_block=*/100);
+
+  const PersistedWorkload persisted(file);
+  ASSERT_EQ(persisted.num_producers(), num_producers);
+  ASSERT_EQ(persisted.size(), 10000);
+  ASSERT_THROW(persisted.GetProducers(num_producers + 1),
+               std::invalid_argument);
+
+  // The persisted workload should replay exactly the same requests.
+  auto expected =
+      PhasedWorkload::LoadFromString(config)->GetProducers(num_producers);
+  auto producers = persisted.GetProducers(num_producers);
+  for (size_t i = 0; i < num_producers; ++i) {
+    expected[i].Prepare();
+    producers[i].Prepare();
+    while (expected[i].HasNext()) {
+      ASSERT_TRUE(producers[i].HasNext());
+      const Request expected_req = expected[i].Next();
+      const Request req = producers[i].Next();
+      ASSERT_EQ(req.op, expected_req.op);
+      ASSERT_EQ(req.key, expected_req.key);
+      ASSERT_EQ(req.scan_amount, expected_req.scan_amount);
+      ASSERT_EQ(req.value_size, expected_req.value_size);
+      ASSERT_EQ(req.value == nullptr, expected_req.value == nullptr);
+    }
+    ASSERT_FALSE(producers[i].HasNext());
+  }
+
+  // Corrupted files are rejected.
+  std::filesystem::resize_file(file, std::filesystem::file_size(file) - 8);
+  ASSERT_THROW(PersistedWorkload{file}, std::runtime_error);
+  std::ofstream(file, std::ios::out | std::ios::trunc) << "not a workload";
+  ASSERT_THROW(PersistedWorkload{file}, std::runtime_error);
+  std::filesystem::remove(file);
+}
+
+TEST(GeneratorTest, ReplicateLoadKeysPerNumaNode) {
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 1000\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 100\n"
+      "    range_max: 100000\n"
+      "run:\n"
+      "- num_requests: 1000\n"
+      "  read:\n"
+      "    proportion_pct: 100\n"
+      "    distribution:\n"
+      "      type: zipfian\n"
+      "      theta: 0.99\n";
+  auto expected = PhasedWorkload::LoadFromString(config)->GetProducers(2);
+  auto workload = PhasedWorkload::LoadFromString(config);
+  workload->SetReplicateLoadKeysPerNumaNode(true);
+  auto producers = workload->GetProducers(2);
+  for (size_t i = 0; i < producers.size(); ++i) {
+    expected[i].Prepare();
+    producers[i].Prepare();
+    while (expected[i].HasNext()) {
+      ASSERT_TRUE(producers[i].HasNext());
+      const Request expected_req = expected[i].Next();
+      const Request req = producers[i].Next();
+      ASSERT_EQ(req.op, expected_req.op);
+      ASSERT_EQ(req.key, expected_req.key);
+    }
+    ASSERT_FALSE(producers[i].HasNext());
+  }
+
+  Session<TestDatabaseInterface> session(2, ThreadPlacement::kNumaAware);
+  session.Initialize();
+  session.ReplayBulkLoadTrace(workload->GetLoadTrace());
+  session.RunWorkload(*workload);
+  session.Terminate();
+  ASSERT_EQ(session.db().read_calls, 1000);
+}
+
 TEST(GeneratorTest, ClusteredZipfian) {
   const std::string config =
       "record_size_bytes: 16\n"
@@ -585,6 +1187,56 @@ TEST(GeneratorTest, ClusteredZipfian) {
   ASSERT_EQ(dataset, dataset_copy);
 }
 
+TEST(GeneratorTest, LargeTheta) {
+  // Theta values of at least 1 are sampled using rejection-inversion.
+  const std::string config =
+      "record_size_bytes: 16\n"
+      "load:\n"
+      "  num_records: 1000\n"
+      "  distribution:\n"
+      "    type: uniform\n"
+      "    range_min: 1\n"
+      "    range_max: 100000000\n"
+      "run:\n"
+      "- num_requests: 1000\n"
+      "  read:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: zipfian\n"
+      "      theta: 1.5\n"
+      "  update:\n"
+      "    proportion_pct: 50\n"
+      "    distribution:\n"
+      "      type: latest\n"
+      "      theta: 0.9\n"
+      "      algorithm: rejection_inversion\n";
+  std::unique_ptr<PhasedWorkload> workload =
+      PhasedWorkload::LoadFromString(config);
+  Session<KeyFrequencyInterface> session(1);
+  session.Initialize();
+  session.ReplayBulkLoadTrace(workload->GetLoadTrace());
+  const auto result = session.RunWorkload(*workload);
+  session.Terminate();
+  ASSERT_EQ(result.Reads().NumRequests() + result.Writes().NumRequests(), 1000);
+
+  // With theta = 1.5, the most popular key should get roughly 38% of the reads
+  // (the reads' and updates' most popular keys are different).
+  size_t max_freq = 0;
+  for (const auto& entry : session.db().key_freqs) {
+    max_freq = std::max(max_freq, entry.second);
+  }
+  ASSERT_GE(max_freq, 150);
+
+  // The YCSB algorithm does not support theta >= 1.
+  std::string gray_config = config;
+  gray_config.replace(gray_config.find("theta: 1.5"), 10,
+                      "theta: 1.5\n      algorithm: gray");
+  std::unique_ptr<PhasedWorkload> gray_workload =
+      PhasedWorkload::LoadFromString(gray_config);
+  auto producers = gray_workload->GetProducers(1);
+  ASSERT_THROW(producers[0].Prepare(), std::invalid_argument);
+}
+
 TEST(GeneratorTest, CustomInserts) {
   const std::string config =
       "record_size_bytes: 16\n"
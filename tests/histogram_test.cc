@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "db_interface.h"
+#include "gtest/gtest.h"
+#include "ycsbr/ycsbr.h"
+
+namespace {
+
+using namespace ycsbr;
+using std::chrono::nanoseconds;
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram hist(/*precision_bits=*/8);
+  for (int i = 0; i < 256; ++i) {
+    hist.Record(nanoseconds(i));
+  }
+  ASSERT_EQ(hist.Count(), 256);
+  ASSERT_EQ(hist.Min(), nanoseconds(0));
+  ASSERT_EQ(hist.Max(), nanoseconds(255));
+  ASSERT_EQ(hist.Percentile(0.0), nanoseconds(0));
+  ASSERT_EQ(hist.Percentile(0.5), nanoseconds(128));
+  ASSERT_EQ(hist.Percentile(1.0), nanoseconds(255));
+}
+
+TEST(LatencyHistogramTest, BoundedRelativeError) {
+  constexpr int kPrecisionBits = 8;
+  const double max_error = 1.0 / (1 << (kPrecisionBits - 1));
+
+  std::mt19937 prng(42);
+  std::lognormal_distribution<double> dist(10.0, 2.0);
+  std::vector<nanoseconds> samples;
+  LatencyHistogram hist(kPrecisionBits);
+  for (int i = 0; i < 100000; ++i) {
+    const nanoseconds latency(static_cast<uint64_t>(dist(prng)));
+    samples.push_back(latency);
+    hist.Record(latency);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  ASSERT_EQ(hist.Min(), samples.front());
+  ASSERT_EQ(hist.Max(), samples.back());
+  for (const double p : {0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+    const double exact = samples[p * samples.size()].count();
+    const double approx = hist.Percentile(p).count();
+    // Reported values are bucket upper bounds.
+    ASSERT_GE(approx, exact);
+    ASSERT_LE(approx, exact * (1.0 + max_error));
+  }
+}
+
+TEST(LatencyHistogramTest, Merge) {
+  LatencyHistogram h1, h2, combined;
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    const nanoseconds latency(i * 37);
+    (i % 3 == 0 ? h1 : h2).Record(latency);
+    combined.Record(latency);
+  }
+  h1.Merge(h2);
+  ASSERT_EQ(h1.Count(), combined.Count());
+  ASSERT_EQ(h1.Min(), combined.Min());
+  ASSERT_EQ(h1.Max(), combined.Max());
+  ASSERT_EQ(h1.Mean(), combined.Mean());
+  for (const double p : {0.0, 0.25, 0.5, 0.75, 0.99, 1.0}) {
+    ASSERT_EQ(h1.Percentile(p), combined.Percentile(p));
+  }
+
+  LatencyHistogram other_precision(/*precision_bits=*/4);
+  ASSERT_THROW(h1.Merge(other_precision), std::invalid_argument);
+}
+
+TEST(LatencyHistogramTest, InvalidArguments) {
+  ASSERT_THROW(LatencyHistogram(0), std::invalid_argument);
+  ASSERT_THROW(LatencyHistogram(17), std::invalid_argument);
+  LatencyHistogram hist;
+  ASSERT_THROW(hist.Percentile(1.5), std::invalid_argument);
+  ASSERT_EQ(hist.Percentile(0.5), nanoseconds(0));
+  ASSERT_EQ(hist.Mean(), nanoseconds(0));
+}
+
+TEST(LatencyHistogramTest, MeterFreezeGroup) {
+  std::vector<Meter> meters;
+  for (int i = 0; i < 4; ++i) {
+    meters.push_back(Meter::UsingHistogram(/*precision_bits=*/8));
+    for (int j = 1; j <= 100; ++j) {
+      meters.back().Record(nanoseconds(j), /*bytes=*/10);
+    }
+  }
+  const FrozenMeter frozen = Meter::FreezeGroup(std::move(meters));
+  ASSERT_EQ(frozen.NumRequests(), 400);
+  ASSERT_EQ(frozen.TotalBytes(), 4000);
+  ASSERT_EQ(frozen.LatencyMin<nanoseconds>(), nanoseconds(1));
+  ASSERT_EQ(frozen.LatencyMax<nanoseconds>(), nanoseconds(100));
+  ASSERT_EQ(frozen.LatencyMean<nanoseconds>(), nanoseconds(50));
+  ASSERT_EQ(frozen.LatencyPercentile<nanoseconds>(0.5), nanoseconds(51));
+}
+
+TEST(LatencyHistogramTest, MeterSummarizeGroup) {
+  std::vector<Meter> meters(2);
+  for (int j = 1; j <= 1000; ++j) {
+    meters[j % 2].Record(nanoseconds(j), /*bytes=*/10);
+  }
+  const Meter empty;
+  const FrozenMeter summary = Meter::SummarizeGroup(
+      {&meters[0], &meters[1], &empty}, /*precision_bits=*/8);
+  ASSERT_EQ(summary.NumRequests(), 1000);
+  ASSERT_EQ(summary.TotalBytes(), 10000);
+  ASSERT_EQ(summary.LatencyMin<nanoseconds>(), nanoseconds(1));
+  ASSERT_EQ(summary.LatencyMax<nanoseconds>(), nanoseconds(1000));
+  // The percentiles are upper bounds with a relative error of at most 2^-7.
+  ASSERT_GE(summary.LatencyPercentile<nanoseconds>(0.5), nanoseconds(500));
+  ASSERT_LE(summary.LatencyPercentile<nanoseconds>(0.5), nanoseconds(504));
+
+  // The meters' samples are left as is, so they can still be frozen exactly.
+  const FrozenMeter frozen = Meter::FreezeGroup(std::move(meters));
+  ASSERT_EQ(frozen.NumRequests(), 1000);
+  ASSERT_EQ(frozen.LatencyPercentile<nanoseconds>(0.5), nanoseconds(501));
+
+  const FrozenMeter empty_summary =
+      Meter::SummarizeGroup({&empty}, /*precision_bits=*/8);
+  ASSERT_EQ(empty_summary.NumRequests(), 0);
+  ASSERT_EQ(empty_summary.LatencyMax<nanoseconds>(), nanoseconds(0));
+}
+
+TEST(LatencyHistogramTest, SessionRun) {
+  RunOptions options;
+  options.latency_sample_period = 1;
+  options.latency_histogram_precision_bits = 8;
+
+  Session<NoOpInterface> session(2);
+  session.Initialize();
+  const BulkLoadTrace trace = BulkLoadTrace::LoadFromKeys(
+      std::vector<Request::Key>(1000, 1), Trace::Options());
+  const BenchmarkResult result = session.ReplayTrace(trace, options);
+  session.Terminate();
+  ASSERT_EQ(result.Writes().NumRequests(), 1000);
+  ASSERT_LE(result.Writes().LatencyMin<nanoseconds>(),
+            result.Writes().LatencyPercentile<nanoseconds>(0.5));
+  ASSERT_LE(result.Writes().LatencyPercentile<nanoseconds>(0.5),
+            result.Writes().LatencyMax<nanoseconds>());
+}
+
+}  // namespace
@@ -6,6 +6,7 @@
 #include "db_interface.h"
 #include "workloads/create_workload.h"
 #include "ycsbr/benchmark.h"
+#include "ycsbr/impl/clock.h"
 #include "ycsbr/impl/executor.h"
 #include "ycsbr/impl/flag.h"
 #include "ycsbr/request.h"
@@ -71,7 +72,7 @@ void BM_SimpleInterfaceOverhead(benchmark::State& state) {
   std::filesystem::remove(trace_file);
 }
 
-template <WorkloadType Type>
+template <WorkloadType Type, typename Clock = impl::SteadyClock>
 void BM_ExecutorLoopOverhead(benchmark::State& state) {
   const std::filesystem::path trace_file = CreateWorkloadFile<Type>();
   Trace::Options options;
@@ -85,7 +86,7 @@ void BM_ExecutorLoopOverhead(benchmark::State& state) {
   roptions.latency_sample_period = state.range(0);
   NoOpInterface db;
   impl::Flag can_start;
-  impl::Executor<NoOpInterface, TraceWorkload::Producer> executor(
+  impl::Executor<NoOpInterface, TraceWorkload::Producer, Clock> executor(
       &db, producers.at(0), 0, &can_start, roptions);
   for (auto _ : state) {
     executor.BM_WorkloadLoop();
@@ -98,6 +99,13 @@ void BM_ExecutorLoopOverhead(benchmark::State& state) {
   std::filesystem::remove(trace_file);
 }
 
+template <typename Clock>
+void BM_ClockOverhead(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Clock::Now());
+  }
+}
+
 template <WorkloadType Type>
 void BM_SessionTraceReplayOverhead(benchmark::State& state) {
   const std::filesystem::path trace_file = CreateWorkloadFile<Type>();
@@ -169,6 +177,19 @@ BENCHMARK_TEMPLATE(BM_ExecutorLoopOverhead, WorkloadType::kRunE)
     ->Arg(30)
     ->UseRealTime();
 
+BENCHMARK_TEMPLATE(BM_ClockOverhead, impl::SteadyClock);
+
+#ifdef YCSBR_HAS_TSC_CLOCK
+BENCHMARK_TEMPLATE(BM_ExecutorLoopOverhead, WorkloadType::kRunA,
+                   impl::TscClock)
+    ->Arg(1)
+    ->Arg(20)
+    ->Arg(30)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ClockOverhead, impl::TscClock);
+#endif
+
 BENCHMARK_TEMPLATE(BM_SessionTraceReplayOverhead, WorkloadType::kRunA)
     ->Arg(1)
     ->Arg(5)
@@ -1,4 +1,12 @@
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "db_interface.h"
 #include "gtest/gtest.h"
@@ -42,6 +50,613 @@ TEST_F(TraceLoadA, SessionBulkLoad) {
   ASSERT_TRUE(result.RunTime<std::chrono::nanoseconds>().count() > 0);
 }
 
+TEST_F(TraceReplayA, SessionStreamingRun) {
+  const StreamingTraceWorkload workload(trace_file, Trace::Options(),
+                                        /*requests_per_block=*/4);
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  const BenchmarkResult result = session.RunWorkload(workload);
+  session.Terminate();
+  ASSERT_TRUE(session.db().read_calls > 0);
+  ASSERT_TRUE(session.db().update_calls > 0);
+  ASSERT_EQ(session.db().read_calls + session.db().update_calls, kTraceSize);
+}
+
+// Each producer issues `num_requests` reads of key 0.
+class ReadOnlyWorkload {
+ public:
+  ReadOnlyWorkload(size_t num_requests) : num_requests_(num_requests) {}
+  class Producer {
+   public:
+    Producer(size_t num_requests) : num_requests_(num_requests), index_(0) {}
+    void Prepare() {}
+    bool HasNext() const { return index_ < num_requests_; }
+    Request Next() {
+      ++index_;
+      return Request();
+    }
+
+   private:
+    size_t num_requests_;
+    size_t index_;
+  };
+
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    return std::vector<Producer>(num_producers, Producer(num_requests_));
+  }
+
+ private:
+  size_t num_requests_;
+};
+
+TEST(SessionTest, OpenLoopFollowsRate) {
+  constexpr size_t kNumRequests = 50;
+  RunOptions options;
+  options.target_requests_per_second_per_worker = 10000.0;
+  for (const auto process : {RunOptions::ArrivalProcess::kConstant,
+                             RunOptions::ArrivalProcess::kPoisson}) {
+    options.arrival_process = process;
+    Session<TestDatabaseInterface> session(2);
+    session.Initialize();
+    const auto result =
+        session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+    session.Terminate();
+    ASSERT_EQ(session.db().read_calls, 2 * kNumRequests);
+    if (process == RunOptions::ArrivalProcess::kConstant) {
+      // The last request cannot be sent before its scheduled time.
+      ASSERT_GE(result.RunTime<std::chrono::microseconds>().count(),
+                (kNumRequests - 1) * 100);
+    }
+  }
+}
+
+TEST(SessionTest, OpenLoopMeasuresFromIntendedStart) {
+  constexpr size_t kNumRequests = 100;
+  RunOptions options;
+  options.latency_sample_period = 1;
+  options.target_requests_per_second_per_worker = 10000.0;
+
+  Session<StallOnFirstReadInterface> session(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+
+  // Requests are scheduled every 100 us, so the requests scheduled during the
+  // first read's stall are delayed. Their latencies should include this delay
+  // (e.g., the 39th request was supposed to be sent 3.9 ms into the run, but
+  // could only be sent after 5 ms). So at least 39% of the measured latencies
+  // should exceed 1 ms.
+  const auto& reads = result.Reads();
+  ASSERT_EQ(reads.NumRecords(), kNumRequests);
+  ASSERT_GE(reads.LatencyMax<std::chrono::milliseconds>().count(),
+            StallOnFirstReadInterface::kStallTime.count());
+  ASSERT_GE(reads.LatencyPercentile<std::chrono::microseconds>(0.65).count(),
+            1000);
+}
+
+TEST(SessionTest, CycleCounterLatencies) {
+  constexpr size_t kNumRequests = 100;
+  RunOptions options;
+  options.latency_sample_period = 1;
+  options.use_cycle_counter = true;
+
+  Session<StallOnFirstReadInterface> session(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+
+  // Latencies should be reported in nanoseconds regardless of the clock used.
+  const auto& reads = result.Reads();
+  ASSERT_EQ(reads.NumRecords(), kNumRequests);
+  ASSERT_GE(reads.LatencyMax<std::chrono::milliseconds>().count(),
+            StallOnFirstReadInterface::kStallTime.count());
+  ASSERT_LT(reads.LatencyMax<std::chrono::milliseconds>().count(), 1000);
+  ASSERT_LE(reads.LatencyMax<std::chrono::nanoseconds>(),
+            result.RunTime<std::chrono::nanoseconds>());
+}
+
+TEST_F(TraceReplayA, BatchedReplay) {
+  const Trace trace = Trace::LoadFromFile(trace_file, Trace::Options());
+  RunOptions options;
+  options.batch_size = 4;
+  Session<BatchingInterface> session(1);
+  session.Initialize();
+  const BenchmarkResult result = session.ReplayTrace(trace, options);
+  session.Terminate();
+
+  const auto& db = session.db();
+  // All requests should have been dispatched in batches.
+  ASSERT_EQ(db.read_calls, 0);
+  ASSERT_EQ(db.update_calls, 0);
+  ASSERT_FALSE(db.mixed_write_batches);
+  const size_t num_batched =
+      std::accumulate(db.read_batch_sizes.begin(), db.read_batch_sizes.end(),
+                      0) +
+      std::accumulate(db.write_batch_sizes.begin(),
+                      db.write_batch_sizes.end(), 0);
+  ASSERT_EQ(num_batched, kTraceSize);
+  for (const auto size : db.read_batch_sizes) {
+    ASSERT_LE(size, 4);
+  }
+  for (const auto size : db.write_batch_sizes) {
+    ASSERT_LE(size, 4);
+  }
+
+  ASSERT_EQ(result.Reads().NumRequests() + result.Writes().NumRequests(),
+            kTraceSize);
+  ASSERT_EQ(result.Batches().NumRecords(), kTraceSize);
+  ASSERT_EQ(result.Batches().NumRequests(),
+            db.read_batch_sizes.size() + db.write_batch_sizes.size());
+}
+
+TEST(SessionTest, BatchSizes) {
+  constexpr size_t kNumRequests = 100;
+  RunOptions options;
+  options.batch_size = 16;
+  options.latency_sample_period = 1;
+  Session<BatchingInterface> session(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+
+  const std::vector<size_t> expected = {16, 16, 16, 16, 16, 16, 4};
+  ASSERT_EQ(session.db().read_batch_sizes, expected);
+  ASSERT_EQ(result.Reads().NumRequests(), kNumRequests);
+  ASSERT_EQ(result.Batches().NumRequests(), expected.size());
+  ASSERT_LE(result.Reads().LatencyMax<std::chrono::nanoseconds>(),
+            result.Batches().LatencyMax<std::chrono::nanoseconds>());
+}
+
+TEST(SessionTest, NoBatchingByDefault) {
+  Session<BatchingInterface> session(1);
+  session.Initialize();
+  const auto result = session.RunWorkload(ReadOnlyWorkload(100));
+  session.Terminate();
+  ASSERT_EQ(session.db().read_calls, 100);
+  ASSERT_TRUE(session.db().read_batch_sizes.empty());
+  ASSERT_EQ(result.Batches().NumRequests(), 0);
+}
+
+TEST_F(TraceReplayA, AsyncReplay) {
+  const Trace trace = Trace::LoadFromFile(trace_file, Trace::Options());
+  RunOptions options;
+  options.async_queue_depth = 4;
+  options.latency_sample_period = 1;
+  Session<AsyncInterface> session(1);
+  session.Initialize();
+  const BenchmarkResult result = session.ReplayTrace(trace, options);
+  session.Terminate();
+
+  const auto& db = session.db();
+  ASSERT_EQ(db.read_calls + db.update_calls, kTraceSize);
+  ASSERT_EQ(db.max_in_flight, 4);
+  ASSERT_TRUE(db.in_flight.empty());
+  ASSERT_EQ(result.Reads().NumRequests(), db.read_calls);
+  ASSERT_EQ(result.Writes().NumRequests(), db.update_calls);
+  ASSERT_EQ(result.Reads().TotalBytes(), 8 * db.read_calls);
+}
+
+TEST(SessionTest, AsyncQueueDepth) {
+  constexpr size_t kNumRequests = 100;
+  RunOptions options;
+  options.async_queue_depth = 32;
+  Session<AsyncInterface> session(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+  ASSERT_EQ(session.db().read_calls, kNumRequests);
+  ASSERT_EQ(session.db().max_in_flight, 32);
+  // 100 requests with 32 in flight at a time.
+  ASSERT_EQ(session.db().poll_calls, 4);
+  ASSERT_EQ(result.Reads().NumRequests(), kNumRequests);
+
+  Session<AsyncInterface> open_loop_session(1);
+  open_loop_session.Initialize();
+  options.target_requests_per_second_per_worker = 1000.0;
+  ASSERT_THROW(open_loop_session.RunWorkload(ReadOnlyWorkload(1), options),
+               std::invalid_argument);
+}
+
+// Completes every request as failed.
+class FailingAsyncInterface : public AsyncInterface {
+ public:
+  void PollAsync() {
+    ++poll_calls;
+    std::vector<AsyncCallback> completed;
+    completed.swap(in_flight);
+    for (const auto& callback : completed) {
+      callback(false);
+    }
+  }
+};
+
+TEST(SessionTest, AsyncErrorDrainsInFlightRequests) {
+  RunOptions options;
+  options.async_queue_depth = 8;
+  options.expect_request_success = true;
+  FailingAsyncInterface db;
+  impl::Flag can_start;
+  can_start.Raise();
+  impl::AsyncExecutor<FailingAsyncInterface, ReadOnlyWorkload::Producer>
+      executor(&db, ReadOnlyWorkload::Producer(100), 0, &can_start, options);
+  ASSERT_THROW(executor(), std::runtime_error);
+  // The executor stops issuing requests after the first failure but waits
+  // for the in-flight requests to complete before reporting it.
+  ASSERT_EQ(db.read_calls, 8);
+  ASSERT_TRUE(db.in_flight.empty());
+}
+
+// The second producer throws when it is moved (i.e., when its executor is
+// started).
+class FailingStartWorkload {
+ public:
+  class Producer {
+   public:
+    explicit Producer(bool fail) : fail_(fail) {}
+    Producer(const Producer& other) = default;
+    Producer(Producer&& other) : fail_(other.fail_) {
+      if (fail_) throw std::runtime_error("Failed to start the executor.");
+    }
+    void Prepare() {}
+    bool HasNext() const { return true; }
+    Request Next() { return Request(); }
+
+   private:
+    bool fail_;
+  };
+
+  std::vector<Producer> GetProducers(size_t num_producers) const {
+    std::vector<Producer> producers;
+    producers.reserve(num_producers);
+    for (size_t i = 0; i < num_producers; ++i) {
+      producers.emplace_back(/*fail=*/i == 1);
+    }
+    return producers;
+  }
+};
+
+TEST(SessionTest, ExecutorStartFailure) {
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  // The producers never run out of requests, so this would not return if the
+  // executor that did start were not stopped.
+  ASSERT_THROW(session.RunWorkload(FailingStartWorkload()),
+               std::runtime_error);
+  ASSERT_EQ(session.db().read_calls, 0);
+  session.Terminate();
+
+  Session<TestDatabaseInterface> numa_session(2, ThreadPlacement::kNumaAware);
+  numa_session.Initialize();
+  ASSERT_THROW(numa_session.RunWorkload(FailingStartWorkload()),
+               std::runtime_error);
+  ASSERT_EQ(numa_session.db().read_calls, 0);
+  numa_session.Terminate();
+}
+
+TEST(SessionTest, NumaTopology) {
+  ASSERT_EQ(impl::NumaTopology::ParseCpuList("0-3,8-9,12\n"),
+            std::vector<size_t>({0, 1, 2, 3, 8, 9, 12}));
+  const auto topology = impl::NumaTopology::FromCpuLists({"0-1,4-5", "2-3"});
+  ASSERT_EQ(topology.num_nodes(), 2);
+  ASSERT_EQ(topology.NodeOfCore(5), 0);
+  ASSERT_EQ(topology.NodeOfCore(3), 1);
+  // Threads are placed round-robin across the nodes.
+  ASSERT_EQ(topology.CoreMap(6), std::vector<size_t>({0, 2, 1, 3, 4, 2}));
+  ASSERT_GE(impl::NumaTopology::Get().num_nodes(), 1);
+}
+
+TEST_F(TraceReplayA, NumaAwareReplay) {
+  const Trace trace = Trace::LoadFromFile(trace_file, Trace::Options());
+  Session<TestDatabaseInterface> session(2, ThreadPlacement::kNumaAware);
+  session.Initialize();
+  const BenchmarkResult result = session.ReplayTrace(trace);
+  session.Terminate();
+
+  const auto& db = session.db();
+  ASSERT_EQ(db.read_calls + db.update_calls, kTraceSize);
+  ASSERT_EQ(result.Reads().NumRequests() + result.Writes().NumRequests(),
+            kTraceSize);
+}
+
+TEST(SessionTest, PerExecutorResults) {
+  constexpr size_t kNumRequests = 100;
+  RunOptions options;
+  options.latency_sample_period = 1;
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+
+  ASSERT_EQ(result.Reads().NumRequests(), 2 * kNumRequests);
+  ASSERT_EQ(result.PerExecutor().size(), 2);
+  for (const auto& executor : result.PerExecutor()) {
+    ASSERT_EQ(executor.Reads().NumRequests(), kNumRequests);
+    ASSERT_GT(executor.RunTime<std::chrono::nanoseconds>().count(), 0);
+    ASSERT_LE(executor.RunTime<std::chrono::nanoseconds>(),
+              result.RunTime<std::chrono::nanoseconds>());
+    ASSERT_LE(executor.Reads().LatencyMax<std::chrono::nanoseconds>(),
+              result.Reads().LatencyMax<std::chrono::nanoseconds>());
+  }
+  // `ReadOnlyWorkload` does not report phases.
+  ASSERT_TRUE(result.PerPhase().empty());
+
+  // A header row and one row per executor.
+  std::stringstream csv;
+  result.PrintBreakdownAsCSV(csv);
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(csv, line)) {
+    lines.push_back(line);
+  }
+  ASSERT_EQ(lines.size(), 3);
+  ASSERT_EQ(lines[0].rfind("scope,id,num_reads,", 0), 0);
+  ASSERT_EQ(lines[1].rfind("executor,0,100,", 0), 0);
+  ASSERT_EQ(lines[2].rfind("executor,1,100,", 0), 0);
+}
+
+// Each producer issues `num_rounds` rounds of a read, a negative read, a
+// read-modify-write, and an update. Only the negative reads use key 2.
+class MixedOpsWorkload {
+ public:
+  MixedOpsWorkload(size_t num_rounds) : num_rounds_(num_rounds) {}
+  class Producer {
+   public:
+    Producer(size_t num_rounds) : num_requests_(4 * num_rounds), index_(0) {}
+    void Prepare() {}
+    bool HasNext() const { return index_ < num_requests_; }
+    Request Next() {
+      static constexpr Request::Operation kOps[] = {
+          Request::Operation::kRead, Request::Operation::kNegativeRead,
+          Request::Operation::kReadModifyWrite, Request::Operation::kUpdate};
+      const Request::Operation op = kOps[index_++ % 4];
+      return Request(op, op == Request::Operation::kNegativeRead ? 2 : 1,
+                     /*scan_amount=*/0, /*value=*/nullptr, /*value_size=*/0);
+    }
+
+   private:
+    size_t num_requests_;
+    size_t index_;
+  };
+
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    return std::vector<Producer>(num_producers, Producer(num_rounds_));
+  }
+
+ private:
+  size_t num_rounds_;
+};
+
+TEST(SessionTest, PerOperationResults) {
+  constexpr size_t kNumRounds = 100;
+  RunOptions options;
+  options.latency_sample_period = 1;
+  Session<NegativeLookupInterface> session(1);
+  session.db().keys.insert(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(MixedOpsWorkload(kNumRounds), options);
+  session.Terminate();
+
+  // The aggregate meters include the halves of the read-modify-writes.
+  ASSERT_EQ(result.Reads().NumRequests(), 2 * kNumRounds);
+  ASSERT_EQ(result.NumFailedReads(), kNumRounds);
+  ASSERT_EQ(result.Writes().NumRequests(), 2 * kNumRounds);
+  for (const auto op :
+       {Request::Operation::kRead, Request::Operation::kNegativeRead,
+        Request::Operation::kReadModifyWrite, Request::Operation::kUpdate}) {
+    ASSERT_EQ(result.ForOperation(op).NumRequests(), kNumRounds);
+  }
+  ASSERT_EQ(result.ForOperation(Request::Operation::kInsert).NumRequests(), 0);
+  ASSERT_EQ(result.ForOperation(Request::Operation::kScan).NumRequests(), 0);
+  // Failed negative reads are included in their meter (with their latency).
+  ASSERT_EQ(result.NumFailedForOperation(Request::Operation::kNegativeRead),
+            kNumRounds);
+  ASSERT_EQ(result.NumFailedForOperation(Request::Operation::kRead), 0);
+  ASSERT_GT(result.ForOperation(Request::Operation::kNegativeRead)
+                .LatencyMax<std::chrono::nanoseconds>()
+                .count(),
+            0);
+
+  std::stringstream csv;
+  result.PrintAsCSV(csv);
+  std::string header, row;
+  std::getline(csv, header);
+  std::getline(csv, row);
+  ASSERT_NE(header.find(",num_rmws,rmws_ns_p99,rmws_ns_p50,num_negative_reads,"
+                        "negative_reads_ns_p99,negative_reads_ns_p50"),
+            std::string::npos);
+  ASSERT_EQ(std::count(header.begin(), header.end(), ','),
+            std::count(row.begin(), row.end(), ','));
+}
+
+TEST(SessionTest, AsyncPerOperationResults) {
+  constexpr size_t kNumRounds = 50;
+  RunOptions options;
+  options.async_queue_depth = 4;
+  options.latency_sample_period = 1;
+  Session<AsyncInterface> session(1);
+  session.Initialize();
+  const auto result =
+      session.RunWorkload(MixedOpsWorkload(kNumRounds), options);
+  session.Terminate();
+
+  const FrozenMeter& rmws =
+      result.ForOperation(Request::Operation::kReadModifyWrite);
+  ASSERT_EQ(rmws.NumRequests(), kNumRounds);
+  ASSERT_EQ(
+      result.ForOperation(Request::Operation::kNegativeRead).NumRequests(),
+      kNumRounds);
+  // A read-modify-write's latency spans both of its requests.
+  ASSERT_GE(rmws.LatencyMin<std::chrono::nanoseconds>(),
+            result.Writes().LatencyMin<std::chrono::nanoseconds>());
+}
+
+TEST_F(TraceReplayE, RecordBufferReplay) {
+  const Trace trace = Trace::LoadFromFile(trace_file, Trace::Options());
+  Session<RecordBufferInterface> session(1);
+  session.Initialize();
+  const auto scan_result = session.ReplayTrace(trace);
+  const auto read_result =
+      session.RunWorkload(MixedOpsWorkload(/*num_rounds=*/100));
+  session.Terminate();
+
+  // `ReadInto()` and `ScanInto()` are used instead of `Read()` and `Scan()`,
+  // and the buffer is always cleared before it is passed to the database.
+  const auto& db = session.db();
+  ASSERT_EQ(db.read_calls, 0);
+  ASSERT_EQ(db.scan_calls, 0);
+  ASSERT_EQ(db.non_empty_buffers, 0);
+  ASSERT_GT(db.scan_into_calls, 0);
+  ASSERT_EQ(db.scan_into_calls, scan_result.Scans().NumRequests());
+  ASSERT_EQ(scan_result.Scans().TotalBytes(),
+            scan_result.Scans().NumRecords() * (sizeof(Request::Key) + 7));
+  // Reads, negative reads, and the reads of read-modify-writes.
+  ASSERT_EQ(db.read_into_calls, 300);
+  ASSERT_EQ(read_result.Reads().NumRequests(), 300);
+  ASSERT_EQ(read_result.Reads().TotalBytes(), 300 * 7);
+}
+
+TEST(RecordBufferTest, StoresRecords) {
+  RecordBuffer buffer;
+  ASSERT_TRUE(buffer.empty());
+  buffer.Append(1, "a", 1);
+  buffer.Append(2, "", 0);
+  std::memcpy(buffer.AppendUninitialized(3, 3), "ccc", 3);
+  ASSERT_EQ(buffer.size(), 3);
+  ASSERT_EQ(buffer.key(2), 3);
+  ASSERT_EQ(buffer.value(0), "a");
+  ASSERT_EQ(buffer.value(1), "");
+  ASSERT_EQ(buffer.value(2), "ccc");
+  ASSERT_EQ(buffer.ValueBytes(), 4);
+
+  // Clearing keeps the buffer's memory.
+  const char* const values = buffer.value(0).data();
+  buffer.Clear();
+  ASSERT_TRUE(buffer.empty());
+  ASSERT_EQ(buffer.ValueBytes(), 0);
+  buffer.Append(4, "dddd", 4);
+  ASSERT_EQ(buffer.value(0).data(), values);
+  ASSERT_EQ(buffer.value(0), "dddd");
+}
+
+// Returns the lines in `file`.
+std::vector<std::string> ReadLines(const std::filesystem::path& file) {
+  std::ifstream in(file);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(in, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+TEST(SessionTest, LiveMetrics) {
+  constexpr size_t kNumRequests = 20000;
+  RunOptions options;
+  options.latency_sample_period = 1;
+  options.live_metrics_period = std::chrono::milliseconds(1);
+  options.output_dir = std::filesystem::temp_directory_path();
+  options.live_metrics_file = "live_metrics_test";
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+
+  const std::vector<std::string> csv =
+      ReadLines(options.output_dir / "live_metrics_test.csv");
+  ASSERT_GE(csv.size(), 2);
+  ASSERT_EQ(csv[0].rfind("elapsed_ms,krequests_per_s,num_reads,", 0), 0);
+  // The rows cover the whole run, so their read counts add up to the total.
+  size_t num_reads = 0;
+  for (size_t i = 1; i < csv.size(); ++i) {
+    std::stringstream row(csv[i]);
+    std::string field;
+    std::getline(row, field, ',');  // elapsed_ms
+    std::getline(row, field, ',');  // krequests_per_s
+    std::getline(row, field, ',');  // num_reads
+    num_reads += std::stoull(field);
+  }
+  ASSERT_EQ(num_reads, 2 * kNumRequests);
+
+  options.live_metrics_format = RunOptions::LiveMetricsFormat::kJSONLines;
+  session.RunWorkload(ReadOnlyWorkload(kNumRequests), options);
+  session.Terminate();
+  const std::vector<std::string> json =
+      ReadLines(options.output_dir / "live_metrics_test.jsonl");
+  ASSERT_GE(json.size(), 1);
+  for (const auto& line : json) {
+    ASSERT_EQ(line.rfind("{\"elapsed_ms\":", 0), 0);
+    ASSERT_NE(line.find("\"reads_ns_p99\":"), std::string::npos);
+    ASSERT_EQ(line.back(), '}');
+  }
+
+  std::filesystem::remove(options.output_dir / "live_metrics_test.csv");
+  std::filesystem::remove(options.output_dir / "live_metrics_test.jsonl");
+}
+
+TEST(SessionTest, TimeBoundedRun) {
+  RunOptions options;
+  options.run_duration = std::chrono::milliseconds(50);
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  const auto start = std::chrono::steady_clock::now();
+  const ReadOnlyWorkload workload(100);
+  const auto result =
+      session.RunWorkload(LoopingWorkload<ReadOnlyWorkload>(workload), options);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  session.Terminate();
+
+  // The workload repeats until the deadline.
+  ASSERT_GE(elapsed, options.run_duration);
+  ASSERT_GT(session.db().read_calls, 2 * 100);
+  ASSERT_EQ(result.Reads().NumRequests(), session.db().read_calls);
+}
+
+TEST(SessionTest, WarmupAndCooldown) {
+  RunOptions options;
+  options.run_duration = std::chrono::milliseconds(60);
+  options.warmup = std::chrono::milliseconds(20);
+  options.cooldown = std::chrono::milliseconds(20);
+  Session<TestDatabaseInterface> session(2);
+  session.Initialize();
+  const ReadOnlyWorkload workload(100);
+  const auto result =
+      session.RunWorkload(LoopingWorkload<ReadOnlyWorkload>(workload), options);
+
+  // The requests run during the warm-up and the cool-down are not reported.
+  ASSERT_GT(result.Reads().NumRequests(), 0);
+  ASSERT_LT(result.Reads().NumRequests(), session.db().read_calls);
+  ASSERT_LT(result.RunTime<std::chrono::milliseconds>(), options.run_duration);
+  for (const auto& executor : result.PerExecutor()) {
+    ASSERT_LT(executor.RunTime<std::chrono::milliseconds>(),
+              options.run_duration);
+  }
+
+  // Nothing is reported if the workload ends during the warm-up.
+  options.run_duration = std::chrono::milliseconds(0);
+  options.warmup = std::chrono::milliseconds(10000);
+  options.cooldown = std::chrono::milliseconds(0);
+  const auto warmup_only =
+      session.RunWorkload(ReadOnlyWorkload(100), options);
+  ASSERT_EQ(warmup_only.Reads().NumRequests(), 0);
+  ASSERT_EQ(warmup_only.RunTime<std::chrono::nanoseconds>().count(), 0);
+
+  // Invalid windows.
+  options.warmup = std::chrono::milliseconds(0);
+  options.cooldown = std::chrono::milliseconds(10);
+  ASSERT_THROW(session.RunWorkload(ReadOnlyWorkload(1), options),
+               std::invalid_argument);
+  options.run_duration = std::chrono::milliseconds(20);
+  options.warmup = std::chrono::milliseconds(10);
+  ASSERT_THROW(session.RunWorkload(ReadOnlyWorkload(1), options),
+               std::invalid_argument);
+  session.Terminate();
+}
+
 TEST(SessionTest, NoThreads) {
   ASSERT_THROW(Session<TestDatabaseInterface> session(0), std::invalid_argument);
 }
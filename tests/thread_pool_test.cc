@@ -0,0 +1,120 @@
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ycsbr/impl/thread_pool.h"
+
+namespace {
+
+using namespace ycsbr;
+using impl::ThreadPool;
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+  constexpr size_t kNumTasks = 10000;
+  std::atomic<size_t> count(0);
+  std::vector<std::future<size_t>> results;
+  {
+    ThreadPool pool(4, []() {}, []() {});
+    for (size_t i = 0; i < kNumTasks; ++i) {
+      results.push_back(pool.Submit([&count](size_t v) {
+        count.fetch_add(1);
+        return v;
+      }, i));
+    }
+    for (size_t i = 0; i < kNumTasks; ++i) {
+      ASSERT_EQ(results[i].get(), i);
+    }
+  }
+  ASSERT_EQ(count.load(), kNumTasks);
+}
+
+TEST(ThreadPoolTest, NestedSubmissions) {
+  // Tasks submitted from within a worker are placed on that worker's deque
+  // (or the injection queue when it is full) and may be stolen.
+  constexpr size_t kOuter = 16;
+  constexpr size_t kInner = 1000;
+  std::atomic<size_t> count(0);
+  {
+    ThreadPool pool(4, []() {}, []() {});
+    for (size_t i = 0; i < kOuter; ++i) {
+      pool.SubmitNoWait([&pool, &count]() {
+        for (size_t j = 0; j < kInner; ++j) {
+          pool.SubmitNoWait([&count]() { count.fetch_add(1); });
+        }
+      });
+    }
+  }
+  // The destructor waits for all tasks, including nested ones.
+  ASSERT_EQ(count.load(), kOuter * kInner);
+}
+
+TEST(ThreadPoolTest, StartAndShutdownCallbacks) {
+  std::atomic<size_t> starts(0), shutdowns(0);
+  {
+    ThreadPool pool(
+        3, [&starts]() { starts.fetch_add(1); },
+        [&shutdowns]() { shutdowns.fetch_add(1); });
+    ASSERT_EQ(pool.NumThreads(), 3);
+    pool.Submit([]() {}).get();
+  }
+  ASSERT_EQ(starts.load(), 3);
+  ASSERT_EQ(shutdowns.load(), 3);
+}
+
+TEST(ThreadPoolTest, PinnedThreads) {
+  std::atomic<size_t> count(0);
+  {
+    ThreadPool pool(2, {0, 0}, []() {}, []() {});
+    for (size_t i = 0; i < 100; ++i) {
+      pool.SubmitNoWait([&count]() { count.fetch_add(1); });
+    }
+  }
+  ASSERT_EQ(count.load(), 100);
+}
+
+TEST(ThreadPoolTest, LargeAndMoveOnlyCaptures) {
+  ThreadPool pool(2, []() {}, []() {});
+
+  // Too large to be stored inline in a task slot.
+  std::array<uint64_t, 64> large;
+  std::iota(large.begin(), large.end(), 0);
+  auto sum = pool.Submit([large]() {
+    return std::accumulate(large.begin(), large.end(), uint64_t(0));
+  });
+  ASSERT_EQ(sum.get(), 63 * 64 / 2);
+
+  auto value = std::make_unique<int>(123);
+  auto result =
+      pool.Submit([value = std::move(value)]() { return *value + 1; });
+  ASSERT_EQ(result.get(), 124);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  constexpr size_t kNumTasks = 1000;
+  std::vector<size_t> squares(kNumTasks, 0);
+  ThreadPool pool(4, []() {}, []() {});
+  pool.ParallelFor(kNumTasks, [&squares](size_t i) { squares[i] = i * i; });
+  for (size_t i = 0; i < kNumTasks; ++i) {
+    ASSERT_EQ(squares[i], i * i);
+  }
+
+  // Calls from within the pool run on the calling thread.
+  std::atomic<size_t> count(0);
+  pool.ParallelFor(8, [&pool, &count](size_t) {
+    pool.ParallelFor(100, [&count](size_t) { count.fetch_add(1); });
+  });
+  ASSERT_EQ(count.load(), 800);
+
+  ASSERT_THROW(pool.ParallelFor(kNumTasks,
+                                [](size_t i) {
+                                  if (i == 10) throw std::runtime_error("");
+                                }),
+               std::runtime_error);
+}
+
+}  // namespace
@@ -1,5 +1,15 @@
+#include <time.h>
+
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "workloads/fixtures.h"
@@ -14,6 +24,49 @@ bool SystemIsLittleEndian() {
   return *reinterpret_cast<const char*>(&one) == 1;
 }
 
+std::vector<Request> RandomRequests(const size_t num_requests) {
+  std::vector<Request> requests;
+  requests.reserve(num_requests);
+  std::mt19937 prng(42);
+  for (size_t i = 0; i < num_requests; ++i) {
+    const auto op = static_cast<Request::Operation>(prng() % 4);
+    const Request::Key key = (static_cast<uint64_t>(prng()) << 32) | prng();
+    const uint32_t scan_amount =
+        op == Request::Operation::kScan ? prng() % 100 + 1 : 0;
+    requests.emplace_back(op, key, scan_amount, nullptr, 0);
+  }
+  return requests;
+}
+
+// Writes a legacy trace of `num_requests` random requests (followed by a
+// truncated request) and returns the requests that were written.
+std::vector<Request> WriteRandomTrace(const std::filesystem::path& trace_file,
+                                      const size_t num_requests) {
+  const std::vector<Request> requests = RandomRequests(num_requests);
+  std::ofstream output(trace_file, std::ios::out | std::ios::binary);
+  for (const auto& req : requests) {
+    const Request::Encoded encoded(req.op, req.key);
+    output.write(reinterpret_cast<const char*>(&encoded), sizeof(encoded));
+    if (req.op == Request::Operation::kScan) {
+      output.write(reinterpret_cast<const char*>(&req.scan_amount),
+                   sizeof(req.scan_amount));
+    }
+  }
+  // A truncated request at the end of the file is ignored.
+  output.write("\x01\x02\x03", 3);
+  return requests;
+}
+
+void ExpectSameRequests(const Trace& trace,
+                        const std::vector<Request>& expected) {
+  ASSERT_EQ(trace.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(trace[i].op, expected[i].op);
+    ASSERT_EQ(trace[i].key, expected[i].key);
+    ASSERT_EQ(trace[i].scan_amount, expected[i].scan_amount);
+  }
+}
+
 TEST_F(TraceLoadA, LoadBulkLoad) {
   const Trace::Options options;
   const BulkLoadTrace load = BulkLoadTrace::LoadFromFile(trace_file, options);
@@ -200,4 +253,630 @@ TEST(TraceTest, BulkLoadFromKeys) {
   }
 }
 
+TEST(TraceTest, LoadLargeTrace) {
+  // Large enough to be decoded in multiple chunks.
+  constexpr size_t kNumRequests = 300000;
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "large_trace.ycsb";
+  const std::vector<Request> expected =
+      WriteRandomTrace(trace_file, kNumRequests);
+
+  Trace::Options options;
+  options.value_size = 16;
+  const Trace trace = Trace::LoadFromFile(trace_file, options);
+  std::filesystem::remove(trace_file);
+
+  ASSERT_EQ(trace.size(), kNumRequests);
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    ASSERT_EQ(trace[i].op, expected[i].op);
+    ASSERT_EQ(trace[i].key, expected[i].key);
+    ASSERT_EQ(trace[i].scan_amount, expected[i].scan_amount);
+    if (trace[i].op == Request::Operation::kInsert ||
+        trace[i].op == Request::Operation::kUpdate) {
+      ASSERT_NE(trace[i].value, nullptr);
+      ASSERT_EQ(trace[i].value_size, options.value_size);
+    } else {
+      ASSERT_EQ(trace[i].value, nullptr);
+      ASSERT_EQ(trace[i].value_size, 0);
+    }
+  }
+}
+
+TEST(TraceTest, MissingFile) {
+  ASSERT_THROW(Trace::LoadFromFile("/nonexistent/trace.ycsb", Trace::Options()),
+               std::runtime_error);
+}
+
+TEST(StreamingTraceWorkloadTest, MatchesTrace) {
+  constexpr size_t kNumRequests = 200000;
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "streaming_trace.ycsb";
+  const std::vector<Request> expected =
+      WriteRandomTrace(trace_file, kNumRequests);
+
+  Trace::Options options;
+  options.value_size = 16;
+  // Use a small block size to exercise the double buffering.
+  const StreamingTraceWorkload workload(trace_file, options,
+                                        /*requests_per_block=*/1000);
+  ASSERT_EQ(workload.size(), kNumRequests);
+
+  // The writes are assigned the same values as when loading the trace.
+  const Trace trace = Trace::LoadFromFile(trace_file, options);
+  auto producers = workload.GetProducers(3);
+  ASSERT_EQ(producers.size(), 3);
+  size_t index = 0;
+  for (auto& producer : producers) {
+    producer.Prepare();
+    while (producer.HasNext()) {
+      const Request req = producer.Next();
+      ASSERT_LT(index, kNumRequests);
+      ASSERT_EQ(req.op, expected[index].op);
+      ASSERT_EQ(req.key, expected[index].key);
+      ASSERT_EQ(req.scan_amount, expected[index].scan_amount);
+      ASSERT_EQ(req.value_size, trace[index].value_size);
+      if (req.op == Request::Operation::kInsert ||
+          req.op == Request::Operation::kUpdate) {
+        ASSERT_NE(req.value, nullptr);
+        ASSERT_EQ(req.value_size, options.value_size);
+        ASSERT_EQ(memcmp(req.value, trace[index].value, req.value_size), 0);
+      }
+      ++index;
+    }
+  }
+  ASSERT_EQ(index, kNumRequests);
+
+  // Producers that are destroyed before consuming all their requests stop
+  // their reader threads.
+  auto unfinished = workload.GetProducers(2);
+  unfinished[0].Prepare();
+  ASSERT_EQ(unfinished[0].Next().key, expected[0].key);
+  unfinished.clear();
+
+  std::filesystem::remove(trace_file);
+}
+
+TEST(StreamingTraceWorkloadTest, V3ProducersSkipEarlierBlocks) {
+  constexpr size_t kNumRequests = 10000;
+  const std::vector<Request> requests = RandomRequests(kNumRequests);
+  const auto v3_file =
+      std::filesystem::temp_directory_path() / "streaming_v3.ycsb";
+  {
+    TraceWriter v3(v3_file, TraceWriter::Format::kV3,
+                   /*requests_per_block=*/100);
+    for (const auto& req : requests) {
+      v3.Write(req);
+    }
+  }
+  Trace::Options options;
+  options.value_size = 16;
+  const Trace trace = Trace::LoadFromFile(v3_file, options);
+
+  // Corrupt the first block. Only the first producer reads it.
+  {
+    std::fstream file(v3_file, std::ios::in | std::ios::out |
+                                   std::ios::binary);
+    file.seekp(sizeof(impl::TraceV3Header));
+    file.put(static_cast<char>(0xFF));
+  }
+  const StreamingTraceWorkload workload(v3_file, options,
+                                        /*requests_per_block=*/250);
+  auto producers = workload.GetProducers(3);
+  ASSERT_THROW(producers[0].Prepare(), std::runtime_error);
+
+  // The other producers start in the middle of a block and are assigned the
+  // same values as when loading the trace.
+  size_t index = 3334;
+  for (size_t i = 1; i < producers.size(); ++i) {
+    producers[i].Prepare();
+    while (producers[i].HasNext()) {
+      const Request req = producers[i].Next();
+      ASSERT_EQ(req.op, requests[index].op);
+      ASSERT_EQ(req.key, requests[index].key);
+      ASSERT_EQ(req.scan_amount, requests[index].scan_amount);
+      ASSERT_EQ(req.value_size, trace[index].value_size);
+      if (req.value_size > 0) {
+        ASSERT_EQ(memcmp(req.value, trace[index].value, req.value_size), 0);
+      }
+      ++index;
+    }
+  }
+  ASSERT_EQ(index, kNumRequests);
+
+  std::filesystem::remove(v3_file);
+}
+
+TEST(StreamingTraceWorkloadTest, SortUnsupported) {
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "streaming_trace.ycsb";
+  WriteRandomTrace(trace_file, 10);
+  Trace::Options options;
+  options.sort_requests = true;
+  ASSERT_THROW(StreamingTraceWorkload(trace_file, options),
+               std::invalid_argument);
+  std::filesystem::remove(trace_file);
+}
+
+// A workload with one producer that generates the given requests.
+class ListWorkload {
+ public:
+  class Producer {
+   public:
+    explicit Producer(const std::vector<Request>* requests)
+        : requests_(requests), index_(0) {}
+    void Prepare() {}
+    bool HasNext() const { return index_ < requests_->size(); }
+    Request Next() { return (*requests_)[index_++]; }
+
+   private:
+    const std::vector<Request>* requests_;
+    size_t index_;
+  };
+
+  explicit ListWorkload(std::vector<Request> requests)
+      : requests_(std::move(requests)) {}
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    return {Producer(&requests_)};
+  }
+
+ private:
+  std::vector<Request> requests_;
+};
+
+TEST(BufferedWorkloadTest, CompactEncoding) {
+  constexpr size_t kNumRequests = 10000;
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "buffered_trace.ycsb";
+  WriteRandomTrace(trace_file, kNumRequests);
+  Trace::Options options;
+  options.value_size = 16;
+  const Trace trace = Trace::LoadFromFile(trace_file, options);
+  std::filesystem::remove(trace_file);
+
+  std::vector<Request> requests(trace.begin(), trace.end());
+  // Requests that cannot be packed are stored as-is.
+  const char* const value = trace[0].value;
+  requests.emplace_back(Request::Operation::kScan, 1, 10, value, 16);
+  requests.emplace_back(Request::Operation::kScan, 2, 1U << 31, nullptr, 0);
+  requests.emplace_back(Request::Operation::kRead, 3, 10, nullptr, 0);
+  // The same value with a different size.
+  requests.emplace_back(Request::Operation::kInsert, 4, 0, value, 8);
+  requests.emplace_back(Request::Operation::kUpdate, 5, 0, value, 16);
+
+  const ListWorkload workload(requests);
+  const BufferedWorkload<ListWorkload> bworkload(workload);
+  auto producers = bworkload.GetProducers(1);
+  ASSERT_EQ(producers.size(), 1);
+  auto& producer = producers[0];
+  producer.Prepare();
+  for (const auto& expected : requests) {
+    ASSERT_TRUE(producer.HasNext());
+    const Request req = producer.Next();
+    ASSERT_EQ(req.op, expected.op);
+    ASSERT_EQ(req.key, expected.key);
+    ASSERT_EQ(req.scan_amount, expected.scan_amount);
+    ASSERT_EQ(req.value, expected.value);
+    ASSERT_EQ(req.value_size, expected.value_size);
+  }
+  ASSERT_FALSE(producer.HasNext());
+}
+
+// A workload whose producers fail after generating some requests.
+class FailingWorkload {
+ public:
+  class Producer {
+   public:
+    explicit Producer(const size_t fail_after) : fail_after_(fail_after) {}
+    void Prepare() {}
+    bool HasNext() const { return true; }
+    Request Next() {
+      if (fail_after_ == 0) throw std::runtime_error("Failed to generate.");
+      --fail_after_;
+      return Request();
+    }
+
+   private:
+    size_t fail_after_;
+  };
+
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    return std::vector<Producer>(num_producers, Producer(100));
+  }
+};
+
+TEST(PipelinedWorkloadTest, MatchesWrappedWorkload) {
+  constexpr size_t kNumRequests = 100000;
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "pipelined_trace.ycsb";
+  const std::vector<Request> expected =
+      WriteRandomTrace(trace_file, kNumRequests);
+  Trace::Options options;
+  options.value_size = 16;
+  const Trace trace = Trace::LoadFromFile(trace_file, options);
+  const TraceWorkload workload(&trace);
+
+  PipelinedWorkload<TraceWorkload>::Options pipeline_options;
+  // Use a small queue so that the generator thread has to wait for space.
+  pipeline_options.queue_capacity = 60;
+  pipeline_options.generator_cores = {0};
+  const PipelinedWorkload<TraceWorkload> pworkload(workload, pipeline_options);
+
+  auto producers = pworkload.GetProducers(3);
+  ASSERT_EQ(producers.size(), 3);
+  size_t index = 0;
+  for (auto& producer : producers) {
+    producer.Prepare();
+    while (producer.HasNext()) {
+      const Request req = producer.Next();
+      ASSERT_LT(index, kNumRequests);
+      ASSERT_EQ(req.op, expected[index].op);
+      ASSERT_EQ(req.key, expected[index].key);
+      ASSERT_EQ(req.scan_amount, expected[index].scan_amount);
+      ++index;
+    }
+  }
+  ASSERT_EQ(index, kNumRequests);
+
+  // Producers that are destroyed before consuming all their requests stop
+  // their generator threads.
+  auto unfinished = pworkload.GetProducers(2);
+  unfinished[0].Prepare();
+  ASSERT_EQ(unfinished[0].Next().key, expected[0].key);
+  unfinished.clear();
+
+  std::filesystem::remove(trace_file);
+}
+
+TEST(PipelinedWorkloadTest, PropagatesErrors) {
+  const FailingWorkload workload;
+  PipelinedWorkload<FailingWorkload>::Options options;
+  options.queue_capacity = 16;
+  const PipelinedWorkload<FailingWorkload> pworkload(workload, options);
+  auto producers = pworkload.GetProducers(1);
+  producers[0].Prepare();
+  size_t num_requests = 0;
+  ASSERT_THROW(
+      {
+        while (producers[0].HasNext()) {
+          producers[0].Next();
+          ++num_requests;
+        }
+      },
+      std::runtime_error);
+  ASSERT_EQ(num_requests, 100);
+}
+
+std::chrono::nanoseconds ThreadCPUTime() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return std::chrono::seconds(now.tv_sec) +
+         std::chrono::nanoseconds(now.tv_nsec);
+}
+
+// A workload whose producers can pause every `pause_every` requests. Each
+// producer records the CPU time its thread used once it runs out of requests.
+class PausingWorkload {
+ public:
+  class Producer {
+   public:
+    explicit Producer(const PausingWorkload* workload)
+        : workload_(workload), index_(0) {}
+    void Prepare() {}
+    bool HasNext() const {
+      if (index_ < workload_->num_requests_) return true;
+      workload_->generator_cpu_time_ = ThreadCPUTime();
+      return false;
+    }
+    Request Next() {
+      if (workload_->pause_every_ > 0 && index_ > 0 &&
+          index_ % workload_->pause_every_ == 0) {
+        std::this_thread::sleep_for(workload_->pause_);
+      }
+      return Request(Request::Operation::kRead, index_++, 0, nullptr, 0);
+    }
+
+   private:
+    const PausingWorkload* workload_;
+    size_t index_;
+  };
+
+  PausingWorkload(size_t num_requests, size_t pause_every,
+                  std::chrono::microseconds pause)
+      : num_requests_(num_requests), pause_every_(pause_every), pause_(pause) {}
+
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    return std::vector<Producer>(num_producers, Producer(this));
+  }
+
+  std::chrono::nanoseconds GeneratorCPUTime() const {
+    return generator_cpu_time_;
+  }
+
+ private:
+  const size_t num_requests_, pause_every_;
+  const std::chrono::microseconds pause_;
+  mutable std::chrono::nanoseconds generator_cpu_time_;
+};
+
+TEST(PipelinedWorkloadTest, BlocksWhileWaiting) {
+  constexpr size_t kNumRequests = 2000;
+  constexpr size_t kPauseEvery = 100;
+  constexpr auto kPause = std::chrono::milliseconds(5);
+  PipelinedWorkload<PausingWorkload>::Options options;
+  options.queue_capacity = 16;
+
+  // A slow consumer: the generator should block while the queue is full
+  // instead of using its whole core.
+  {
+    const PausingWorkload workload(kNumRequests, /*pause_every=*/0, kPause);
+    const PipelinedWorkload<PausingWorkload> pworkload(workload, options);
+    auto producers = pworkload.GetProducers(1);
+    producers[0].Prepare();
+    const auto start = std::chrono::steady_clock::now();
+    size_t index = 0;
+    while (producers[0].HasNext()) {
+      ASSERT_EQ(producers[0].Next().key, index);
+      if (++index % kPauseEvery == 0) std::this_thread::sleep_for(kPause);
+    }
+    ASSERT_EQ(index, kNumRequests);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_LT(workload.GeneratorCPUTime().count(),
+              std::chrono::nanoseconds(elapsed / 2).count());
+  }
+
+  // A slow generator: the consumer should block while the queue is empty.
+  {
+    const PausingWorkload workload(kNumRequests, kPauseEvery, kPause);
+    const PipelinedWorkload<PausingWorkload> pworkload(workload, options);
+    auto producers = pworkload.GetProducers(1);
+    producers[0].Prepare();
+    const auto start = std::chrono::steady_clock::now();
+    const auto start_cpu_time = ThreadCPUTime();
+    size_t index = 0;
+    while (producers[0].HasNext()) {
+      ASSERT_EQ(producers[0].Next().key, index++);
+    }
+    ASSERT_EQ(index, kNumRequests);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_LT((ThreadCPUTime() - start_cpu_time).count(),
+              std::chrono::nanoseconds(elapsed / 2).count());
+  }
+}
+
+TEST(LoopingWorkloadTest, RepeatsWrappedWorkload) {
+  constexpr size_t kNumRequests = 1000;
+  const auto trace_file =
+      std::filesystem::temp_directory_path() / "looping_trace.ycsb";
+  const std::vector<Request> expected =
+      WriteRandomTrace(trace_file, kNumRequests);
+  Trace::Options options;
+  options.value_size = 16;
+  const Trace trace = Trace::LoadFromFile(trace_file, options);
+  const TraceWorkload workload(&trace);
+
+  LoopingWorkload<TraceWorkload>::Options looping_options;
+  looping_options.max_loops = 3;
+  const LoopingWorkload<TraceWorkload> lworkload(workload, looping_options);
+  auto producers = lworkload.GetProducers(2);
+  ASSERT_EQ(producers.size(), 2);
+
+  // Each producer repeats its own part of the trace.
+  std::vector<Request> requests;
+  for (auto& producer : producers) {
+    producer.Prepare();
+    while (producer.HasNext()) {
+      requests.push_back(producer.Next());
+    }
+  }
+  ASSERT_EQ(requests.size(), 3 * kNumRequests);
+  const size_t half = kNumRequests / 2;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const size_t index =
+        i < 3 * half ? i % half : half + (i - 3 * half) % half;
+    ASSERT_EQ(requests[i].op, expected[index].op);
+    ASSERT_EQ(requests[i].key, expected[index].key);
+  }
+
+  // Unbounded loops never run out of requests.
+  const LoopingWorkload<TraceWorkload> unbounded_workload(workload);
+  auto unbounded = unbounded_workload.GetProducers(1);
+  unbounded[0].Prepare();
+  for (size_t i = 0; i < 5 * kNumRequests; ++i) {
+    ASSERT_TRUE(unbounded[0].HasNext());
+    ASSERT_EQ(unbounded[0].Next().key, expected[i % kNumRequests].key);
+  }
+
+  std::filesystem::remove(trace_file);
+}
+
+// Counts its `GetProducers()` calls. Producer `i` generates `i` requests.
+class CountingWorkload {
+ public:
+  class Producer {
+   public:
+    explicit Producer(const size_t num_requests)
+        : num_requests_(num_requests), index_(0) {}
+    void Prepare() {}
+    bool HasNext() const { return index_ < num_requests_; }
+    Request Next() {
+      return Request(Request::Operation::kRead, index_++, 0, nullptr, 0);
+    }
+
+   private:
+    size_t num_requests_, index_;
+  };
+
+  CountingWorkload() : num_calls_(0) {}
+
+  std::vector<Producer> GetProducers(const size_t num_producers) const {
+    ++num_calls_;
+    std::vector<Producer> producers;
+    for (size_t i = 0; i < num_producers; ++i) {
+      producers.emplace_back(i);
+    }
+    return producers;
+  }
+
+  size_t NumCalls() const { return num_calls_; }
+
+ private:
+  mutable size_t num_calls_;
+};
+
+TEST(LoopingWorkloadTest, CreatesProducersOncePerLoop) {
+  constexpr size_t kNumProducers = 4;
+  constexpr size_t kNumLoops = 5;
+  const CountingWorkload workload;
+  LoopingWorkload<CountingWorkload>::Options options;
+  options.max_loops = kNumLoops;
+  const LoopingWorkload<CountingWorkload> lworkload(workload, options);
+  auto producers = lworkload.GetProducers(kNumProducers);
+  ASSERT_EQ(workload.NumCalls(), 1);
+
+  // Producer 0 has no requests, so it is not repeated.
+  for (size_t id = 0; id < kNumProducers; ++id) {
+    auto& producer = producers[id];
+    producer.Prepare();
+    size_t num_requests = 0;
+    while (producer.HasNext()) {
+      ASSERT_EQ(producer.Next().key, num_requests % id);
+      ++num_requests;
+    }
+    ASSERT_EQ(num_requests, kNumLoops * id);
+  }
+  // One call per repetition (instead of one per producer and repetition).
+  ASSERT_EQ(workload.NumCalls(), kNumLoops);
+}
+
+TEST(TraceWriterTest, RoundTrip) {
+  constexpr size_t kNumRequests = 50000;
+  const std::vector<Request> requests = RandomRequests(kNumRequests);
+  const auto legacy_file =
+      std::filesystem::temp_directory_path() / "writer_legacy.ycsb";
+  const auto v3_file = std::filesystem::temp_directory_path() / "writer_v3.ycsb";
+  {
+    TraceWriter legacy(legacy_file, TraceWriter::Format::kLegacy);
+    TraceWriter v3(v3_file, TraceWriter::Format::kV3,
+                   /*requests_per_block=*/1000);
+    for (const auto& req : requests) {
+      legacy.Write(req);
+      v3.Write(req);
+    }
+    // The destructors close the files.
+  }
+
+  const Trace::Options options;
+  ExpectSameRequests(Trace::LoadFromFile(legacy_file, options), requests);
+  ExpectSameRequests(Trace::LoadFromFile(v3_file, options), requests);
+
+  // Producers can start in the middle of a v3 block. The writes are assigned
+  // the same values as when loading the trace.
+  const Trace trace = Trace::LoadFromFile(v3_file, options);
+  const StreamingTraceWorkload workload(v3_file, options,
+                                        /*requests_per_block=*/777);
+  ASSERT_EQ(workload.size(), kNumRequests);
+  size_t index = 0;
+  for (auto& producer : workload.GetProducers(3)) {
+    producer.Prepare();
+    while (producer.HasNext()) {
+      const Request req = producer.Next();
+      ASSERT_EQ(req.op, requests[index].op);
+      ASSERT_EQ(req.key, requests[index].key);
+      ASSERT_EQ(req.scan_amount, requests[index].scan_amount);
+      ASSERT_EQ(req.value_size, trace[index].value_size);
+      if (req.value_size > 0) {
+        ASSERT_EQ(memcmp(req.value, trace[index].value, req.value_size), 0);
+      }
+      ++index;
+    }
+  }
+  ASSERT_EQ(index, kNumRequests);
+
+  std::filesystem::remove(legacy_file);
+  std::filesystem::remove(v3_file);
+}
+
+TEST(TraceWriterTest, V3CompressesSortedKeys) {
+  std::vector<Request> requests;
+  for (Request::Key key = 0; key < 100000; ++key) {
+    requests.emplace_back(Request::Operation::kInsert, key * 10, 0, nullptr,
+                          0);
+  }
+  const auto legacy_file =
+      std::filesystem::temp_directory_path() / "sorted_legacy.ycsb";
+  const auto v3_file = std::filesystem::temp_directory_path() / "sorted_v3.ycsb";
+  TraceWriter legacy(legacy_file, TraceWriter::Format::kLegacy);
+  TraceWriter v3(v3_file, TraceWriter::Format::kV3);
+  for (const auto& req : requests) {
+    legacy.Write(req);
+    v3.Write(req);
+  }
+  legacy.Close();
+  v3.Close();
+
+  ASSERT_LT(std::filesystem::file_size(v3_file) * 4,
+            std::filesystem::file_size(legacy_file));
+  const BulkLoadTrace load =
+      BulkLoadTrace::LoadFromFile(v3_file, Trace::Options());
+  ExpectSameRequests(load, requests);
+
+  std::filesystem::remove(legacy_file);
+  std::filesystem::remove(v3_file);
+}
+
+TEST(TraceWriterTest, V3RecordsBlockWrites) {
+  constexpr size_t kRequestsPerBlock = 100;
+  const std::vector<Request> requests = RandomRequests(1050);
+  const auto v3_file =
+      std::filesystem::temp_directory_path() / "block_writes.ycsb";
+  {
+    TraceWriter v3(v3_file, TraceWriter::Format::kV3, kRequestsPerBlock);
+    for (const auto& req : requests) {
+      v3.Write(req);
+    }
+  }
+
+  const impl::MappedFile mapped(v3_file);
+  const impl::TraceV3Index index =
+      impl::ReadTraceV3Index(mapped.data(), mapped.size());
+  ASSERT_EQ(index.block_writes.size(), 11);
+  size_t num_writes = 0;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (i % kRequestsPerBlock == 0) {
+      ASSERT_EQ(index.block_writes[i / kRequestsPerBlock], num_writes);
+    }
+    num_writes += requests[i].op == Request::Operation::kInsert ||
+                  requests[i].op == Request::Operation::kUpdate;
+  }
+
+  std::filesystem::remove(v3_file);
+}
+
+TEST(TraceWriterTest, CorruptV3Trace) {
+  const auto v3_file = std::filesystem::temp_directory_path() / "corrupt.ycsb";
+  {
+    TraceWriter v3(v3_file, TraceWriter::Format::kV3, 100);
+    for (const auto& req : RandomRequests(1000)) {
+      v3.Write(req);
+    }
+  }
+  // Make the last block hold more writes than requests.
+  {
+    std::fstream file(v3_file, std::ios::in | std::ios::out |
+                                   std::ios::binary);
+    file.seekp(-static_cast<std::streamoff>(sizeof(uint64_t)),
+               std::ios::end);
+    const uint64_t num_writes = 1000;
+    file.write(reinterpret_cast<const char*>(&num_writes), sizeof(num_writes));
+  }
+  ASSERT_THROW(Trace::LoadFromFile(v3_file, Trace::Options()),
+               std::runtime_error);
+  // Remove part of the block index.
+  std::filesystem::resize_file(v3_file,
+                               std::filesystem::file_size(v3_file) - 8);
+  ASSERT_THROW(Trace::LoadFromFile(v3_file, Trace::Options()),
+               std::runtime_error);
+  std::filesystem::remove(v3_file);
+}
+
 }  // namespace
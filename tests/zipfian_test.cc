@@ -1,5 +1,9 @@
 #include "../generator/zipfian_chooser.h"
 
+#include <cmath>
+#include <vector>
+
+#include "../generator/rejection_inversion_zipfian_chooser.h"
 #include "gtest/gtest.h"
 #include "ycsbr/gen/types.h"
 
@@ -55,4 +59,84 @@ TEST(ZipfianTest, DifferentTheta) {
   }
 }
 
+TEST(ZipfianTest, CachingAfterLargerItemCount) {
+  // No other test uses this theta, so the cache only holds the zeta(n) values
+  // computed below.
+  constexpr double theta = 0.77;
+  constexpr size_t item_count = 500;
+  constexpr size_t repetitions = 1000000;
+  ZipfianChooser smaller(100, theta);
+  ZipfianChooser larger(1000, theta);
+
+  // The cached zeta(1000) must not be used as the starting point.
+  PRNG prng(42);
+  ZipfianChooser zipf(item_count, theta);
+  size_t zeros = 0;
+  for (size_t i = 0; i < repetitions; ++i) {
+    const size_t choice = zipf.Next(prng);
+    ASSERT_LT(choice, item_count);
+    zeros += choice == 0;
+  }
+  // Index 0 is chosen with probability 1 / zeta(item_count).
+  double zeta_n = 0.0;
+  for (size_t i = 1; i <= item_count; ++i) {
+    zeta_n += 1.0 / std::pow(i, theta);
+  }
+  const double expected = repetitions / zeta_n;
+  // Allow for 5 standard deviations of sampling error.
+  ASSERT_NEAR(zeros, expected, 5 * std::sqrt(expected));
+}
+
+// Checks that the chooser's empirical distribution is close to the exact
+// Zipfian distribution over `item_count` items.
+void CheckRejectionInversion(const size_t item_count, const double theta) {
+  constexpr size_t repetitions = 1000000;
+  PRNG prng(42);
+  RejectionInversionZipfianChooser zipf(item_count, theta);
+  std::vector<size_t> freq(item_count, 0);
+  for (size_t i = 0; i < repetitions; ++i) {
+    const size_t choice = zipf.Next(prng);
+    ASSERT_LT(choice, item_count);
+    ++freq[choice];
+  }
+  double zeta_n = 0.0;
+  for (size_t i = 1; i <= item_count; ++i) {
+    zeta_n += 1.0 / std::pow(i, theta);
+  }
+  for (size_t i = 0; i < item_count; ++i) {
+    const double expected = repetitions / std::pow(i + 1, theta) / zeta_n;
+    // Allow for 5 standard deviations of sampling error.
+    ASSERT_NEAR(freq[i], expected, 5 * std::sqrt(expected) + 1)
+        << "item " << i << ", theta " << theta;
+  }
+}
+
+TEST(ZipfianTest, RejectionInversionMatchesDistribution) {
+  CheckRejectionInversion(100, 0.5);
+  CheckRejectionInversion(100, 0.99);
+  CheckRejectionInversion(100, 1.0);
+  CheckRejectionInversion(1000, 1.5);
+  CheckRejectionInversion(10, 3.0);
+}
+
+TEST(ZipfianTest, RejectionInversionLargeItemCount) {
+  // Setup and growth take constant time, so very large item counts are fine.
+  constexpr size_t item_count = 1ULL << 40;
+  PRNG prng(42);
+  RejectionInversionZipfianChooser zipf(item_count, 0.99);
+  size_t zeros = 0;
+  for (size_t i = 0; i < 100000; ++i) {
+    const size_t choice = zipf.Next(prng);
+    ASSERT_LT(choice, item_count);
+    zeros += choice == 0;
+    zipf.IncreaseItemCountBy(1);
+  }
+  ASSERT_GT(zeros, 0);
+
+  ScatteredRejectionInversionZipfianChooser scattered(item_count, 1.2, 123);
+  for (size_t i = 0; i < 1000; ++i) {
+    ASSERT_LT(scattered.Next(prng), item_count);
+  }
+}
+
 }  // namespace